@@ -44,6 +44,10 @@ int gmr1_codec_decode_frame(struct gmr1_codec *codec,
 int gmr1_codec_decode_dtx(struct gmr1_codec *codec,
                           int16_t *audio, int N);
 
+int gmr1_codec_decode_batch(struct gmr1_codec **codecs, int n,
+                            int16_t **audio, int N,
+                            const uint8_t * const *frames, const int *bad);
+
 
 /*! @} */
 
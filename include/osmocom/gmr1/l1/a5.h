@@ -40,6 +40,9 @@ void gmr1_a5(int n, uint8_t *key, uint32_t fn, int nbits,
 void gmr1_a5_1(uint8_t *key, uint32_t fn, int nbits,
                ubit_t *dl, ubit_t *ul);
 
+void gmr1_a5_1_batch(int n, uint8_t * const *key, const uint32_t *fn,
+                     int nbits, ubit_t * const *dl, ubit_t * const *ul);
+
 
 /*! @} */
 
@@ -0,0 +1,51 @@
+/* GMR-1 A5 cipher stream cache */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __OSMO_GMR1_L1_A5_CACHE_H__
+#define __OSMO_GMR1_L1_A5_CACHE_H__
+
+/*! \addtogroup a5
+ *  @{
+ */
+
+/*! \file l1/a5_cache.h
+ *  \brief Osmocom GMR-1 A5 cipher stream cache header
+ */
+
+#include <stdint.h>
+
+#include <osmocom/core/bits.h>
+
+
+struct gmr1_a5_cache;
+
+struct gmr1_a5_cache *
+gmr1_a5_cache_alloc(int nbits, int lookahead);
+
+void
+gmr1_a5_cache_release(struct gmr1_a5_cache *c);
+
+int
+gmr1_a5_cache_get(struct gmr1_a5_cache *c, const uint8_t *key, uint32_t fn,
+                  int ul, int nbits, ubit_t *ubits, pbit_t *pbits);
+
+
+/*! @} */
+
+#endif /* __OSMO_GMR1_L1_A5_CACHE_H__ */
@@ -36,6 +36,9 @@
 
 void gmr1_bcch_encode(ubit_t *bits_e, const uint8_t *l2);
 int  gmr1_bcch_decode(uint8_t *l2, const sbit_t *bits_e, int *conv_rv);
+int  gmr1_bcch_decode_batch(int n, uint8_t * const *l2,
+                            const sbit_t * const *bits_e,
+                            int *crc_rv, int *conv_rv);
 
 
 /*! @} */
@@ -43,6 +43,12 @@ extern const struct osmo_conv_code gmr1_conv_k9_13;
 extern const struct osmo_conv_code gmr1_conv_k9_14;
 extern const struct osmo_conv_code gmr1_conv_tch3;
 
+int gmr1_conv_decode(const struct osmo_conv_code *code,
+                     const sbit_t *input, ubit_t *output);
+int gmr1_conv_decode_batch(const struct osmo_conv_code *code, int n,
+                           const sbit_t * const *input, ubit_t * const *output,
+                           int *rv);
+
 
 /*! @} */
 
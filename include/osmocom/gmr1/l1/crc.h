@@ -30,6 +30,9 @@
  *  \brief Osmocom GMR-1 CRC header
  */
 
+#include <stdint.h>
+
+#include <osmocom/core/bits.h>
 #include <osmocom/core/crcgen.h>
 
 
@@ -38,6 +41,29 @@ extern const struct osmo_crc16gen_code gmr1_crc12;
 extern const struct osmo_crc16gen_code gmr1_crc16;
 
 
+/*! \brief Table driven CRC code, working on packed bits (LSB first) */
+struct gmr1_crc_table {
+	int bits;		/*!< \brief Actual CRC width in bits */
+	uint16_t poly;		/*!< \brief Polynomial (reflected) */
+	uint16_t init;		/*!< \brief Initialization value */
+	uint16_t remainder;	/*!< \brief Final XOR value */
+	uint16_t table[256];	/*!< \brief Byte step table (reflected) */
+};
+
+extern const struct gmr1_crc_table gmr1_crc8_table;
+extern const struct gmr1_crc_table gmr1_crc12_table;
+extern const struct gmr1_crc_table gmr1_crc16_table;
+
+uint16_t gmr1_crc_compute_pbits(const struct gmr1_crc_table *code,
+                                const pbit_t *in, int ofs, int len);
+int gmr1_crc_check_pbits(const struct gmr1_crc_table *code,
+                         const pbit_t *in, int ofs, int len,
+                         const ubit_t *crc_bits);
+void gmr1_crc_set_pbits(const struct gmr1_crc_table *code,
+                        const pbit_t *in, int ofs, int len,
+                        ubit_t *crc_bits);
+
+
 /*! @} */
 
 #endif /* __OSMO_GMR1_L1_CRC_H__ */
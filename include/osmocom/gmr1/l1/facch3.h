@@ -38,6 +38,10 @@ void gmr1_facch3_encode(ubit_t *bits_e, const uint8_t *l2,
                         const ubit_t *bits_s, const ubit_t *ciph);
 int  gmr1_facch3_decode(uint8_t *l2, ubit_t *bits_s,
                         const sbit_t *bits_e, const ubit_t *ciph, int *conv_rv);
+int  gmr1_facch3_decode_batch(int n, uint8_t * const *l2, ubit_t * const *bits_s,
+                              const sbit_t * const *bits_e,
+                              const ubit_t * const *ciph,
+                              int *crc_rv, int *conv_rv);
 
 
 /*! @} */
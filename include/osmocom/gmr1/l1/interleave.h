@@ -45,7 +45,9 @@ struct gmr1_interleaver
 	int N;			/*!< \brief Interleaver depth */
 	int K;			/*!< \brief Interleaver width */
 	int n;			/*!< \brief Current burst number */
-	uint8_t *bits_cpp;	/*!< \brief c'' bit state storage */
+	int row;		/*!< \brief Current ring row (n % N) */
+	uint8_t *bits_cpp;	/*!< \brief Ring of the last N bursts */
+	uint8_t *phase;		/*!< \brief jk % N for each bit */
 };
 
 int  gmr1_interleaver_init(struct gmr1_interleaver *il, int N, int K);
@@ -0,0 +1,62 @@
+/* GMR-1 receive maps */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __OSMO_GMR1_L1_RXMAP_H__
+#define __OSMO_GMR1_L1_RXMAP_H__
+
+/*! \defgroup rxmap Receive maps
+ *  \ingroup l1_prim
+ *  @{
+ */
+
+/*! \file l1/rxmap.h
+ *  \brief Osmocom GMR-1 receive maps header
+ */
+
+#include <stdint.h>
+
+#include <osmocom/core/bits.h>
+
+
+/*! \brief Receive map entry: where one decoder input soft bit comes from */
+struct gmr1_rxmap
+{
+	uint16_t e;	/*!< \brief Index in the burst soft bits */
+	uint16_t c;	/*!< \brief Index in the cipher stream */
+	sbit_t s;	/*!< \brief Scrambling sign mask (0 or -1) */
+};
+
+void gmr1_rxmap_segment(struct gmr1_rxmap *map, int e, int c, int s, int len);
+void gmr1_rxmap_intra(struct gmr1_rxmap *out, const struct gmr1_rxmap *in,
+                      int N);
+void gmr1_rxmap_apply(sbit_t *out, const sbit_t *bits_e, const ubit_t *ciph,
+                      const struct gmr1_rxmap *map, int len);
+
+void gmr1_rxmap_sign_pack(uint64_t *sign, const struct gmr1_rxmap *map,
+                          int len);
+void gmr1_rxmap_mask(uint64_t *mask, const uint64_t *sign,
+                     const pbit_t *ciph, int nbits);
+void gmr1_rxmap_apply_mask(sbit_t *out, const sbit_t *bits_e,
+                           const uint64_t *mask,
+                           const struct gmr1_rxmap *map, int len);
+
+
+/*! @} */
+
+#endif /* __OSMO_GMR1_L1_RXMAP_H__ */
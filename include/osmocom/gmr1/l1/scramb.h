@@ -34,7 +34,11 @@
 
 
 void gmr1_scramble_sbit(sbit_t *out, const sbit_t *in, int len);
+void gmr1_scramble_sbit_ext(sbit_t *out, const sbit_t *in, const ubit_t *ciph,
+                            int ofs, int len);
 void gmr1_scramble_ubit(ubit_t *out, const ubit_t *in, int len);
+void gmr1_scramble_pbit(pbit_t *out, const pbit_t *in, int len);
+void gmr1_scramble_sign(sbit_t *sign, int ofs, int len);
 
 
 /*! @} */
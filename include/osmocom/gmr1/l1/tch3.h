@@ -40,6 +40,9 @@ void gmr1_tch3_encode(ubit_t *bits_e,
 void gmr1_tch3_decode(uint8_t *frame0, uint8_t *frame1, ubit_t *bits_s,
                       const sbit_t *bits_e, const ubit_t *ciph, int m,
                       int *conv0_rv, int *conv1_rv);
+void gmr1_tch3_decode_pciph(uint8_t *frame0, uint8_t *frame1, ubit_t *bits_s,
+                            const sbit_t *bits_e, const pbit_t *ciph, int m,
+                            int *conv0_rv, int *conv1_rv);
 
 
 /*! @} */
@@ -51,6 +51,10 @@ void gmr1_tch9_decode(uint8_t *l2, sbit_t *bits_sacch, sbit_t *bits_status,
                       const sbit_t *bits_e, enum gmr1_tch9_mode mode,
                       const ubit_t *ciph, struct gmr1_interleaver *il,
                       int *conv_rv);
+void gmr1_tch9_decode_pciph(uint8_t *l2, sbit_t *bits_sacch, sbit_t *bits_status,
+                            const sbit_t *bits_e, enum gmr1_tch9_mode mode,
+                            const pbit_t *ciph, struct gmr1_interleaver *il,
+                            int *conv_rv);
 
 
 /*! @} */
@@ -30,6 +30,8 @@
  *  \brief Osmocom GMR-1 FCCH bursts header
  */
 
+#include <stdint.h>
+
 #include <osmocom/dsp/cxvec.h>
 
 
@@ -61,6 +63,26 @@ int gmr1_fcch_snr(const struct gmr1_fcch_burst *burst_type,
                   float *snr);
 
 
+struct gmr1_fcch_stream;
+
+/*! \brief Streaming FCCH detection callback
+ *  \param[in] data User data given at allocation
+ *  \param[in] toa Absolute TOA of the FCCH in the stream (in samples)
+ *  \param[in] pwr Relative power of the FCCH
+ */
+typedef void (*gmr1_fcch_stream_cb_t)(void *data, int64_t toa, float pwr);
+
+struct gmr1_fcch_stream *
+gmr1_fcch_stream_alloc(const struct gmr1_fcch_burst *burst_type,
+                       int sps, float freq_shift,
+                       gmr1_fcch_stream_cb_t cb, void *cb_data);
+
+void gmr1_fcch_stream_release(struct gmr1_fcch_stream *fs);
+
+void gmr1_fcch_stream_process(struct gmr1_fcch_stream *fs,
+                              struct osmo_cxvec *blk);
+
+
 /*! @} */
 
 #endif /* __OSMO_GMR1_SDR_FCCH_H__ */
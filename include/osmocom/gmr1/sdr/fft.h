@@ -0,0 +1,52 @@
+/* GMR-1 SDR - Shared FFT plans */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __OSMO_GMR1_SDR_FFT_H__
+#define __OSMO_GMR1_SDR_FFT_H__
+
+/*! \defgroup fft Shared FFT plans
+ *  \ingroup sdr
+ *  @{
+ */
+
+/*! \file sdr/fft.h
+ *  \brief Osmocom GMR-1 shared FFT plans header
+ */
+
+#include <complex.h>
+
+
+/*! \brief Environment variable giving the default FFTW wisdom file */
+#define GMR1_FFT_WISDOM_ENV	"GMR1_FFTW_WISDOM"
+
+struct gmr1_fft_plan;
+
+void gmr1_fft_set_planner_flags(unsigned int flags);
+
+int gmr1_fft_wisdom_load(const char *filename);
+int gmr1_fft_wisdom_save(const char *filename);
+
+const struct gmr1_fft_plan *gmr1_fft_plan_get(int len, int dir);
+
+void gmr1_fft_execute(const struct gmr1_fft_plan *plan, float complex *buf);
+
+
+/*! @} */
+
+#endif /* __OSMO_GMR1_SDR_FFT_H__ */
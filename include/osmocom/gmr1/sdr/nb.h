@@ -34,16 +34,16 @@ struct gmr1_pi4cxpsk_burst;
 
 
 	/* Various normal bursts types */
-extern struct gmr1_pi4cxpsk_burst gmr1_bcch_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_dc2_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_dc6_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_dc12_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_nt3_speech_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_nt3_facch_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_nt6_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_nt9_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_rach_burst;
-extern struct gmr1_pi4cxpsk_burst gmr1_sdcch_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_bcch_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_dc2_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_dc6_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_dc12_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_nt3_speech_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_nt3_facch_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_nt6_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_nt9_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_rach_burst;
+extern const struct gmr1_pi4cxpsk_burst gmr1_sdcch_burst;
 
 
 /*! @} */
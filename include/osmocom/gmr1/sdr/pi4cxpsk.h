@@ -52,22 +52,26 @@ struct gmr1_pi4cxpsk_symbol {
 struct gmr1_pi4cxpsk_modulation {
 	float rotation;				/*!< \brief rotation per symbol */
 	int nbits;				/*!< \brief ebits/sym           */
-	struct gmr1_pi4cxpsk_symbol *syms;	/*!< \brief Symbols (sym order) */
-	struct gmr1_pi4cxpsk_symbol *bits;	/*!< \brief Symbols (bit order) */
+	const struct gmr1_pi4cxpsk_symbol *syms;	/*!< \brief Symbols (sym order) */
+	const struct gmr1_pi4cxpsk_symbol *bits;	/*!< \brief Symbols (bit order) */
 };
 
 
-extern struct gmr1_pi4cxpsk_modulation gmr1_pi2cbpsk;
-extern struct gmr1_pi4cxpsk_modulation gmr1_pi4cbpsk;
-extern struct gmr1_pi4cxpsk_modulation gmr1_pi4cqpsk;
+extern const struct gmr1_pi4cxpsk_modulation gmr1_pi2cbpsk;
+extern const struct gmr1_pi4cxpsk_modulation gmr1_pi4cbpsk;
+extern const struct gmr1_pi4cxpsk_modulation gmr1_pi4cqpsk;
 
 
-/*! \brief pi4-CxPSK Synchronization sequence segment description */
+/*! \brief pi4-CxPSK Synchronization sequence segment description
+ *
+ * The reference signal of a segment is fully defined by its symbols and the
+ * modulation, so those descriptions are immutable and can be shared by any
+ * number of threads.
+ */
 struct gmr1_pi4cxpsk_sync {
 	int pos;				/*!< \brief Sync Position  */
 	int len;				/*!< \brief Sync Length    */
 	uint8_t syms[GMR1_MAX_SYNC_SYMS];	/*!< \brief Sync Symbols   */
-	struct osmo_cxvec *_ref;		/*!< \brief Ref signal     */
 };
 
 /*! \brief pi4-CxPSK Data segment description */
@@ -79,7 +83,7 @@ struct gmr1_pi4cxpsk_data {
 /*! \brief pi4-CxPSK Burst format description */
 struct gmr1_pi4cxpsk_burst {
 	/*! \brief Modulation scheme      */
-	struct gmr1_pi4cxpsk_modulation *mod;
+	const struct gmr1_pi4cxpsk_modulation *mod;
 
 	/*! \brief Beginning guard period */
 	int guard_pre;
@@ -92,28 +96,54 @@ struct gmr1_pi4cxpsk_burst {
 	int ebits;
 
 	/*! \brief Sync sequences */
-	struct gmr1_pi4cxpsk_sync *sync[GMR1_MAX_SYNC];
+	const struct gmr1_pi4cxpsk_sync *sync[GMR1_MAX_SYNC];
 	/*! \brief Data chunks */
-	struct gmr1_pi4cxpsk_data *data;
+	const struct gmr1_pi4cxpsk_data *data;
 };
 
 
+struct gmr1_pi4cxpsk_demod_ctx;
+
+struct gmr1_pi4cxpsk_demod_ctx *
+gmr1_pi4cxpsk_demod_alloc(const struct gmr1_pi4cxpsk_burst *burst_type,
+                          int sps, int max_win);
+
+void
+gmr1_pi4cxpsk_demod_release(struct gmr1_pi4cxpsk_demod_ctx *ctx);
+
 int
-gmr1_pi4cxpsk_demod(struct gmr1_pi4cxpsk_burst *burst_type,
+gmr1_pi4cxpsk_demod_ex(struct gmr1_pi4cxpsk_demod_ctx *ctx,
+                       struct osmo_cxvec *burst_in, float freq_shift,
+                       sbit_t *ebits,
+                       int *sync_id_p, float *toa_p, float *freq_err_p);
+
+int
+gmr1_pi4cxpsk_demod(const struct gmr1_pi4cxpsk_burst *burst_type,
                     struct osmo_cxvec *burst_in, int sps, float freq_shift,
                     sbit_t *ebits,
                     int *sync_id_p, float *toa_p, float *freq_err_p);
 
 int
-gmr1_pi4cxpsk_detect(struct gmr1_pi4cxpsk_burst **burst_types, float e_toa,
+gmr1_pi4cxpsk_detect(const struct gmr1_pi4cxpsk_burst **burst_types, float e_toa,
                      struct osmo_cxvec *burst_in, int sps, float freq_shift,
                      int *bt_id_p, int *sync_id_p, float *toa_p);
 
+int
+gmr1_pi4cxpsk_detect_demod(struct gmr1_pi4cxpsk_demod_ctx **ctxs, float e_toa,
+                           struct osmo_cxvec *burst_in, float freq_shift,
+                           sbit_t *ebits,
+                           int *bt_id_p, int *sync_id_p, float *toa_p,
+                           float *freq_err_p);
+
+void
+gmr1_pi4cxpsk_soft_bits(const struct gmr1_pi4cxpsk_modulation *mod,
+                        const float complex *syms, int n, sbit_t *ebits);
+
 int
 gmr1_pi4cxpsk_mod_order(struct osmo_cxvec *burst_in, int sps, float freq_shift);
 
 int
-gmr1_pi4cxpsk_mod(struct gmr1_pi4cxpsk_burst *burst_type,
+gmr1_pi4cxpsk_mod(const struct gmr1_pi4cxpsk_burst *burst_type,
                   ubit_t *ebits, int sync_id, struct osmo_cxvec *burst_out);
 
 
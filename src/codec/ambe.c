@@ -43,8 +43,13 @@ ambe_decode_init(struct ambe_decoder *dec)
 
 	ambe_synth_init(&dec->synth);
 
+#ifdef AMBE_FIXED
+	dec->sf_prev.w0 = 64104752;	/* 0.09378 rad/samp */
+#else
 	dec->sf_prev.w0 = 0.09378f;
 	dec->sf_prev.f0 = dec->sf_prev.w0 / (2 * M_PIf);
+#endif
+	dec->sf_prev.f0log = -6.06607f;	/* log2(w0 / (2*pi)) */
 	dec->sf_prev.L  = 30;
 }
 
@@ -93,6 +98,9 @@ ambe_decode_speech(struct ambe_decoder *dec,
 	struct ambe_raw_params rp;
 	struct ambe_subframe sf[2];
 
+	/* Harmonics past L read as unvoiced and silent by the synthesis */
+	memset(sf, 0x00, sizeof(sf));
+
 	/* Unpack frame */
 	ambe_frame_unpack_raw(&rp, frame);
 
@@ -100,4 +100,40 @@ gmr1_codec_decode_dtx(struct gmr1_codec *codec,
 	return ambe_decode_dtx(&codec->dec, audio, N);
 }
 
+/*! \brief Decodes one AMBE frame to audio for each of several codecs
+ *  \param[in] codecs Codec objects (all distinct)
+ *  \param[in] n Number of codecs
+ *  \param[out] audio Output audio buffers, one per codec
+ *  \param[in] N number of audio samples to produce (152..168)
+ *  \param[in] frames Frame data of each codec (10 bytes = 80 bits), or
+ *                    NULL to generate audio for a DTX period
+ *  \param[in] bad Bad Frame Indicators of each codec (can be NULL)
+ *  \returns 0 for success. First negative error code otherwise.
+ *
+ * Same as calling \ref gmr1_codec_decode_frame (or
+ * \ref gmr1_codec_decode_dtx) for each codec in turn, all the codecs
+ * being handled even if one of them fails.
+ */
+int
+gmr1_codec_decode_batch(struct gmr1_codec **codecs, int n,
+                        int16_t **audio, int N,
+                        const uint8_t * const *frames, const int *bad)
+{
+	int i, rv, err = 0;
+
+	for (i=0; i<n; i++)
+	{
+		if (frames[i])
+			rv = ambe_decode_frame(&codecs[i]->dec, audio[i], N,
+			                       frames[i], bad ? bad[i] : 0);
+		else
+			rv = ambe_decode_dtx(&codecs[i]->dec, audio[i], N);
+
+		if (rv && !err)
+			err = rv;
+	}
+
+	return err;
+}
+
 /*! @} */
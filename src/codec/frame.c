@@ -32,52 +32,118 @@
 #include "private.h"
 
 
-/*! \brief Grab the requested bits from a frame and shift them up as requested
- *  \param[in] frame Frame data bytes
- *  \param[in] p Position of the first bit to grab
+#ifdef AMBE_FIXED
+/*! \brief 2^(i/2^(8*(k+1))) for \ref exp2_q24 (Q30, k = 0..2) */
+static uint32_t exp2_tbl[3][256];
+
+/*! \brief Initializes \ref exp2_tbl */
+static void __attribute__ ((constructor))
+exp2_tbl_init(void)
+{
+	int i, k;
+
+	for (k=0; k<3; k++)
+		for (i=0; i<256; i++)
+			exp2_tbl[k][i] = (uint32_t)lrint(exp2(i / (256.0 * (1 << (8*k)))) * (1 << 30));
+}
+
+/*! \brief Power of 2 of a Q24 value, using \ref exp2_tbl
+ *  \param[in] x Exponent (Q24)
+ *  \param[in] q Fractional bits of the result (x + q < 32)
+ *  \returns 2^x in Q(q)
+ *
+ * Accurate to ~1e-9, as w0 drives the phase accumulators of the voiced
+ * synthesis and must follow the float decoder over whole calls.
+ */
+static uint32_t
+exp2_q24(int32_t x, int q)
+{
+	int n = (x >> 24) + q - 30;
+	uint64_t m;
+
+	if (n <= -32)
+		return 0;
+
+	m = exp2_tbl[0][(x >> 16) & 0xff];
+	m = (m * exp2_tbl[1][(x >> 8) & 0xff] + (1 << 29)) >> 30;
+	m = (m * exp2_tbl[2][ x       & 0xff] + (1 << 29)) >> 30;
+
+	return n >= 0 ? (uint32_t)(m << n) : (uint32_t)(m >> -n);
+}
+
+/*! \brief Q24 value of a float, clamped to +-64 */
+static inline int32_t
+q24(float x)
+{
+	if (x >= 64.0f)
+		return 64 << 24;
+	else if (x <= -64.0f)
+		return -(64 << 24);
+
+	return (int32_t)(x * 16777216.0f);
+}
+#endif
+
+
+/*! \brief Grab the requested bits from a MSB first word, shifted up as requested
+ *  \param[in] w Word holding the bits (bit 0 being its MSB)
+ *  \param[in] n Size of the word in bits
+ *  \param[in] p Position of the first bit to grab in the word
  *  \param[in] l Number of bits to grab (max 8)
  *  \param[in] s How many bits to shift the result up
  *  \returns The selected bits as a uint8_t
+ *
+ * All arguments but w are constants at the call sites, so this reduces to
+ * a shift and a mask.
  */
-static inline uint8_t
-_get_bits(const uint8_t *frame, int p, int l, int s)
-{
-	uint8_t v;
+#define _get_bits(w, n, p, l, s) \
+	((uint8_t)((((w) >> ((n) - (p) - (l))) & ((1 << (l)) - 1)) << (s)))
 
-	if ((p & 7) + l > 8) {
-		v = ((frame[p>>3] << 8) | frame[(p>>3)+1]) >> (16 - (p&7) - l);
-	} else {
-		v = frame[p>>3] >> (8 - (p&7) - l);
-	}
+/*! \brief Bits  0 .. 63 of a frame (64 bits word) */
+#define _B0(p, l, s) _get_bits(w0, 64, (p), (l), (s))
 
-	return (v & ((1<<l)-1)) << s;
-}
+/*! \brief Bits 64 .. 79 of a frame (16 bits word) */
+#define _B1(p, l, s) _get_bits(w1, 16, (p) - 64, (l), (s))
 
 /*! \brief Unpack a frame into its raw encoded parameters
  *  \param[out] rp Encoded frame raw parameters to unpack into
  *  \param[in] frame Frame data (10 bytes = 80 bits)
+ *
+ * The frame is loaded once as a 64 bits and a 16 bits word, no field
+ * straddling them, and each field is then a fixed shift and mask.
  */
 void
 ambe_frame_unpack_raw(struct ambe_raw_params *rp, const uint8_t *frame)
 {
-	const uint8_t *p = frame;
-
-	rp->pitch          = _get_bits(p,  0, 7, 0);
-	rp->pitch_interp   = _get_bits(p, 48, 2, 0);
-	rp->gain           = _get_bits(p,  7, 6, 2) | _get_bits(p, 50, 2, 0);
-	rp->v_uv           = _get_bits(p, 13, 6, 0);
-	rp->sf1_prba12     = _get_bits(p, 19, 6, 1) | _get_bits(p, 52, 1, 0);
-	rp->sf1_prba34     = _get_bits(p, 25, 3, 3) | _get_bits(p, 53, 3, 0);
-	rp->sf1_prba57     = _get_bits(p, 28, 3, 4) | _get_bits(p, 56, 4, 0);
-	rp->sf1_hoc[0]     = _get_bits(p, 31, 3, 4) | _get_bits(p, 60, 4, 0);
-	rp->sf1_hoc[1]     = _get_bits(p, 34, 3, 3) | _get_bits(p, 64, 3, 0);
-	rp->sf1_hoc[2]     = _get_bits(p, 37, 2, 4) | _get_bits(p, 67, 4, 0);
-	rp->sf1_hoc[3]     = _get_bits(p, 39, 2, 3) | _get_bits(p, 71, 3, 0);
-	rp->sf0_mag_interp = _get_bits(p, 46, 2, 0);
-	rp->sf0_perr_14    = _get_bits(p, 41, 3, 3) | _get_bits(p, 74, 3, 0);
-	rp->sf0_perr_58    = _get_bits(p, 44, 2, 3) | _get_bits(p, 77, 3, 0);
+	uint64_t w0 = 0;
+	uint16_t w1;
+	int i;
+
+	for (i=0; i<8; i++)
+		w0 = (w0 << 8) | frame[i];
+
+	w1 = (frame[8] << 8) | frame[9];
+
+	rp->pitch          = _B0( 0, 7, 0);
+	rp->pitch_interp   = _B0(48, 2, 0);
+	rp->gain           = _B0( 7, 6, 2) | _B0(50, 2, 0);
+	rp->v_uv           = _B0(13, 6, 0);
+	rp->sf1_prba12     = _B0(19, 6, 1) | _B0(52, 1, 0);
+	rp->sf1_prba34     = _B0(25, 3, 3) | _B0(53, 3, 0);
+	rp->sf1_prba57     = _B0(28, 3, 4) | _B0(56, 4, 0);
+	rp->sf1_hoc[0]     = _B0(31, 3, 4) | _B0(60, 4, 0);
+	rp->sf1_hoc[1]     = _B0(34, 3, 3) | _B1(64, 3, 0);
+	rp->sf1_hoc[2]     = _B0(37, 2, 4) | _B1(67, 4, 0);
+	rp->sf1_hoc[3]     = _B0(39, 2, 3) | _B1(71, 3, 0);
+	rp->sf0_mag_interp = _B0(46, 2, 0);
+	rp->sf0_perr_14    = _B0(41, 3, 3) | _B1(74, 3, 0);
+	rp->sf0_perr_58    = _B0(44, 2, 3) | _B1(77, 3, 0);
 }
 
+#undef _B1
+#undef _B0
+#undef _get_bits
+
 /*! \brief Interpolates fundamental between subframes
  *  \param[in] f0log_prev log(fund(-1)) Previous subframe log freq
  *  \param[in] f0log_cur  log(fund(0))  Current  subframe log freq
@@ -127,7 +193,11 @@ ambe_interpolate_f0log(float f0log_prev, float f0log_cur, int rule)
 static void
 ambe_subframe_compute_L_Lb(struct ambe_subframe *sf)
 {
+#ifdef AMBE_FIXED
+	sf->L = (int)(2040538962U / sf->w0);	/* 0.4751 / f0 */
+#else
 	sf->L = (int)floorf(0.4751f / sf->f0);
+#endif
 
 	if (sf->L < 9)
 		sf->L = 9;
@@ -315,11 +385,16 @@ ambe_frame_decode_params(struct ambe_subframe *sf,
 
 	/* Fundamental */
 	sf[1].f0log = -4.312f - 2.1336e-2f * (rp->pitch /* + 0.5 */);
-	sf[1].f0 = powf(2.0f, sf[1].f0log);
-
 	sf[0].f0log = ambe_interpolate_f0log(sf_prev->f0log, sf[1].f0log,
 	                                     rp->pitch_interp);
+
+#ifdef AMBE_FIXED
+	sf[1].w0 = exp2_q24(q24(sf[1].f0log), 32);
+	sf[0].w0 = exp2_q24(q24(sf[0].f0log), 32);
+#else
+	sf[1].f0 = powf(2.0f, sf[1].f0log);
 	sf[0].f0 = powf(2.0f, sf[0].f0log);
+#endif
 
 	/* Harmonics count (total and per-block) */
 	ambe_subframe_compute_L_Lb(&sf[0]);
@@ -352,7 +427,31 @@ ambe_frame_decode_params(struct ambe_subframe *sf,
 
 /*! \brief Expands the decoded subframe params to prepare for synthesis
  *  \param[in] sf The subframe to expand
+ *
+ * The fixed point version works on the log2 of the magnitudes, where the
+ * 1/6 and unvoiced 0.2046/sqrt(w0) factors are offsets, and only takes a
+ * single \ref exp2_q24 per harmonic.
  */
+#ifdef AMBE_FIXED
+void
+ambe_subframe_expand(struct ambe_subframe *sf)
+{
+	int32_t unvc;
+	int i;
+
+	/* log2(0.2046 / sqrt(2*pi*f0)), Q24 */
+	unvc = -60647455 - (q24(sf->f0log) >> 1);
+
+	for (i=0; i<sf->L; i++) {
+		int j = (int)(((uint64_t)i * sf->w0) >> 28);	/* i * 16 * f0 */
+		int32_t e = q24(sf->Mlog[i]) - 43368474;	/* - log2(6) */
+		sf->Vl[i] = sf->v_uv[j];
+		if (!sf->Vl[i])
+			e += unvc;
+		sf->Ml[i] = (e >= (16 << 24)) ? AMBE_ML_MAX : (int32_t)exp2_q24(e, 12);
+	}
+}
+#else
 void
 ambe_subframe_expand(struct ambe_subframe *sf)
 {
@@ -371,5 +470,6 @@ ambe_subframe_expand(struct ambe_subframe *sf)
 			sf->Ml[i] *= unvc;
 	}
 }
+#endif
 
 /*! @} */
@@ -30,17 +30,65 @@
 #include "private.h"
 
 
+#define DFT_N		128	/*!< \brief DFT size using \ref dft_tbl_c */
+#define IDCT_MAX_N	56	/*!< \brief Max iDCT size using \ref idct_tbl */
+#define IDCT_MAX_M	9	/*!< \brief Max iDCT components using \ref idct_tbl */
+
 /*! \brief Table for \ref cosf_fast and \ref sinf_fast */
 static float cos_tbl[1024];
 
-/*! \brief Initializes \ref cos_tbl for \ref cosf_fast */
+/*! \brief Cosinus matrices of the iDCT, one per size N (1 .. IDCT_MAX_N)
+ *
+ * The matrix for size N starts at IDCT_TBL_OFS(N) and holds the
+ * 2 * cosf_fast((pi/N) * j * (i + .5)) terms of \ref ambe_idct, row j
+ * (1 .. IDCT_MAX_M-1) first, so that each row is contiguous in i. Row 0
+ * is unused.
+ */
+static float idct_tbl[IDCT_MAX_M * IDCT_MAX_N * (IDCT_MAX_N + 1) / 2];
+
+/*! \brief Offset of the size N matrix in \ref idct_tbl */
+#define IDCT_TBL_OFS(N) (IDCT_MAX_M * (N) * ((N) - 1) / 2)
+
+/*! \brief Twiddles of the DFTs of size DFT_N, [fb][ts]
+ *
+ * cosf_fast / sinf_fast of (-2*pi/DFT_N) * fb * ts, exactly the terms the
+ * direct loops use, so the results are the same. The transposed copies,
+ * [ts][fb], let the forward DFT accumulate all the bins at once.
+ */
+static float dft_tbl_c[DFT_N/2+1][DFT_N];
+static float dft_tbl_s[DFT_N/2+1][DFT_N];
+static float dft_tbl_ct[DFT_N][DFT_N/2+1];
+static float dft_tbl_st[DFT_N][DFT_N/2+1];
+
+/*! \brief Initializes \ref cos_tbl for \ref cosf_fast, \ref idct_tbl
+ *         and the \ref dft_tbl_c twiddles */
 static void __attribute__ ((constructor))
 cos_tbl_init(void)
 {
-	int i;
+	int i, j, N, fb, ts;
 
 	for (i=0; i<1024; i++)
 		cos_tbl[i] = cosf((M_PIf * i) / 512.0f);
+
+	for (N=1; N<=IDCT_MAX_N; N++)
+	{
+		float *m = &idct_tbl[IDCT_TBL_OFS(N)];
+
+		for (j=1; j<IDCT_MAX_M; j++)
+			for (i=0; i<N; i++)
+				m[j*N+i] = 2.0f * cosf_fast( (M_PIf / N) * j * (i + .5f) );
+	}
+
+	for (fb=0; fb<=(DFT_N/2); fb++)
+	{
+		for (ts=0; ts<DFT_N; ts++)
+		{
+			float angle = (- 2.0f * M_PIf / DFT_N) * fb * ts;
+
+			dft_tbl_c[fb][ts] = dft_tbl_ct[ts][fb] = cosf_fast(angle);
+			dft_tbl_s[fb][ts] = dft_tbl_st[ts][fb] = sinf_fast(angle);
+		}
+	}
 }
 
 /*! \brief Fast Cosinus approximation using a simple table
@@ -94,12 +142,35 @@ ambe_fdct(float *out, float *in, int N, int M)
  *  \param[in] in iDCT input buffer (freq domain, M elements)
  *  \param[in] N Number of points of the DCT
  *  \param[in] M Limit to the number of frequency components (M <= N)
+ *
+ * Sizes up to IDCT_MAX_N / IDCT_MAX_M (all the PRBA, HOC and phase error
+ * vectors) use the \ref idct_tbl matrices, with the same result as the
+ * direct computation.
  */
 void
 ambe_idct(float *out, float *in, int N, int M)
 {
 	int i, j;
 
+	if ((N > 0) && (N <= IDCT_MAX_N) && (M <= IDCT_MAX_M))
+	{
+		const float *m = &idct_tbl[IDCT_TBL_OFS(N)];
+
+		for (i=0; i<N; i++)
+			out[i] = in[0];
+
+		for (j=1; j<M; j++)
+		{
+			const float *r = &m[j*N];
+			const float c = in[j];
+
+			for (i=0; i<N; i++)
+				out[i] += c * r[i];
+		}
+
+		return;
+	}
+
 	for (i=0; i<N; i++)
 	{
 		float v = in[0];
@@ -122,12 +193,37 @@ ambe_idct(float *out, float *in, int N, int M)
  *
  *  Since the input is float, the result is symmetric and so only one side
  *  is computed. The output index 0 is DC.
+ *
+ *  For N = DFT_N, the twiddles come from \ref dft_tbl_ct and all the
+ *  bins are accumulated together, in the same order as the direct loops.
  */
 void
 ambe_fdft_fc(float *out_i, float *out_q, float *in, int N, int M)
 {
 	int fb, ts;
 
+	if ((N != DFT_N) || (M > N))
+		goto direct;
+
+	for (fb=0; fb<=(DFT_N/2); fb++)
+		out_i[fb] = out_q[fb] = 0.0f;
+
+	for (ts=0; ts<M; ts++)
+	{
+		const float *c = dft_tbl_ct[ts];
+		const float *s = dft_tbl_st[ts];
+		const float v = in[ts];
+
+		for (fb=0; fb<=(DFT_N/2); fb++)
+		{
+			out_i[fb] += v * c[fb];
+			out_q[fb] += v * s[fb];
+		}
+	}
+
+	return;
+
+direct:
 	for (fb=0; fb<=(N/2); fb++)
 	{
 		float i=0.0f, q=0.0f;
@@ -153,12 +249,39 @@ ambe_fdft_fc(float *out_i, float *out_q, float *in, int N, int M)
  *
  *  The input is assumed to be symmetric and so only N/2+1 inputs are
  *  needed. DC component must be input index 0.
+ *
+ *  For N = DFT_N, the twiddles come from \ref dft_tbl_c and all the
+ *  samples are accumulated together, in the same order as the direct loops.
  */
 void
 ambe_idft_cf(float *out, float *in_i, float *in_q, int N, int M)
 {
+	float r[DFT_N];
 	int fb, ts;
 
+	if ((N != DFT_N) || (M > N))
+		goto direct;
+
+	for (ts=0; ts<M; ts++)
+		r[ts] = 0.0f;
+
+	for (fb=0; fb<=(DFT_N/2); fb++)
+	{
+		const float *c = dft_tbl_c[fb];
+		const float *s = dft_tbl_s[fb];
+		const float m = (fb == 0 || fb == (DFT_N/2)) ? 1.0f : 2.0f;
+		const float vi = in_i[fb], vq = in_q[fb];
+
+		for (ts=0; ts<M; ts++)
+			r[ts] += m * (vi * c[ts] + vq * s[ts]);
+	}
+
+	for (ts=0; ts<M; ts++)
+		out[ts] = r[ts] / DFT_N;
+
+	return;
+
+direct:
 	for (ts=0; ts<M; ts++)
 	{
 		float r=0.0f;
@@ -64,19 +64,41 @@ struct ambe_raw_params
 /*! \brief AMBE subframe parameters */
 struct ambe_subframe
 {
+#ifdef AMBE_FIXED
+	uint32_t w0;		/*!< \brief fundamental frequency (2^32 = 2*pi per sample) */
+#else
 	float f0;               /*!< \brief fundamental normalized frequency */
-	float f0log;		/*!< \brief log2(f0) */
 	float w0;		/*!< \brief fundamental frequency (rad/samp) */
+#endif
+	float f0log;		/*!< \brief log2(f0) */
 	int L;                  /*!< \brief Number of harmonics */
 	int Lb[4];              /*!< \brief Harmonics per block */
 	int v_uv[8];            /*!< \brief Voicing state */
 	int Vl[56];		/*!< \brief Per-harmonic voicing state */
 	float gain;		/*!< \brief Gain */
 	float Mlog[56];         /*!< \brief log spectral magnitudes */
+#ifdef AMBE_FIXED
+	int32_t Ml[56];		/*!< \brief spectral magnitudes (Q12, <= \ref AMBE_ML_MAX) */
+#else
 	float Ml[56];		/*!< \brief spectral magnitudes */
+#endif
 };
 
+#ifdef AMBE_FIXED
+#define AMBE_ML_MAX	(1 << 28)	/*!< \brief Spectral magnitudes clamp (65536, Q12) */
+#endif
+
 /*! \brief AMBE synthesizer state */
+#ifdef AMBE_FIXED
+struct ambe_synth
+{
+	int16_t u_prev;		/*!< \brief Last 'u' of previous subframe */
+	int32_t uw_prev[121];	/*!< \brief Unvoiced data from previous subframe (Q4) */
+	uint32_t psi1;		/*!< \brief Current PSI angle for fundamental (2^32 = 2*pi) */
+	uint32_t phi[56];	/*!< \brief Current phase for each harmonic (2^32 = 2*pi) */
+	int64_t SE;		/*!< \brief Current energy parameter (Q16) */
+};
+#else
 struct ambe_synth
 {
 	int16_t u_prev;		/*!< \brief Last 'u' of previous subframe */
@@ -85,6 +107,7 @@ struct ambe_synth
 	float phi[56];		/*!< \brief Current phase for each harmonic */
 	float SE;		/*!< \brief Current energy parameter */
 };
+#endif
 
 /*! \brief AMBE decoder state */
 struct ambe_decoder
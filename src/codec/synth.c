@@ -197,20 +197,140 @@ ambe_synth_unvoiced(struct ambe_synth *synth, float *suv, struct ambe_subframe *
 	memcpy(synth->uw_prev, uw, sizeof(float) * 121);
 }
 
+#define VS_LANES	8	/*!< \brief Harmonics advanced together */
+#define VS_MAX		56	/*!< \brief Max harmonics in a bank (VS_LANES multiple) */
+#define VS_RENORM	16	/*!< \brief Rotators renormalization period */
+
+/*! \brief Bank of harmonic oscillators (struct of arrays)
+ *
+ * Each harmonic is a unit rotator z = exp(j*phase) advanced at every
+ * sample by the rotator r, itself advanced by q (so that the phase can
+ * be quadratic in time), weighted by an amplitude ramping by da. The
+ * layout lets VS_LANES harmonics advance together in vector registers.
+ */
+struct vs_bank {
+	int n;			/*!< \brief Number of harmonics */
+	float a[VS_MAX];	/*!< \brief Amplitude */
+	float da[VS_MAX];	/*!< \brief Amplitude step */
+	float zr[VS_MAX];	/*!< \brief Phase rotator (real) */
+	float zi[VS_MAX];	/*!< \brief Phase rotator (imag) */
+	float rr[VS_MAX];	/*!< \brief Angular speed rotator (real) */
+	float ri[VS_MAX];	/*!< \brief Angular speed rotator (imag) */
+	float qr[VS_MAX];	/*!< \brief Angular accel. rotator (real) */
+	float qi[VS_MAX];	/*!< \brief Angular accel. rotator (imag) */
+};
+
+/*! \brief Add a harmonic to an oscillator bank
+ *  \param[inout] bank Oscillator bank
+ *  \param[in] a Amplitude of the first sample
+ *  \param[in] da Amplitude step per sample
+ *  \param[in] phase Phase of the first sample
+ *  \param[in] w Phase increment between the first two samples
+ *  \param[in] dw Increment of the phase increment per sample
+ */
+static void
+vs_bank_add(struct vs_bank *bank, float a, float da,
+            float phase, float w, float dw)
+{
+	int n = bank->n++;
+
+	bank->a[n]  = a;
+	bank->da[n] = da;
+	bank->zr[n] = cosf(phase);
+	bank->zi[n] = sinf(phase);
+	bank->rr[n] = cosf(w);
+	bank->ri[n] = sinf(w);
+	bank->qr[n] = cosf(dw);
+	bank->qi[n] = sinf(dw);
+}
+
+/*! \brief Run an oscillator bank
+ *  \param[inout] bank Oscillator bank
+ *  \param[out] out Sum of all the harmonics (N samples)
+ *  \param[in] N Number of samples to generate
+ */
+static void
+vs_bank_run(struct vs_bank *bank, float *out, int N)
+{
+	float acc[80][VS_LANES];
+	int b, i, k;
+
+	memset(acc, 0x00, sizeof(float) * VS_LANES * N);
+
+	/* Pad the last block with silent harmonics */
+	for (k=bank->n; k & (VS_LANES-1); k++)
+		vs_bank_add(bank, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+	for (b=0; b<bank->n; b+=VS_LANES)
+	{
+		float *a  = &bank->a[b],  *da = &bank->da[b];
+		float *zr = &bank->zr[b], *zi = &bank->zi[b];
+		float *rr = &bank->rr[b], *ri = &bank->ri[b];
+		float *qr = &bank->qr[b], *qi = &bank->qi[b];
+
+		for (i=0; i<N; i++)
+		{
+			for (k=0; k<VS_LANES; k++)
+			{
+				float t;
+
+				acc[i][k] += a[k] * zr[k];
+				a[k] += da[k];
+
+				t     = zr[k] * rr[k] - zi[k] * ri[k];
+				zi[k] = zr[k] * ri[k] + zi[k] * rr[k];
+				zr[k] = t;
+
+				t     = rr[k] * qr[k] - ri[k] * qi[k];
+				ri[k] = rr[k] * qi[k] + ri[k] * qr[k];
+				rr[k] = t;
+			}
+
+			/* Keep the rotators on the unit circle */
+			if ((i % VS_RENORM) != (VS_RENORM - 1))
+				continue;
+
+			for (k=0; k<VS_LANES; k++)
+			{
+				float gz = 1.5f - 0.5f * (zr[k] * zr[k] + zi[k] * zi[k]);
+				float gr = 1.5f - 0.5f * (rr[k] * rr[k] + ri[k] * ri[k]);
+
+				zr[k] *= gz; zi[k] *= gz;
+				rr[k] *= gr; ri[k] *= gr;
+			}
+		}
+	}
+
+	for (i=0; i<N; i++)
+	{
+		float s = 0.0f;
+
+		for (k=0; k<VS_LANES; k++)
+			s += acc[i][k];
+
+		out[i] = s;
+	}
+}
+
 /*! \brief Perform voiced synthesis
  *  \param[in] synth Synthesizer state structure
  *  \param[out] sv Result buffer (80 samples)
  *  \param[in] sf Expanded subframe data for current subframe
  *  \param[in] sf_prev Expanded subframe data for prevous subframe
+ *
+ * The harmonics are sorted in three oscillator banks (fine transitions,
+ * coarse transitions of the current and of the previous frame), the
+ * synthesis window being common to all the harmonics of a bank.
  */
 static void
 ambe_synth_voiced(struct ambe_synth *synth, float *sv,
                   struct ambe_subframe *sf, struct ambe_subframe *sf_prev)
 {
+	struct vs_bank bank_fine, bank_cur, bank_prev;
+	float s_fine[80], s_cur[59], s_prev[60];
 	int i, l, L_max, L_uv;
 
-	/* Pre-clear */
-	memset(sv, 0x00, sizeof(float) * 80);
+	bank_fine.n = bank_cur.n = bank_prev.n = 0;
 
 	/* How many subband to process */
 	L_max = sf_prev->L > sf->L ? sf_prev->L : sf->L;
@@ -254,7 +374,7 @@ ambe_synth_voiced(struct ambe_synth *synth, float *sv,
 			/* Can we do a fine transistion ? */
 		fine = Vl_cur && Vl_prev && (l < 7) && (fabsf(w_cur - w_prev) < (.1f * w_cur));
 
-			/* Fine transition */
+			/* Fine transition: phase phi_prev + (THa + THb * i) * i */
 		if (fine)
 		{
 			float Ml_step = (Ml_cur - Ml_prev) / 80.0f;
@@ -263,30 +383,38 @@ ambe_synth_voiced(struct ambe_synth *synth, float *sv,
 			float THa = w_prev + Dwl;
 			float THb = (w_cur - w_prev) / 160.0f;
 
-			for (i=0; i<80; i++)
-				sv[i] += (Ml_prev + i * Ml_step) * cosf_fast(
-					phi_prev + (THa + THb * i) * i
-				);
+			vs_bank_add(&bank_fine, Ml_prev, Ml_step,
+			            phi_prev, THa + THb, 2.0f * THb);
 		}
 
-			/* Coarse transition: Current frame (if voiced) */
+			/* Coarse transition: Current frame (if voiced), from i=21 */
 		if (!fine && Vl_cur)
-		{
-			for (i=21; i<80; i++)
-				sv[i] += ws[i-20] * Ml_cur * cosf_fast(phi_cur + w_cur * (i - 80));
-		}
+			vs_bank_add(&bank_cur, Ml_cur, 0.0f,
+			            phi_cur + w_cur * (21 - 80), w_cur, 0.0f);
 
 			/* Coarse transition: Previous frame (if voiced) */
 		if (!fine && Vl_prev)
-		{
-			for (i=0; i<60; i++)
-				sv[i] += ws[i+60] * Ml_prev * cosf_fast(phi_prev + w_prev * i);
-		}
+			vs_bank_add(&bank_prev, Ml_prev, 0.0f,
+			            phi_prev, w_prev, 0.0f);
 	}
 
 	/* Still need to update phi for the rest of the bands */
 	for (l=L_max; l<56; l++)
 		synth->phi[l] = (synth->psi1 * (l+1)) + (((float)L_uv / (float)sf->L) * rho[l]);
+
+	/* Run the banks and window */
+	vs_bank_run(&bank_fine, s_fine, 80);
+	vs_bank_run(&bank_cur,  s_cur,  59);
+	vs_bank_run(&bank_prev, s_prev, 60);
+
+	for (i=0; i<80; i++)
+		sv[i] = s_fine[i];
+
+	for (i=21; i<80; i++)
+		sv[i] += ws[i-20] * s_cur[i-21];
+
+	for (i=0; i<60; i++)
+		sv[i] += ws[i+60] * s_prev[i];
 }
 
 
@@ -384,8 +512,11 @@ ambe_synth_audio(struct ambe_synth *synth, int16_t *audio,
 
 	ambe_synth_unvoiced(synth, suv, sf);
 	ambe_synth_voiced(synth, sv, sf, sf_prev);
-	for (i=0; i<80; i++)
-		audio[i] = (int16_t)((suv[i] + 2.0f * sv[i]) * 4.0f);
+
+	for (i=0; i<80; i++) {
+		float v = (suv[i] + 2.0f * sv[i]) * 4.0f;
+		audio[i] = v > 32767.0f ? 32767 : (v < -32768.0f ? -32768 : (int16_t)v);
+	}
 }
 
 /*! @} */
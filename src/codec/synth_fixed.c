@@ -0,0 +1,634 @@
+/* GMR-1 AMBE vocoder - Fixed point speech synthesis */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \addtogroup codec_private
+ *  @{
+ */
+
+/*! \file codec/synth_fixed.c
+ *  \brief Osmocom GMR-1 AMBE vocoder fixed point speech synthesis
+ *
+ * Replacement of synth.c for receivers without a fast FPU, selected with
+ * --enable-fixed-codec. Enhancement, voiced and unvoiced synthesis are
+ * done on integers:
+ *  - phases are uint32_t (2^32 = 2*pi) and wrap by themselves
+ *  - sinusoids come from a Q15 table with linear interpolation
+ *  - amplitudes are Q12, the unvoiced spectrum goes through integer FFTs
+ *  - square/fourth roots and ratios use integer sqrt and divisions
+ * It gets w0 and the Ml magnitudes already in fixed point from frame.c.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "private.h"
+
+
+/*! \brief Synthesis window (39 samples overlap), Q15 */
+static const int16_t ws_q15[] = {
+	    0,   819,  1638,  2458,  3277,  4096,  4915,  5734,
+	 6554,  7373,  8192,  9011,  9830, 10650, 11469, 12288,
+	13107, 13926, 14746, 15565, 16384, 17203, 18022, 18842,
+	19661, 20480, 21299, 22118, 22938, 23757, 24576, 25395,
+	26214, 27034, 27853, 28672, 29491, 30310, 31130, 31949,
+	32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+	32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+	32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+	32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+	32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+	32767, 31949, 31130, 30310, 29491, 28672, 27853, 27034,
+	26214, 25395, 24576, 23757, 22938, 22118, 21299, 20480,
+	19661, 18842, 18022, 17203, 16384, 15565, 14746, 13926,
+	13107, 12288, 11469, 10650,  9830,  9011,  8192,  7373,
+	 6554,  5734,  4915,  4096,  3277,  2458,  1638,   819,
+	    0,
+};
+
+/*! \brief Random phase increment (precomputed, 2^32 = 2*pi) */
+static const int32_t rho_ang[] = {
+	 2052731484,  -263680520, -1233191404,   484230122,  2105443253,
+	  160116279, -1778338813,  1753276575,    69083157,  -165128864,
+	-1560699832,   314775657, -1101411639,  1543722121, -1404909153,
+	 1185249553,  1720695120, -1207320509,   613179926, -1613896932,
+	 -191969738, -1855547510,  1435549967,  1572422976,  -792092884,
+	-1397390619, -1824016695, -1762735068,   126484184,  1060502992,
+	 1863955363,  1815285516,  2082725645,   570331321,  -351075708,
+	 1002131986,   472426317,    87030847, -1391003385,  -731862580,
+	  312107702, -1557627889,   840116079, -1462552846,   -81856942,
+	 -206118172,    20090667,    47012202,   355683621,  1598940524,
+	 -552544952,   910614216,  2002687670,  -231261070,    15562731,
+	 -727173322,
+};
+
+
+/*! \brief cos() table for \ref cos_q15 (Q15, 1024 steps + 1) */
+static int16_t cos_tbl_q15[1025];
+
+/*! \brief Overlap-add weights of uw_prev and uw (Q14, i = 21..59) */
+static int32_t ola_w[39][2];
+
+/*! \brief Initializes \ref cos_tbl_q15 and \ref ola_w */
+static void __attribute__ ((constructor))
+synth_fixed_init(void)
+{
+	int i;
+
+	for (i=0; i<1025; i++) {
+		int32_t v = (int32_t)lrint(cos((M_PI * i) / 512.0) * 32768.0);
+		cos_tbl_q15[i] = v > 32767 ? 32767 : v;
+	}
+
+	for (i=21; i<60; i++) {
+		int64_t a = ws_q15[i + 60], b = ws_q15[i - 20];
+		int64_t d = a * a + b * b;
+
+		ola_w[i-21][0] = (int32_t)((a << 29) / d);
+		ola_w[i-21][1] = (int32_t)((b << 29) / d);
+	}
+}
+
+/*! \brief Cosinus of a phase (2^32 = 2*pi), Q15 */
+static inline int32_t
+cos_q15(uint32_t a)
+{
+	int i = a >> 22;
+	int32_t f = (a >> 7) & 0x7fff;
+	int32_t c0 = cos_tbl_q15[i];
+	int32_t c1 = cos_tbl_q15[i+1];
+
+	return c0 + (((c1 - c0) * f) >> 15);
+}
+
+/*! \brief Multiply by a Q15 factor */
+static inline int32_t
+mul_q15(int32_t x, int32_t f)
+{
+	return (int32_t)(((int64_t)x * f) >> 15);
+}
+
+/*! \brief Integer square root */
+static uint32_t
+isqrt64(uint64_t x)
+{
+	uint64_t r = 0, b = 1ULL << 62;
+
+	while (b > x)
+		b >>= 2;
+
+	while (b) {
+		if (x >= r + b) {
+			x -= r + b;
+			r = (r >> 1) + b;
+		} else {
+			r >>= 1;
+		}
+		b >>= 2;
+	}
+
+	return (uint32_t)r;
+}
+
+
+/*! \brief In place radix-2 complex FFT of 64 points (forward)
+ *  \param[inout] re Real components (input in bit reversed order)
+ *  \param[inout] im Imag components (input in bit reversed order)
+ *  \param[in] shift Right shift applied at each of the 6 stages
+ */
+static void
+fft64_q(int32_t *re, int32_t *im, int shift)
+{
+	int len, i, j;
+
+	for (len=2; len<=64; len<<=1)
+	{
+		int half = len >> 1;
+		int ts = 1024 / len;
+
+		for (j=0; j<half; j++)
+		{
+			int32_t c = cos_tbl_q15[(j * ts) & 1023];
+			int32_t s = cos_tbl_q15[(j * ts - 256) & 1023];
+
+			for (i=j; i<64; i+=len)
+			{
+				int32_t tr = (int32_t)(((int64_t)re[i+half] * c + (int64_t)im[i+half] * s) >> 15);
+				int32_t ti = (int32_t)(((int64_t)im[i+half] * c - (int64_t)re[i+half] * s) >> 15);
+
+				re[i+half] = (re[i] - tr) >> shift;
+				im[i+half] = (im[i] - ti) >> shift;
+				re[i] = (re[i] + tr) >> shift;
+				im[i] = (im[i] + ti) >> shift;
+			}
+		}
+	}
+}
+
+/*! \brief Bit reversal of an index of the 64 points FFT */
+static inline int
+fft64_rev(int i)
+{
+	int r = 0, n;
+
+	for (n=0; n<6; n++) {
+		r = (r << 1) | (i & 1);
+		i >>= 1;
+	}
+
+	return r;
+}
+
+/*! \brief 128 points forward DFT (real->complex, unscaled)
+ *  \param[out] out_i Real component result buffer (65 elements)
+ *  \param[out] out_q Imag component result buffer (65 elements)
+ *  \param[in] in Input buffer (M elements, |x| < 2^16)
+ *  \param[in] M Number of available input elements (<= 128)
+ */
+static void
+fdft128_q(int32_t *out_i, int32_t *out_q, const int32_t *in, int M)
+{
+	int32_t re[64], im[64];
+	int fb, ts;
+
+	for (ts=0; ts<64; ts++) {
+		int r = fft64_rev(ts);
+		re[r] = ((2*ts  ) < M) ? in[2*ts  ] : 0;
+		im[r] = ((2*ts+1) < M) ? in[2*ts+1] : 0;
+	}
+
+	fft64_q(re, im, 0);
+
+	for (fb=0; fb<=64; fb++)
+	{
+		int a = fb & 63, b = (64 - fb) & 63;
+		int32_t er = (re[a] + re[b]) >> 1;
+		int32_t ei = (im[a] - im[b]) >> 1;
+		int32_t or = (im[a] + im[b]) >> 1;
+		int32_t oi = (re[b] - re[a]) >> 1;
+		int32_t c = cos_tbl_q15[(fb * 8) & 1023];
+		int32_t s = cos_tbl_q15[(fb * 8 - 256) & 1023];
+
+		out_i[fb] = er + (int32_t)(((int64_t)or * c + (int64_t)oi * s) >> 15);
+		out_q[fb] = ei + (int32_t)(((int64_t)oi * c - (int64_t)or * s) >> 15);
+	}
+}
+
+/*! \brief 128 points inverse DFT (complex->real, 1/N scaled)
+ *  \param[out] out Result buffer (M elements)
+ *  \param[in] in_i Real component input buffer (65 elements)
+ *  \param[in] in_q Imag component input buffer (65 elements)
+ *  \param[in] M Number of output elements to generate (<= 128)
+ */
+static void
+idft128_q(int32_t *out, const int32_t *in_i, const int32_t *in_q, int M)
+{
+	int32_t re[64], im[64];
+	int fb, ts;
+
+	for (fb=0; fb<64; fb++)
+	{
+		int32_t ar = in_i[fb],    ai = fb ?  in_q[fb]    : 0;
+		int32_t br = in_i[64-fb], bi = fb ? -in_q[64-fb] : 0;
+		int32_t dr = (ar - br) >> 1, di = (ai - bi) >> 1;
+		int32_t c = cos_tbl_q15[(fb * 8) & 1023];
+		int32_t s = cos_tbl_q15[(fb * 8 - 256) & 1023];
+		int32_t or = (int32_t)(((int64_t)dr * c - (int64_t)di * s) >> 15);
+		int32_t oi = (int32_t)(((int64_t)di * c + (int64_t)dr * s) >> 15);
+		int r = fft64_rev(fb);
+
+		re[r] =   ((ar + br) >> 1) - oi;
+		im[r] = -(((ai + bi) >> 1) + or);
+	}
+
+	fft64_q(re, im, 1);
+
+	for (ts=0; ts<M; ts++)
+		out[ts] = (ts & 1) ? -im[ts>>1] : re[ts>>1];
+}
+
+
+/*! \brief Generates random sequence of uint16_t according to spec
+ *  \param[out] u_seq Result buffer
+ *  \param[in] u_prev Last 'u' value of where to resume from
+ *  \param[in] n Number of items to generate
+ */
+static void
+ambe_gen_random(uint16_t *u_seq, uint16_t u_prev, int n)
+{
+	uint32_t u = u_prev;
+	int i;
+
+	for (i=0; i<n; i++) {
+		u = (u * 171 + 11213) % 53125;
+		u_seq[i] = u;
+	}
+}
+
+/*! \brief Upper DFT bin edge of a band: ceil(128 * (h/2) * f0) */
+static inline int
+ambe_band_edge(uint32_t W0, int h)
+{
+	int e = (int)(((uint64_t)h * W0 + (1ULL << 26) - 1) >> 26);
+	return e > 65 ? 65 : e;
+}
+
+/*! \brief Perform unvoiced synthesis
+ *  \param[in] synth Synthesizer state structure
+ *  \param[out] suv Result buffer (80 samples, Q4)
+ *  \param[in] sf Expanded subframe data
+ */
+static void
+ambe_synth_unvoiced(struct ambe_synth *synth, int32_t *suv, struct ambe_subframe *sf)
+{
+	uint32_t W0 = sf->w0;
+	uint16_t u[121];
+	int32_t uw[121];
+	int32_t Uwi[65], Uwq[65];
+	int i, al, bl, l;
+
+	/* Generate the white noise sequence and window it with ws */
+	ambe_gen_random(u, synth->u_prev, 121);
+	synth->u_prev = u[79];
+
+	for (i=0; i<121; i++)
+		uw[i] = ((int32_t)u[i] * ws_q15[i]) >> 15;
+
+	/* Compute the DFT */
+	fdft128_q(Uwi, Uwq, uw, 121);
+
+	/* Apply the spectral magnitude */
+	bl = ambe_band_edge(W0, 1);
+
+	for (i=0; i<bl; i++) {
+		Uwi[i] = 0;
+		Uwq[i] = 0;
+	}
+
+	for (l=0; l<sf->L; l++)
+	{
+		int64_t e, g;
+		uint32_t rms;
+
+		/* Edges */
+		al = bl;
+		bl = ambe_band_edge(W0, 2*l + 3);
+
+		if (bl <= al)
+			continue;
+
+		if (sf->Vl[l]) {
+			for (i=al; i<bl; i++) {
+				Uwi[i] = 0;
+				Uwq[i] = 0;
+			}
+			continue;
+		}
+
+		/* Compute factor: 76.89 * Ml / rms, as Q16 to get a Q4 result */
+		e = 0;
+
+		for (i=al; i<bl; i++)
+			e += (int64_t)Uwi[i] * Uwi[i] + (int64_t)Uwq[i] * Uwq[i];
+
+		rms = isqrt64(e / (bl - al));
+		g = rms ? ((((int64_t)sf->Ml[l] * 19684) >> 16) << 16) / rms : 0;
+
+		/* Set magnitude */
+		for (i=al; i<bl; i++) {
+			Uwi[i] = (int32_t)((Uwi[i] * g) >> 16);
+			Uwq[i] = (int32_t)((Uwq[i] * g) >> 16);
+		}
+	}
+
+	for (i=bl; i<=64; i++) {
+		Uwi[i] = 0;
+		Uwq[i] = 0;
+	}
+
+	/* Get time-domain samples via iDFT */
+	idft128_q(uw, Uwi, Uwq, 121);
+
+	/* Weighted Overlap And Add */
+	for (i=0; i<21; i++) {
+		suv[i] = synth->uw_prev[i + 60];
+	}
+
+	for (i=21; i<60; i++) {
+		suv[i] = (int32_t)(((int64_t)ola_w[i-21][0] * synth->uw_prev[i + 60] +
+		                    (int64_t)ola_w[i-21][1] * uw[i - 20]) >> 14);
+	}
+
+	for (i=60; i<80; i++) {
+		suv[i] = uw[i - 20];
+	}
+
+	memcpy(synth->uw_prev, uw, sizeof(int32_t) * 121);
+}
+
+/*! \brief Q8 contribution of a Q12 amplitude harmonic at a given phase */
+static inline int32_t
+vs_term(int32_t a, uint32_t p)
+{
+	return (int32_t)(((int64_t)a * cos_q15(p)) >> 19);
+}
+
+/*! \brief Perform voiced synthesis
+ *  \param[in] synth Synthesizer state structure
+ *  \param[out] sv Result buffer (80 samples, Q8)
+ *  \param[in] sf Expanded subframe data for current subframe
+ *  \param[in] sf_prev Expanded subframe data for prevous subframe
+ */
+static void
+ambe_synth_voiced(struct ambe_synth *synth, int32_t *sv,
+                  struct ambe_subframe *sf, struct ambe_subframe *sf_prev)
+{
+	uint32_t W0_cur  = sf->w0;
+	uint32_t W0_prev = sf_prev->w0;
+	int32_t s_cur[59], s_prev[60];
+	int i, l, L_max, L_uv;
+
+	/* Pre-clear */
+	memset(sv,     0x00, sizeof(int32_t) * 80);
+	memset(s_cur,  0x00, sizeof(s_cur));
+	memset(s_prev, 0x00, sizeof(s_prev));
+
+	/* How many subband to process */
+	L_max = sf_prev->L > sf->L ? sf_prev->L : sf->L;
+
+	/* psi update (wraps around 2*pi by itself) */
+	L_uv = 0;
+	for (l=0; l<L_max; l++)
+		L_uv += sf->Vl[l] ? 0 : 1;
+
+	synth->psi1 += (W0_cur + W0_prev) * 40;
+
+	/* Scan each band */
+	for (l=0; l<L_max; l++)
+	{
+		int      Vl_cur,  Vl_prev;
+		int32_t  Ml_cur,  Ml_prev;
+		uint32_t phi_cur, phi_prev;
+		uint32_t w_cur,   w_prev;
+		uint32_t p;
+		int fine;
+
+		/* Handle out-of-bound for Vl and Ml */
+		Vl_cur  = l >= sf->L      ? 0 : sf->Vl[l];
+		Vl_prev = l >= sf_prev->L ? 0 : sf_prev->Vl[l];
+
+		Ml_cur  = l >= sf->L      ? 0 : sf->Ml[l];
+		Ml_prev = l >= sf_prev->L ? 0 : sf_prev->Ml[l];
+
+		/* Phase and Angular speed */
+		w_cur   = (l+1) * W0_cur;
+		w_prev  = (l+1) * W0_prev;
+
+		phi_prev = synth->phi[l];
+		phi_cur  = synth->psi1 * (l+1);
+
+		if (l >= (sf->L / 4))
+			phi_cur += (int32_t)(((int64_t)rho_ang[l] * L_uv) / sf->L);
+
+		synth->phi[l] = phi_cur;
+
+		/* Actual synthesis */
+			/* Can we do a fine transistion ? (w < pi for l < 7) */
+		fine = Vl_cur && Vl_prev && (l < 7) &&
+		       (10 * llabs((int64_t)w_cur - (int64_t)w_prev) < (int64_t)w_cur);
+
+			/* Fine transition: phase phi_prev + (THa + THb * i) * i */
+		if (fine)
+		{
+			int32_t Ml_step = (Ml_cur - Ml_prev) / 80;
+			int32_t Dwl = (int32_t)(phi_cur - phi_prev - (w_cur + w_prev) * 40) / 80;
+			int32_t THa = (int32_t)w_prev + Dwl;
+			int32_t THb = ((int32_t)w_cur - (int32_t)w_prev) / 160;
+			uint32_t d = THa + THb;
+			int32_t a = Ml_prev;
+
+			p = phi_prev;
+
+			for (i=0; i<80; i++) {
+				sv[i] += vs_term(a, p);
+				a += Ml_step;
+				p += d;
+				d += 2 * THb;
+			}
+		}
+
+			/* Coarse transition: Current frame (if voiced) */
+		if (!fine && Vl_cur)
+		{
+			p = phi_cur - w_cur * 59;
+
+			for (i=0; i<59; i++, p+=w_cur)
+				s_cur[i] += vs_term(Ml_cur, p);
+		}
+
+			/* Coarse transition: Previous frame (if voiced) */
+		if (!fine && Vl_prev)
+		{
+			p = phi_prev;
+
+			for (i=0; i<60; i++, p+=w_prev)
+				s_prev[i] += vs_term(Ml_prev, p);
+		}
+	}
+
+	/* Still need to update phi for the rest of the bands */
+	for (l=L_max; l<56; l++)
+		synth->phi[l] = (synth->psi1 * (l+1)) +
+			(int32_t)(((int64_t)rho_ang[l] * L_uv) / sf->L);
+
+	/* Windows */
+	for (i=21; i<80; i++)
+		sv[i] += mul_q15(s_cur[i-21], ws_q15[i-20]);
+
+	for (i=0; i<60; i++)
+		sv[i] += mul_q15(s_prev[i], ws_q15[i+60]);
+}
+
+
+/*! \brief Initialized Synthesizer state
+ *  \param[out] synth The structure to reset
+ */
+void
+ambe_synth_init(struct ambe_synth *synth)
+{
+	memset(synth, 0x00, sizeof(struct ambe_synth));
+	synth->u_prev = 3147;
+}
+
+/*! \brief Apply the spectral magnitude enhancement on the subframe
+ *  \param[in] synth Synthesizer state structure
+ *  \param[in] sf Expanded subframe data for subframe to enhance
+ *
+ * The weights are computed from the magnitudes normalized by RM0, which
+ * keeps everything within range: with m = Ml^2 / RM0 and r = RM1 / RM0,
+ * w^4 = 0.96 * pi / w0 * m * (1 + r^2 - 2 * r * cos(w0 * l)) / (1 - r^2)
+ */
+void
+ambe_synth_enhance(struct ambe_synth *synth, struct ambe_subframe *sf)
+{
+	uint32_t W0 = sf->w0;
+	int32_t M[56];
+	int64_t sq[56];
+	int64_t rm0, rm1, r0, r, r2, den, C, gamma;
+	int l, s;
+
+	/* Compute RM0 and RM1 (Q16) */
+	rm0 = 0;
+	rm1 = 0;
+
+	for (l=0; l<sf->L; l++)
+	{
+		M[l]  = sf->Ml[l];
+		sq[l] = ((int64_t)M[l] * M[l]) >> 8;
+		rm0 += sq[l];
+		rm1 += (sq[l] >> 15) * cos_q15((l+1) * W0);
+	}
+
+	if (!rm0 || !W0)
+		goto done;
+
+	/* Normalize and pre compute some constants */
+	for (s=0; (rm0 >> s) >= (1LL << 31); s++);
+	r0 = rm0 >> s;
+
+	r   = ((rm1 >> s) * (1LL << 30)) / r0;		/* Q30 */
+	r2  = (r * r) >> 30;			/* Q30 */
+	den = ((1LL << 30) - r2) >> 14;		/* Q16 */
+	C   = 135107988821115LL / W0;		/* 0.96 * pi / w0, Q16 */
+
+	/* Apply to the amplitudes */
+	gamma = 0;
+
+	for (l=0; l<sf->L; l++)
+	{
+		int64_t w;
+
+		if ( (l+1)*8 <= sf->L ) {
+			w = 1 << 16;
+		} else {
+			int64_t m = ((sq[l] >> s) << 30) / r0;	/* Q30 */
+			int64_t num = ((1LL << 30) + r2 -
+				((r * cos_q15((l+1) * W0)) >> 14)) >> 14;	/* Q16 */
+			int64_t q = (m * C) >> 16;		/* Q30 */
+
+			if (den <= 0 || q * num / den >= (3LL << 30))
+				q = 3LL << 32;
+			else
+				q = (q * num / den) << 2;	/* Q32 */
+
+			w = isqrt64((uint64_t)isqrt64(q) << 16);	/* Q16 */
+
+			if (w > 78643)
+				w = 78643;
+			else if (w < 32768)
+				w = 32768;
+		}
+
+		M[l] = (int32_t)((M[l] * w) >> 16);
+
+		gamma += ((int64_t)M[l] * M[l]) >> 8;
+	}
+
+	/* Compute final gamma and apply it */
+	if (gamma >> s)
+		gamma = isqrt64((r0 << 30) / (gamma >> s));	/* Q15 */
+	else
+		gamma = 1 << 15;
+
+	for (l=0; l<sf->L; l++) {
+		int64_t m = (M[l] * gamma) >> 15;
+		sf->Ml[l] = m > AMBE_ML_MAX ? AMBE_ML_MAX : (int32_t)m;
+	}
+
+done:
+	/* Update SE (Q16) */
+	synth->SE = (19 * synth->SE + rm0) / 20;
+	if (synth->SE < (10000LL << 16))
+		synth->SE = 10000LL << 16;
+}
+
+/*! \brief Generate audio for a given subframe
+ *  \param[in] synth Synthesizer state structure
+ *  \param[out] audio Result buffer (80 samples)
+ *  \param[in] sf Expanded subframe data for current subframe
+ *  \param[in] sf_prev Expanded subframe data for prevous subframe
+ */
+void
+ambe_synth_audio(struct ambe_synth *synth, int16_t *audio,
+                 struct ambe_subframe *sf,
+                 struct ambe_subframe *sf_prev)
+{
+	int32_t suv[80], sv[80];
+	int i;
+
+	ambe_synth_unvoiced(synth, suv, sf);
+	ambe_synth_voiced(synth, sv, sf, sf_prev);
+
+	for (i=0; i<80; i++) {
+		int64_t v = ((int64_t)suv[i] * 16 + 2 * (int64_t)sv[i]) >> 6;
+		audio[i] = v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+	}
+}
+
+/*! @} */
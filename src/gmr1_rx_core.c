@@ -0,0 +1,1203 @@
+/* GMR-1 RX channel processing core */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <complex.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+
+#include <osmocom/core/bits.h>
+#include <osmocom/core/utils.h>
+#include <osmocom/core/gsmtap.h>
+#include <osmocom/core/gsmtap_util.h>
+
+#include <osmocom/dsp/cxvec.h>
+#include <osmocom/dsp/cxvec_math.h>
+
+#include <osmocom/gmr1/gsmtap.h>
+#include <osmocom/gmr1/l1/a5.h>
+#include <osmocom/gmr1/l1/a5_cache.h>
+#include <osmocom/gmr1/l1/bcch.h>
+#include <osmocom/gmr1/l1/ccch.h>
+#include <osmocom/gmr1/l1/facch3.h>
+#include <osmocom/gmr1/l1/facch9.h>
+#include <osmocom/gmr1/l1/interleave.h>
+#include <osmocom/gmr1/l1/tch3.h>
+#include <osmocom/gmr1/l1/tch9.h>
+#include <osmocom/gmr1/sdr/defs.h>
+#include <osmocom/gmr1/sdr/dkab.h>
+#include <osmocom/gmr1/sdr/fcch.h>
+#include <osmocom/gmr1/sdr/fft.h>
+#include <osmocom/gmr1/sdr/pi4cxpsk.h>
+#include <osmocom/gmr1/sdr/nb.h>
+
+#include "gmr1_rx_core.h"
+
+
+#define A5_LOOKAHEAD	64	/* Frames of cipher stream generated ahead */
+
+#define DBG(cd, ...) \
+	do { if ((cd)->debug) fprintf(stderr, __VA_ARGS__); } while (0)
+
+static struct gsmtap_inst *g_gti;
+static pthread_mutex_t g_gti_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const struct gmr1_fcch_burst *fcch_type = &gmr1_fcch_burst;
+
+
+/* Helpers ---------------------------------------------------------------- */
+
+static int
+win_map(struct osmo_cxvec *win, struct osmo_cxvec *src, int begin, int len)
+{
+	if ((begin + len) > src->len)
+		return -1;
+
+	osmo_cxvec_init_from_data(win, &src->data[begin], len);
+
+	return 0;
+}
+
+static int
+burst_map(struct osmo_cxvec *burst, struct chan_desc *cd,
+          const struct gmr1_pi4cxpsk_burst *burst_type, int tn, int win, int tch)
+{
+	int begin, len;
+	int etoa;
+	struct osmo_cxvec *df = tch == 2 ? cd->tch_csd : (tch ? cd->tch : cd->bcch);
+
+	if (!df)
+		return -EINVAL;
+
+	etoa  = win >> 1;
+	begin = cd->align + (cd->sps * tn * 39) - etoa;
+	len   = (burst_type->len * cd->sps) + win;
+
+	if ((begin < 0) || ((begin + len) > df->len))
+		return -EIO;
+
+	osmo_cxvec_init_from_data(burst, &df->data[begin], len);
+
+	return etoa;
+}
+
+/* Reentrant version of osmo_hexdump_nospc() */
+static char *
+hexstr(char *out, const uint8_t *data, int len)
+{
+	int i;
+
+	for (i=0; i<len; i++)
+		sprintf(&out[2*i], "%02x", data[i]);
+	out[2*len] = '\0';
+
+	return out;
+}
+
+static float
+burst_energy(struct osmo_cxvec *burst)
+{
+	int i;
+	float e = 0.0f;
+	int b = (burst->len >> 5); /* exclude the borders */
+	for (i=b; i<burst->len-b; i++)
+		e += osmo_normsqf(burst->data[i]);
+	e /= burst->len;
+	return e;
+}
+
+static int
+key_is_set(struct chan_desc *cd)
+{
+	static const uint8_t no_key[8] = { 0 };
+	return memcmp(cd->kc, no_key, 8) != 0;
+}
+
+static void
+ciph_stream(struct chan_desc *cd, uint32_t fn, int nbits, ubit_t *ciph)
+{
+	if (cd->a5_cache)
+		gmr1_a5_cache_get(cd->a5_cache, cd->kc, fn, 0, nbits, ciph, NULL);
+	else
+		gmr1_a5(1, cd->kc, fn, nbits, ciph, NULL);
+}
+
+static void
+ciph_stream_packed(struct chan_desc *cd, uint32_t fn, int nbits, pbit_t *ciph)
+{
+	ubit_t ubits[658];
+
+	if (cd->a5_cache) {
+		gmr1_a5_cache_get(cd->a5_cache, cd->kc, fn, 0, nbits, NULL, ciph);
+	} else {
+		gmr1_a5(1, cd->kc, fn, nbits, ubits, NULL);
+		osmo_ubit2pbit(ciph, ubits, nbits);
+	}
+}
+
+int
+demod_init(struct chan_desc *cd)
+{
+	/* Search windows must match the ones used with burst_map() */
+	cd->dm_bcch = gmr1_pi4cxpsk_demod_alloc(
+		&gmr1_bcch_burst, cd->sps, 20 * cd->sps);
+	cd->dm_ccch = gmr1_pi4cxpsk_demod_alloc(
+		&gmr1_dc6_burst, cd->sps, 10 * cd->sps);
+	cd->dm_tch3_facch = gmr1_pi4cxpsk_demod_alloc(
+		&gmr1_nt3_facch_burst, cd->sps, cd->sps + (cd->sps/2));
+	cd->dm_tch3_speech = gmr1_pi4cxpsk_demod_alloc(
+		&gmr1_nt3_speech_burst, cd->sps, cd->sps + (cd->sps/2));
+	cd->dm_tch9 = gmr1_pi4cxpsk_demod_alloc(
+		&gmr1_nt9_burst, cd->sps, cd->sps + (cd->sps/2));
+
+	if (!cd->dm_bcch || !cd->dm_ccch ||
+	    !cd->dm_tch3_facch || !cd->dm_tch3_speech || !cd->dm_tch9)
+		return -ENOMEM;
+
+	/* Cipher streams, sized for the longest user (TCH9). Only worth
+	 * caching (and generating ahead) when we have a key */
+	if (key_is_set(cd)) {
+		cd->a5_cache = gmr1_a5_cache_alloc(658, A5_LOOKAHEAD);
+		if (!cd->a5_cache)
+			return -ENOMEM;
+	}
+
+	return 0;
+}
+
+void
+demod_fini(struct chan_desc *cd)
+{
+	gmr1_a5_cache_release(cd->a5_cache);
+	gmr1_pi4cxpsk_demod_release(cd->dm_tch9);
+	gmr1_pi4cxpsk_demod_release(cd->dm_tch3_speech);
+	gmr1_pi4cxpsk_demod_release(cd->dm_tch3_facch);
+	gmr1_pi4cxpsk_demod_release(cd->dm_ccch);
+	gmr1_pi4cxpsk_demod_release(cd->dm_bcch);
+}
+
+/* GSMTap output ---------------------------------------------------------- */
+
+int
+rx_gsmtap_init(const char *host)
+{
+	g_gti = gsmtap_source_init(host, GSMTAP_UDP_PORT, 0);
+	if (!g_gti)
+		return -EIO;
+
+	gsmtap_source_add_sink(g_gti);
+
+	return 0;
+}
+
+/* Build and send a GSMTap message. Channels can be processed from several
+ * threads so this is serialized (msgb allocation isn't thread-safe) */
+static void
+rx_gsmtap_send(struct chan_desc *cd, uint8_t chan_type, uint32_t fn, uint8_t tn,
+               const uint8_t *l2, int len)
+{
+	struct gsmtap_hdr *gh;
+	struct msgb *msg;
+
+	if (!g_gti)
+		return;
+
+	pthread_mutex_lock(&g_gti_lock);
+
+	msg = gmr1_gsmtap_makemsg(chan_type, fn, tn, l2, len);
+	if (msg) {
+		gh = (struct gsmtap_hdr *) msg->data;
+		gh->arfcn = htons(cd->arfcn);
+
+		/* Avoid memory leaks */
+		if (gsmtap_sendmsg(g_gti, msg) < 0)
+			msgb_free(msg);
+	}
+
+	pthread_mutex_unlock(&g_gti_lock);
+}
+
+
+/* Message parsing -------------------------------------------------------- */
+
+static int
+bcch_tdma_align(struct chan_desc *cd, uint8_t *l2)
+{
+	int sa_sirfn_delay, sa_bcch_stn;
+	int superframe_num, multiframe_num, mffn_high_bit;
+	int fn;
+
+	/* Check if it's a SI1 */
+	if ((l2[0] & 0xf8) != 0x08)
+		return 0;
+
+	/* Check if it contains a Seg 2A bis */
+	if ((l2[9] & 0xfc) != 0x80)
+		return 0;
+
+	/* Retrieve SA_SIRFN_DELAY, SA_BCCH_STN,
+	 * Superframe number, Multiframe number, MFFN high bit */
+	sa_sirfn_delay =  (l2[10] >> 3) & 0x0f;
+	sa_bcch_stn    = ((l2[10] << 2) & 0x1c) | (l2[11] >> 6);
+
+	superframe_num = ((l2[11] & 0x3f) << 7) | (l2[12] >> 1);
+	multiframe_num = ((l2[12] & 0x01) << 1) | (l2[13] >> 7);
+	mffn_high_bit  = ((l2[13] & 0x40) >> 6);
+
+	/* Compute frame number */
+	fn = (superframe_num << 6) |
+	     (multiframe_num << 4) |
+	     (mffn_high_bit << 3) |
+	     ((2 + sa_sirfn_delay) & 7);
+
+	/* Fix SDR alignement */
+	cd->align += (cd->sa_bcch_stn - sa_bcch_stn) * 39 * cd->sps;
+
+	/* Align TDMA */
+	cd->fn = fn;
+	cd->sa_sirfn_delay = sa_sirfn_delay;
+	cd->sa_bcch_stn = sa_bcch_stn;
+
+	return 0;
+}
+
+static inline int
+ccch_is_imm_ass(const uint8_t *l2)
+{
+	return (l2[1] == 0x06) && (l2[2] == 0x3f);
+}
+
+static void
+ccch_imm_ass_parse(const uint8_t *l2, int *rx_tn, int *p)
+{
+	*p = (l2[8] & 0xfc) >> 2;
+	*rx_tn = ((l2[8] & 0x03) << 3) | (l2[9] >> 5);
+}
+
+static inline int
+facch3_is_ass_cmd_1(const uint8_t *l2)
+{
+	return (l2[3] == 0x06) && (l2[4] == 0x2e);
+}
+
+static void
+facch3_ass_cmd_1_parse(const uint8_t *l2, int *rx_tn)
+{
+	*rx_tn = ((l2[5] & 0x03) << 3) | (l2[6] >> 5);
+}
+
+
+/* TCH9 Procesing --------------------------------------------------------- */
+
+static void
+rx_tch9_init(struct chan_desc *cd, const uint8_t *ass_cmd)
+{
+	/* Activate */
+	cd->tch9_state.active = 1;
+
+	/* Extract TN */
+	facch3_ass_cmd_1_parse(ass_cmd, &cd->tch9_state.tn);
+
+	/* Init interleaver */
+	gmr1_interleaver_init(&cd->tch9_state.il, 3, 648);
+}
+
+static int
+rx_tch9(struct chan_desc *cd)
+{
+	struct osmo_cxvec _burst, *burst = &_burst;
+	int e_toa, rv, sync_id, crc, conv;
+	sbit_t ebits[662], bits_sacch[10], bits_status[4];
+	ubit_t ciph[658];
+	pbit_t pciph[83];
+	float toa;
+
+	/* Is TCH active at all ? */
+	if (!cd->tch9_state.active)
+		return 0;
+
+	/* Map potential burst */
+	e_toa = burst_map(burst, cd, &gmr1_nt9_burst,
+	                  cd->tch9_state.tn, cd->sps + (cd->sps/2), 2);
+	if (e_toa < 0)
+		return e_toa;
+
+	/* Demodulate burst */
+	rv = gmr1_pi4cxpsk_demod_ex(
+		cd->dm_tch9,
+		burst, -cd->freq_err,
+		ebits, &sync_id, &toa, NULL
+	);
+
+	DBG(cd, "[.]   %s\n", sync_id ? "TCH9" : "FACCH9");
+	DBG(cd, "toa=%.1f, sync_id=%d\n", toa, sync_id);
+
+	/* Process depending on type */
+	if (!sync_id) { /* FACCH9 */
+		uint8_t l2[38];
+
+		/* Decode */
+		ciph_stream(cd, cd->fn, 658, ciph);
+		crc = gmr1_facch9_decode(l2, bits_sacch, bits_status, ebits, ciph, &conv);
+		DBG(cd, "crc=%d, conv=%d\n", crc, conv);
+
+		/* Send to GSMTap if correct */
+		if (!crc)
+			rx_gsmtap_send(cd,
+				GSMTAP_GMR1_TCH9 | GSMTAP_GMR1_FACCH,
+				cd->fn, cd->tch9_state.tn, l2, 38);
+	} else { /* TCH9 */
+		uint8_t l2[60];
+		int i, s = 0;
+
+		for (i=0; i<662; i++)
+			s += ebits[i] < 0 ? -ebits[i] : ebits[i];
+		s /= 662;
+
+		/* Decode */
+		ciph_stream_packed(cd, cd->fn, 658, pciph);
+		gmr1_tch9_decode_pciph(l2, bits_sacch, bits_status, ebits, GMR1_TCH9_9k6, pciph, &cd->tch9_state.il, &conv);
+		DBG(cd, "fn=%d, conv9=%d, avg=%d\n", cd->fn, conv, s);
+
+		/* Forward to GSMTap (no CRC to validate :( ) */
+		rx_gsmtap_send(cd,
+			GSMTAP_GMR1_TCH9,
+			cd->fn, cd->tch9_state.tn, l2, 60);
+
+		/* Save to file */
+		if (cd->csd_out)
+			fwrite(l2, 60, 1, cd->csd_out);
+	}
+
+	/* Done */
+	return rv;
+
+}
+
+
+/* TCH3 Procesing --------------------------------------------------------- */
+
+static void
+rx_tch3_init(struct chan_desc *cd, const uint8_t *imm_ass, float ref_energy)
+{
+	/* Activate */
+	cd->tch3_state.active = 1;
+
+	/* Extract TN & DKAB position */
+	ccch_imm_ass_parse(imm_ass, &cd->tch3_state.tn, &cd->tch3_state.p);
+
+	/* Estimate energy threshold */
+	cd->tch3_state.energy_burst = ref_energy * 0.75f;
+	cd->tch3_state.energy_dkab  = cd->tch3_state.energy_burst / 8.0f; /* ~ 8 times less pwr */
+
+	cd->tch3_state.weak_cnt = 0;
+
+	/* Init FACCH state */
+	cd->tch3_state.sync_id = 0;
+	cd->tch3_state.burst_cnt = 0;
+	memset(cd->tch3_state.bi_fn, 0xff, sizeof(uint32_t) * 4);
+	memset(&cd->tch3_state.ebits, 0x00, sizeof(sbit_t) * 104 * 4);
+}
+
+static int
+_rx_tch3_dkab(struct chan_desc *cd, struct osmo_cxvec *burst)
+{
+	sbit_t ebits[8];
+	float toa;
+	int rv;
+
+	DBG(cd, "[.]   DKAB\n");
+
+	rv = gmr1_dkab_demod(burst, cd->sps, -cd->freq_err, cd->tch3_state.p, ebits, &toa);
+
+	DBG(cd, "toa=%f\n", toa);
+
+	return rv;
+}
+
+static void
+_rx_tch3_facch_ciph(struct chan_desc *cd, ubit_t *ciph)
+{
+	struct tch3_state *st = &cd->tch3_state;
+	int bi;
+
+	/* Missing bursts (no fn) have no energy, any stream will do */
+	for (bi=0; bi<4; bi++) {
+		if (st->facch_bi_fn[bi] == 0xffffffff)
+			memset(&ciph[96*bi], 0x00, 96);
+		else
+			ciph_stream(cd, st->facch_bi_fn[bi], 96, &ciph[96*bi]);
+	}
+}
+
+static void
+_rx_tch3_facch_flush(struct chan_desc *cd)
+{
+	struct tch3_state *st = &cd->tch3_state;
+
+	/* Hand the block over for decoding (see rx_frame / rx_frames) */
+	memcpy(st->facch_ebits, st->ebits, sizeof(sbit_t) * 104 * 4);
+	memcpy(st->facch_bi_fn, st->bi_fn, sizeof(uint32_t) * 4);
+	st->facch_pend = 1;
+
+	/* Clear state */
+	st->sync_id ^= 1;
+	st->burst_cnt = 0;
+	memset(st->bi_fn, 0xff, sizeof(uint32_t) * 4);
+	memset(st->ebits, 0x00, sizeof(sbit_t) * 104 * 4);
+}
+
+static void
+_rx_tch3_facch_decoded(struct chan_desc *cd, const uint8_t *l2, int crc)
+{
+	struct tch3_state *st = &cd->tch3_state;
+
+	st->facch_pend = 0;
+
+	/* Send to GSMTap if correct */
+	if (!crc)
+		rx_gsmtap_send(cd,
+			GSMTAP_GMR1_TCH3 | GSMTAP_GMR1_FACCH,
+			cd->fn-3, st->tn, l2, 10);
+
+	/* Parse for assignement */
+	if (!crc && facch3_is_ass_cmd_1(l2))
+	{
+		/* Follow if we have the data */
+		if (cd->tch_csd)
+			rx_tch9_init(cd, l2);
+		else
+			fprintf(stderr, "\n[!] TCH9 assigned, not followed (no TCH9 samples)\n");
+	}
+}
+
+static void
+rx_tch3_facch_decode(struct chan_desc *cd)
+{
+	struct tch3_state *st = &cd->tch3_state;
+	ubit_t _ciph[96*4], *ciph;
+	uint8_t l2[10];
+	ubit_t sbits[8*4];
+	int crc, conv;
+
+	if (!st->facch_pend)
+		return;
+
+	/* Cipher stream ? */
+	if (st->ciph) {
+		ciph = _ciph;
+		_rx_tch3_facch_ciph(cd, ciph);
+	} else
+		ciph = NULL;
+
+	/* Decode the burst */
+	crc = gmr1_facch3_decode(l2, sbits, st->facch_ebits, ciph, &conv);
+
+	DBG(cd, "crc=%d, conv=%d\n", crc, conv);
+
+	/* Retry with ciphering ? */
+	if (!st->ciph && crc) {
+		ciph = _ciph;
+		_rx_tch3_facch_ciph(cd, ciph);
+
+		crc = gmr1_facch3_decode(l2, sbits, st->facch_ebits, ciph, &conv);
+
+		DBG(cd, "crc=%d, conv=%d\n", crc, conv);
+
+		if (!crc)
+			st->ciph = 1;
+	}
+
+	_rx_tch3_facch_decoded(cd, l2, crc);
+}
+
+static int
+_rx_tch3_facch(struct chan_desc *cd, sbit_t *ebits, int sync_id, float toa)
+{
+	struct tch3_state *st = &cd->tch3_state;
+	int bi;
+
+	/* Burst index */
+	bi = cd->fn & 3;
+
+	/* Debug */
+	DBG(cd, "[.]   FACCH3 (bi=%d)\n", bi);
+
+	DBG(cd, "toa=%.1f, sync_id=%d\n", toa, sync_id);
+
+	/* Does this burst belong with previous ones ? */
+	if (sync_id != st->sync_id)
+		_rx_tch3_facch_flush(cd);
+
+	/* Store this burst */
+	memcpy(&st->ebits[104*bi], ebits, sizeof(sbit_t) * 104);
+	st->sync_id = sync_id;
+	st->bi_fn[bi] = cd->fn;
+	st->burst_cnt += 1;
+
+	/* Is it time to flush ? */
+	if (st->burst_cnt == 4)
+		_rx_tch3_facch_flush(cd);
+
+	return 0;
+}
+
+static int
+_rx_tch3_speech(struct chan_desc *cd, sbit_t *ebits, float toa)
+{
+	ubit_t sbits[4];
+	pbit_t _ciph[26], *ciph = NULL;
+	uint8_t frame0[10], frame1[10];
+	char hex[2*10+1];
+	int conv[2];
+
+	/* Debug */
+	DBG(cd, "[.]   TCH3\n");
+
+	/* Decode it */
+	if (cd->tch3_state.ciph) {
+		ciph = _ciph;
+		ciph_stream_packed(cd, cd->fn, 208, ciph);
+	}
+
+	gmr1_tch3_decode_pciph(frame0, frame1, sbits, ebits, ciph, 0, &conv[0], &conv[1]);
+
+	/* More debug */
+	DBG(cd, "toa=%.1f\n", toa);
+	DBG(cd, "conv=%3d,%3d\n", conv[0], conv[1]);
+	DBG(cd, "frame0=%s\n", hexstr(hex, frame0, 10));
+	DBG(cd, "frame1=%s\n", hexstr(hex, frame1, 10));
+
+	return 0;
+}
+
+static int
+rx_tch3(struct chan_desc *cd)
+{
+	struct gmr1_pi4cxpsk_demod_ctx *dm_types[] = {
+		cd->dm_tch3_facch,
+		cd->dm_tch3_speech,
+		NULL
+	};
+
+	struct osmo_cxvec _burst, *burst = &_burst;
+	sbit_t ebits[212];
+	int e_toa, rv, btid, sid;
+	float be, det, toa;
+
+	/* Is TCH active at all ? */
+	if (!cd->tch3_state.active)
+		return 0;
+
+	/* Map potential burst (use FACCH3 as reference) */
+	e_toa = burst_map(burst, cd, &gmr1_nt3_facch_burst,
+	                  cd->tch3_state.tn, cd->sps + (cd->sps/2), 1);
+	if (e_toa < 0)
+		return e_toa;
+
+	/* Burst energy (and check for DKAB) */
+	be = burst_energy(burst);
+
+	det = (cd->tch3_state.energy_dkab + cd->tch3_state.energy_burst) / 4.0f;
+
+	if (be < det) {
+		rv = _rx_tch3_dkab(cd, burst);
+
+		if (rv < 0)
+			return rv;
+		else if (rv == 1) {
+			if (cd->tch3_state.weak_cnt++ > 8) {
+				DBG(cd, "END @%d\n", cd->fn);
+				cd->tch3_state.active = 0;
+			}
+		} else {
+			cd->tch3_state.energy_dkab =
+				(0.1f * be) +
+				(0.9f * cd->tch3_state.energy_dkab);
+		}
+
+		return 0;
+	} else
+		cd->tch3_state.weak_cnt = 0;
+
+	cd->tch3_state.energy_burst =
+		(0.1f * be) +
+		(0.9f * cd->tch3_state.energy_burst);
+
+	/* Detect burst type and demodulate it */
+	rv = gmr1_pi4cxpsk_detect_demod(
+		dm_types, (float)e_toa,
+		burst, -cd->freq_err,
+		ebits, &btid, &sid, &toa, NULL
+	);
+	if (rv < 0)
+		return rv;
+
+	/* Delegate appropriately */
+	if (btid == 0)
+		rv = _rx_tch3_facch(cd, ebits, sid, toa);
+	else
+		rv = _rx_tch3_speech(cd, ebits, toa);
+
+	/* Done */
+	return rv;
+}
+
+
+/* Procesing -------------------------------------------------------------- */
+
+int
+fcch_single_init(struct chan_desc *cd)
+{
+	struct osmo_cxvec _win, *win = &_win;
+	int rv, toa;
+
+	/* FCCH rough detection in the first 330 ms */
+	rv = win_map(win, cd->bcch, cd->align, (330 * GMR1_SYM_RATE * cd->sps) / 1000);
+	if (rv) {
+		fprintf(stderr, "[!] Not enough samples\n");
+		return rv;
+	}
+
+	rv = gmr1_fcch_rough(fcch_type, win, cd->sps, 0.0f, &toa);
+	if (rv) {
+		fprintf(stderr, "[!] Error during FCCH rough acquisition (%d)\n", rv);
+		return rv;
+	}
+
+	cd->align += toa;
+
+	/* Fine FCCH detection*/
+	return fcch_fine_init(cd);
+}
+
+int
+fcch_fine_init(struct chan_desc *cd)
+{
+	struct osmo_cxvec _win, *win = &_win;
+	int rv, toa;
+
+	/* Fine FCCH detection around the current alignement */
+	rv = win_map(win, cd->bcch, cd->align, fcch_type->len * cd->sps);
+	if (rv) {
+		fprintf(stderr, "[!] Not enough samples\n");
+		return rv;
+	}
+
+	rv = gmr1_fcch_fine(fcch_type, win, cd->sps, 0.0f, &toa, &cd->freq_err);
+	if (rv) {
+		fprintf(stderr, "[!] Error during FCCH fine acquisition (%d)\n", rv);
+		return rv;
+	}
+
+	cd->align += toa;
+
+	/* Done */
+	return 0;
+}
+
+int
+fcch_multi_process(struct chan_desc *cd, fcch_multi_cb_t cb, void *data)
+{
+	struct osmo_cxvec _win, *win = &_win;
+	int base_align, mtoa[16];
+	int rv;
+
+	fprintf(stderr, "[+] FCCH multi acquisition\n");
+
+	/* Multi FCCH detection (need 650 ms of signals) */
+	base_align = cd->align - fcch_type->len * cd->sps;
+	if (base_align < 0)
+		base_align = 0;
+
+	rv = win_map(win, cd->bcch, base_align, (650 * GMR1_SYM_RATE * cd->sps) / 1000);
+	if (rv) {
+		fprintf(stderr, "[!] Not enough samples\n");
+		return rv;
+	}
+
+	rv = gmr1_fcch_rough_multi(fcch_type, win, cd->sps, -cd->freq_err, mtoa, 16);
+	if (rv < 0) {
+		fprintf(stderr, "[!] Error during FCCH rough mutli-acquisition (%d)\n", rv);
+		return rv;
+	}
+
+	return fcch_multi_check(cd, base_align, mtoa, rv, cb, data);
+}
+
+int
+fcch_multi_check(struct chan_desc *cd, int base_align, int *mtoa, int n_fcch,
+                 fcch_multi_cb_t cb, void *data)
+{
+	struct osmo_cxvec _win, *win = &_win;
+	int i, j, rv = 0;
+	float ref_snr, ref_freq_err;
+
+	/* Check each of them for validity (the first is the strongest) */
+	ref_snr = ref_freq_err = 0.0f;
+
+	for (i=0, j=0; i<n_fcch; i++) {
+		float freq_err, e_fcch, e_cich, snr;
+		int toa;
+
+		/* Perform fine acquisition */
+		win_map(win, cd->bcch, base_align + mtoa[i], fcch_type->len * cd->sps);
+
+		rv = gmr1_fcch_fine(fcch_type, win, cd->sps, -cd->freq_err, &toa, &freq_err);
+		if (rv) {
+			fprintf(stderr, "[!] Error during FCCH fine acquisition (%d)\n", rv);
+			return rv;
+		}
+
+		/* Compute SNR */
+		win_map(win, cd->bcch,
+			base_align + mtoa[i] + toa,
+			fcch_type->len * cd->sps
+		);
+
+		rv = gmr1_fcch_snr(fcch_type, win, cd->sps, -(cd->freq_err + freq_err), &snr);
+		if (rv) {
+			fprintf(stderr, "[!] Error during FCCH SNR estimation (%d)\n", rv);
+		}
+
+		/* Check against strongest */
+		if (i==0) {
+			/* This _is_ the reference */
+			ref_snr = snr;
+			ref_freq_err = freq_err;
+		} else {
+			/* Check if SNR is 'good enough' */
+			if (snr < 2.0f)
+				continue;
+
+			if (snr < (ref_snr / 6.0f))
+				continue;
+
+			/* Check if frequency error is not too "off" */
+			if (to_hz(fabs(ref_freq_err - freq_err)) > 500.0f)
+				continue;
+		}
+
+		/* Debug print */
+		fprintf(stderr, "[.]  Potential FCCH @%d (%.3f ms). [snr = %.1f dB, freq_err = %.1f Hz]\n",
+			base_align + mtoa[i] + toa,
+			to_ms(cd, base_align + mtoa[i] + toa),
+			to_db(snr),
+			to_hz(freq_err + cd->freq_err)
+		);
+
+		/* Save it */
+		mtoa[j++] = mtoa[i] + toa;
+	}
+
+	n_fcch = j;
+
+	/* Now process each survivor */
+	for (i=0; i<n_fcch; i++) {
+		struct chan_desc _cdl, *cdl = &_cdl;
+
+		memcpy(cdl, cd, sizeof(struct chan_desc));
+		cdl->align = base_align + mtoa[i];
+		cdl->bcch_energy = nan("inf");
+		cdl->bcch_fail = 0;
+
+		rv = cb(cdl, data);
+		if (rv)
+			break;
+	}
+
+	return rv;
+}
+
+/*! \brief Control channel burst, demodulated and waiting to be decoded */
+struct rx_ctl_burst {
+	sbit_t ebits[432];
+	uint8_t l2[24];
+	int crc;
+	int conv;
+	int e_toa;
+	float toa;
+	float freq_err;
+	float min_energy;
+};
+
+static int
+_rx_bcch_demod(struct chan_desc *cd, struct rx_ctl_burst *b, float *energy)
+{
+	struct osmo_cxvec _burst, *burst = &_burst;
+	int rv;
+
+	/* Debug */
+	DBG(cd, "[.]   BCCH\n");
+
+	/* Demodulate burst */
+	b->e_toa = burst_map(burst, cd, &gmr1_bcch_burst, cd->sa_bcch_stn, 20 * cd->sps, 0);
+	if (b->e_toa < 0)
+		return b->e_toa;
+
+	rv = gmr1_pi4cxpsk_demod_ex(
+		cd->dm_bcch,
+		burst, -cd->freq_err,
+		b->ebits, NULL, &b->toa, &b->freq_err
+	);
+
+	if (rv) {
+		cd->bcch_fail++;
+		return rv;
+	}
+
+	/* Measure energy as a reference */
+	if (energy)
+		*energy = burst_energy(burst);
+
+	return 0;
+}
+
+static void
+_rx_bcch_decoded(struct chan_desc *cd, struct rx_ctl_burst *b)
+{
+	DBG(cd, "crc=%d, conv=%d\n", b->crc, b->conv);
+
+	/* Keep track of lost BCCH */
+	cd->bcch_fail = b->crc ? (cd->bcch_fail + 1) : 0;
+
+	/* If burst turned out OK, use data to align channel */
+	if (!b->crc) {
+		/* SDR alignement */
+		cd->align += ((int)roundf(b->toa)) - b->e_toa;
+		cd->freq_err += b->freq_err;
+
+		/* Acquire TDMA alignement */
+		bcch_tdma_align(cd, b->l2);
+	}
+
+	/* Send to GSMTap if correct */
+	if (!b->crc)
+		rx_gsmtap_send(cd,
+			GSMTAP_GMR1_BCCH,
+			cd->fn, cd->sa_bcch_stn, b->l2, 24);
+}
+
+static int
+rx_bcch(struct chan_desc *cd, float *energy)
+{
+	struct rx_ctl_burst b;
+	int rv;
+
+	rv = _rx_bcch_demod(cd, &b, energy);
+	if (rv)
+		return rv;
+
+	/* Decode burst */
+	b.crc = gmr1_bcch_decode(b.l2, b.ebits, &b.conv);
+
+	_rx_bcch_decoded(cd, &b);
+
+	return 0;
+}
+
+/* Returns 0 if there is a burst to decode, 1 if not, negative on error */
+static int
+_rx_ccch_demod(struct chan_desc *cd, struct rx_ctl_burst *b, float min_energy)
+{
+	struct osmo_cxvec _burst, *burst = &_burst;
+	int rv;
+
+	/* Map potential burst */
+	b->e_toa = burst_map(burst, cd, &gmr1_dc6_burst, cd->sa_bcch_stn, 10 * cd->sps, 0);
+	if (b->e_toa < 0)
+		return b->e_toa;
+
+	/* Energy detection */
+	if (burst_energy(burst) < min_energy)
+		return 1; /* Nothing to do */
+
+	b->min_energy = min_energy;
+
+	/* Debug */
+	DBG(cd, "[.]   CCCH\n");
+
+	/* Demodulate burst */
+	rv = gmr1_pi4cxpsk_demod_ex(
+		cd->dm_ccch,
+		burst, -cd->freq_err,
+		b->ebits, NULL, NULL, NULL
+	);
+
+	return rv;
+}
+
+static void
+_rx_ccch_decoded(struct chan_desc *cd, struct rx_ctl_burst *b)
+{
+	DBG(cd, "crc=%d, conv=%d\n", b->crc, b->conv);
+
+	/* Check for IMM.ASS */
+	if (!b->crc) {
+		if (ccch_is_imm_ass(b->l2)) {
+			rx_tch3_init(cd, b->l2, b->min_energy);
+			fprintf(stderr, "\n[+] TCH3 assigned on TN %d\n", cd->tch3_state.tn);
+		}
+	}
+
+	/* Send to GSMTap if correct */
+	if (!b->crc)
+		rx_gsmtap_send(cd,
+			GSMTAP_GMR1_CCCH,
+			cd->fn, cd->sa_bcch_stn, b->l2, 24);
+}
+
+static int
+rx_ccch(struct chan_desc *cd, float min_energy)
+{
+	struct rx_ctl_burst b;
+	int rv;
+
+	rv = _rx_ccch_demod(cd, &b, min_energy);
+	if (rv)
+		return rv < 0 ? rv : 0;
+
+	/* Decode burst */
+	b.crc = gmr1_ccch_decode(b.l2, b.ebits, &b.conv);
+
+	_rx_ccch_decoded(cd, &b);
+
+	return 0;
+}
+
+void
+rx_frame(struct chan_desc *cd)
+{
+	int sirfn;
+
+	/* Debug */
+	DBG(cd, "[-]  FN: %6d (%10.3f ms)\n", cd->fn, to_ms(cd, cd->align));
+
+	/* SI relative frame number inside an hyperframe */
+	sirfn = (cd->fn - cd->sa_sirfn_delay) & 63;
+
+	/* BCCH */
+	if (sirfn % 8 == 2)
+		rx_bcch(cd, &cd->bcch_energy);
+
+	/* CCCH */
+	if ((sirfn % 8 != 0) && (sirfn % 8 != 2))
+		rx_ccch(cd, cd->bcch_energy / 2.0f);
+
+	/* TCH */
+	rx_tch3(cd);
+	rx_tch3_facch_decode(cd);
+	rx_tch9(cd);
+
+	/* Next frame */
+	cd->fn++;
+	cd->align += frame_len(cd);
+}
+
+static void
+_rx_ctl_decode_batch(struct chan_desc **cds, struct rx_ctl_burst **b, int n,
+                     int ccch)
+{
+	uint8_t *l2[RX_BATCH_MAX];
+	const sbit_t *ebits[RX_BATCH_MAX];
+	int crc[RX_BATCH_MAX], conv[RX_BATCH_MAX];
+	int i, rv;
+
+	if (!n)
+		return;
+
+	for (i=0; i<n; i++) {
+		l2[i] = b[i]->l2;
+		ebits[i] = b[i]->ebits;
+	}
+
+	if (ccch)
+		rv = gmr1_ccch_decode_batch(n, l2, ebits, crc, conv);
+	else
+		rv = gmr1_bcch_decode_batch(n, l2, ebits, crc, conv);
+
+	/* Can only fail on allocation, count those as lost */
+	if (rv) {
+		for (i=0; i<n; i++) {
+			crc[i] = -1;
+			conv[i] = 0;
+		}
+	}
+
+	for (i=0; i<n; i++) {
+		b[i]->crc = crc[i];
+		b[i]->conv = conv[i];
+		if (ccch)
+			_rx_ccch_decoded(cds[i], b[i]);
+		else
+			_rx_bcch_decoded(cds[i], b[i]);
+	}
+}
+
+static void
+_rx_facch3_decode_batch(struct chan_desc **cds, int n)
+{
+	uint8_t l2[RX_BATCH_MAX][10], *l2p[RX_BATCH_MAX];
+	ubit_t sbits[RX_BATCH_MAX][8*4], *sbitsp[RX_BATCH_MAX];
+	ubit_t ciph[RX_BATCH_MAX][96*4];
+	const sbit_t *ebitsp[RX_BATCH_MAX];
+	const ubit_t *ciphp[RX_BATCH_MAX];
+	struct chan_desc *rcds[RX_BATCH_MAX];
+	int crc[RX_BATCH_MAX], conv[RX_BATCH_MAX];
+	int idx[RX_BATCH_MAX], rcrc[RX_BATCH_MAX];
+	int i, m, rv;
+
+	if (!n)
+		return;
+
+	/* First try, ciphered only if we know it is */
+	for (i=0; i<n; i++) {
+		struct tch3_state *st = &cds[i]->tch3_state;
+
+		l2p[i] = l2[i];
+		sbitsp[i] = sbits[i];
+		ebitsp[i] = st->facch_ebits;
+		ciphp[i] = NULL;
+
+		if (st->ciph) {
+			_rx_tch3_facch_ciph(cds[i], ciph[i]);
+			ciphp[i] = ciph[i];
+		}
+	}
+
+	/* Can only fail on allocation, count those as lost */
+	rv = gmr1_facch3_decode_batch(n, l2p, sbitsp, ebitsp, ciphp, crc, conv);
+
+	/* Retry the failed ones with ciphering */
+	for (i=0, m=0; i<n; i++) {
+		if (rv) {
+			crc[i] = -1;
+			continue;
+		}
+
+		DBG(cds[i], "crc=%d, conv=%d\n", crc[i], conv[i]);
+
+		if (cds[i]->tch3_state.ciph || !crc[i])
+			continue;
+
+		_rx_tch3_facch_ciph(cds[i], ciph[i]);
+
+		idx[m]    = i;
+		rcds[m]   = cds[i];
+		l2p[m]    = l2[i];
+		sbitsp[m] = sbits[i];
+		ebitsp[m] = cds[i]->tch3_state.facch_ebits;
+		ciphp[m]  = ciph[i];
+		m++;
+	}
+
+	if (m && !gmr1_facch3_decode_batch(m, l2p, sbitsp, ebitsp, ciphp, rcrc, conv)) {
+		for (i=0; i<m; i++) {
+			DBG(rcds[i], "crc=%d, conv=%d\n", rcrc[i], conv[i]);
+
+			crc[idx[i]] = rcrc[i];
+
+			if (!rcrc[i])
+				rcds[i]->tch3_state.ciph = 1;
+		}
+	}
+
+	for (i=0; i<n; i++)
+		_rx_tch3_facch_decoded(cds[i], l2[i], crc[i]);
+}
+
+static void
+_rx_frames(struct chan_desc **cds, int n)
+{
+	struct rx_ctl_burst bursts[RX_BATCH_MAX];
+	struct rx_ctl_burst *bcch[RX_BATCH_MAX], *ccch[RX_BATCH_MAX];
+	struct chan_desc *bcch_cds[RX_BATCH_MAX], *ccch_cds[RX_BATCH_MAX];
+	struct chan_desc *facch_cds[RX_BATCH_MAX];
+	int i, n_bcch = 0, n_ccch = 0, n_facch = 0;
+
+	/* Demodulate the BCCH / CCCH bursts of every channel */
+	for (i=0; i<n; i++)
+	{
+		struct chan_desc *cd = cds[i];
+		int sirfn;
+
+		DBG(cd, "[-]  FN: %6d (%10.3f ms)\n", cd->fn, to_ms(cd, cd->align));
+
+		sirfn = (cd->fn - cd->sa_sirfn_delay) & 63;
+
+		if (sirfn % 8 == 2) {
+			if (!_rx_bcch_demod(cd, &bursts[i], &cd->bcch_energy)) {
+				bcch_cds[n_bcch] = cd;
+				bcch[n_bcch++] = &bursts[i];
+			}
+		}
+
+		if ((sirfn % 8 != 0) && (sirfn % 8 != 2)) {
+			if (!_rx_ccch_demod(cd, &bursts[i], cd->bcch_energy / 2.0f)) {
+				ccch_cds[n_ccch] = cd;
+				ccch[n_ccch++] = &bursts[i];
+			}
+		}
+	}
+
+	/* Decode them together */
+	_rx_ctl_decode_batch(bcch_cds, bcch, n_bcch, 0);
+	_rx_ctl_decode_batch(ccch_cds, ccch, n_ccch, 1);
+
+	/* TCH3, with the FACCH3 blocks completed in this frame decoded
+	 * together */
+	for (i=0; i<n; i++)
+		rx_tch3(cds[i]);
+
+	for (i=0; i<n; i++)
+		if (cds[i]->tch3_state.facch_pend)
+			facch_cds[n_facch++] = cds[i];
+
+	_rx_facch3_decode_batch(facch_cds, n_facch);
+
+	/* TCH9 and next frame */
+	for (i=0; i<n; i++) {
+		rx_tch9(cds[i]);
+
+		cds[i]->fn++;
+		cds[i]->align += frame_len(cds[i]);
+	}
+}
+
+/*! \brief Process the next frame of several channels
+ *  \param[in] cds Channels
+ *  \param[in] n Number of channels
+ *
+ * Same as \ref rx_frame on each channel, except the BCCH, CCCH and FACCH3
+ * bursts of all channels are decoded together with the batch channel
+ * decoders (which use another Viterbi metric than the single ones).
+ */
+void
+rx_frames(struct chan_desc **cds, int n)
+{
+	int i;
+
+	for (i=0; i<n; i+=RX_BATCH_MAX)
+		_rx_frames(&cds[i], (n - i) < RX_BATCH_MAX ? (n - i) : RX_BATCH_MAX);
+}
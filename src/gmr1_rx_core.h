@@ -0,0 +1,171 @@
+/* GMR-1 RX channel processing core */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GMR1_RX_CORE_H__
+#define __GMR1_RX_CORE_H__
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <osmocom/core/bits.h>
+#include <osmocom/dsp/cxvec.h>
+#include <osmocom/dsp/cxvec_math.h>
+
+#include <osmocom/gmr1/l1/interleave.h>
+#include <osmocom/gmr1/sdr/defs.h>
+
+
+#define START_DISCARD	8000
+#define RX_BATCH_MAX	16	/* Channels decoded together by rx_frames() */
+
+
+struct tch3_state {
+	/* Status */
+	int active;
+
+	/* Channel params */
+	int tn;
+	int p;
+	int ciph;
+
+	/* Energy */
+	float energy_dkab;
+	float energy_burst;
+
+	int weak_cnt;
+
+	/* FACCH state */
+	sbit_t ebits[104*4];
+	uint32_t bi_fn[4];
+	int sync_id;
+	int burst_cnt;
+
+	/* FACCH block complete, to be decoded before the next frame */
+	int facch_pend;
+	sbit_t facch_ebits[104*4];
+	uint32_t facch_bi_fn[4];
+};
+
+struct tch9_state {
+	/* Status */
+	int active;
+
+	/* Channel params */
+	int tn;
+
+	/* Interleaver */
+	struct gmr1_interleaver il;
+};
+
+struct chan_desc {
+	/* Sample source */
+	struct osmo_cxvec *bcch;
+	struct osmo_cxvec *tch;
+	struct osmo_cxvec *tch_csd;
+	int sps;
+	int arfcn;
+
+	/* SDR alignement */
+	int align;
+	float freq_err;
+
+	/* TDMA alignement */
+	int fn;
+	int sa_sirfn_delay;
+	int sa_bcch_stn;
+
+	/* BCCH */
+	float bcch_energy;
+	int bcch_fail;
+
+	/* TCH */
+	struct tch3_state tch3_state;
+	struct tch9_state tch9_state;
+
+	/* A5 */
+	uint8_t kc[8];
+	struct gmr1_a5_cache *a5_cache;
+
+	/* Demodulators */
+	struct gmr1_pi4cxpsk_demod_ctx *dm_bcch;
+	struct gmr1_pi4cxpsk_demod_ctx *dm_ccch;
+	struct gmr1_pi4cxpsk_demod_ctx *dm_tch3_facch;
+	struct gmr1_pi4cxpsk_demod_ctx *dm_tch3_speech;
+	struct gmr1_pi4cxpsk_demod_ctx *dm_tch9;
+
+	/* Debug */
+	int debug;		/* Dump every burst to stderr */
+	FILE *csd_out;		/* Decoded TCH9 data output (if any) */
+};
+
+
+/* Helpers */
+
+static inline float
+to_ms(struct chan_desc *cd, int s)
+{
+	return (1000.0f * (float)s) / (cd->sps * GMR1_SYM_RATE);
+}
+
+static inline float
+to_hz(float f_rps)
+{
+	return (GMR1_SYM_RATE * f_rps) / (2.0f * M_PIf);
+}
+
+static inline float
+to_db(float v)
+{
+	return 10.0f * log10f(v);
+}
+
+static inline int
+frame_len(struct chan_desc *cd)
+{
+	return cd->sps * 24 * 39;
+}
+
+
+/* GSMTap output */
+
+int rx_gsmtap_init(const char *host);
+
+
+/* Demodulators */
+
+int demod_init(struct chan_desc *cd);
+void demod_fini(struct chan_desc *cd);
+
+
+/* Processing */
+
+typedef int (*fcch_multi_cb_t)(struct chan_desc *cd, void *data);
+
+int fcch_single_init(struct chan_desc *cd);
+int fcch_fine_init(struct chan_desc *cd);
+int fcch_multi_process(struct chan_desc *cd, fcch_multi_cb_t cb, void *data);
+int fcch_multi_check(struct chan_desc *cd, int base_align, int *mtoa, int n_fcch,
+                     fcch_multi_cb_t cb, void *data);
+
+void rx_frame(struct chan_desc *cd);
+void rx_frames(struct chan_desc **cds, int n);
+
+
+#endif /* __GMR1_RX_CORE_H__ */
@@ -0,0 +1,688 @@
+/* GMR-1 Live multi-ARFCN RX application */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Each ARFCN is a stream of complex float samples (FIFO or file). A reader
+ * thread per ARFCN fills a bounded sample buffer (blocking when it's full)
+ * and a pool of worker threads runs the FCCH acquisition and then the
+ * frame by frame BCCH / CCCH / TCH processing of every FCCH found.
+ *
+ * Acquisition uses the streaming FCCH detector, so samples are consumed as
+ * they arrive and only the last couple of BCCH periods need to be kept
+ * around to validate what it reports.
+ *
+ * All the FCCH followed on an ARFCN advance frame by frame together, so the
+ * BCCH, CCCH and FACCH3 bursts of the same frame are decoded as a batch.
+ *
+ * Traffic channels are only partly followed. The ARFCN an assignment
+ * points to is not looked at, TCH3 is always demodulated from the ARFCN
+ * whose CCCH carried the IMM.ASS, so only TCH3 on that same carrier is
+ * decoded. TCH9 / CSD (FACCH3 ASS.CMD) is never followed. For those, use
+ * gmr1_rx with a capture of the assigned carrier.
+ *
+ * A given channel is only ever processed by one worker at a time, so all
+ * its processing state (demodulators, tracks) is owned by that worker. Only
+ * the sample buffer fill level is shared with the reader.
+ */
+
+#include <complex.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <osmocom/core/utils.h>
+
+#include <osmocom/dsp/cxvec.h>
+
+#include <osmocom/gmr1/sdr/fcch.h>
+#include <osmocom/gmr1/sdr/fft.h>
+
+#include "gmr1_rx_core.h"
+
+
+#define LIVE_READ_CHUNK		8192	/* Samples per read                  */
+#define LIVE_DEFAULT_BUF_MS	3000	/* Default per channel buffer        */
+#define LIVE_ACQ_FEED_MS	300	/* Max samples fed to the FCCH detector
+					   at once (< 1 BCCH period)         */
+#define LIVE_ACQ_KEEP_MS	750	/* Samples kept behind the detector  */
+#define LIVE_MAX_TRACKS		16	/* Max FCCH followed per ARFCN       */
+#define LIVE_BCCH_LOST		16	/* Lost BCCH before dropping a track */
+#define LIVE_GUARD_SYMS		256	/* Samples kept before oldest align  */
+
+
+enum live_state {
+	LIVE_ACQ,
+	LIVE_TRACK,
+	LIVE_DONE,
+};
+
+struct live_chan {
+	/* Source */
+	int arfcn;
+	const char *path;
+	int fd;
+	pthread_t reader;
+
+	/* Sample buffer (len / eof / queued protected by lock) */
+	pthread_mutex_t lock;
+	pthread_cond_t space;
+	float complex *data;
+	int cap;
+	int len;
+	int eof;
+	int queued;		/* In the work queue or being processed */
+	int64_t base;		/* Absolute position of data[0] */
+
+	/* Processing state (owned by the worker processing the channel) */
+	enum live_state state;
+	struct osmo_cxvec view;
+	struct chan_desc cd;
+	struct gmr1_fcch_stream *fcch;
+	int64_t fcch_base;	/* Absolute position of the detector start */
+	int fcch_fed;		/* Samples of data[] fed to the detector */
+	int64_t acq_toa[LIVE_MAX_TRACKS];
+	int acq_n;
+	struct chan_desc tracks[LIVE_MAX_TRACKS];
+	int n_tracks;
+
+	/* Work queue */
+	struct live_chan *next;
+};
+
+struct live_pool {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	struct live_chan *head;
+	struct live_chan *tail;
+	int active;		/* Channels not done yet */
+};
+
+static struct live_pool g_pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+
+/* Work queue ------------------------------------------------------------- */
+
+static void
+pool_push(struct live_chan *ch)
+{
+	pthread_mutex_lock(&g_pool.lock);
+
+	ch->next = NULL;
+	if (g_pool.tail)
+		g_pool.tail->next = ch;
+	else
+		g_pool.head = ch;
+	g_pool.tail = ch;
+
+	pthread_cond_signal(&g_pool.cond);
+	pthread_mutex_unlock(&g_pool.lock);
+}
+
+static struct live_chan *
+pool_pop(void)
+{
+	struct live_chan *ch;
+
+	pthread_mutex_lock(&g_pool.lock);
+
+	while (!g_pool.head && g_pool.active)
+		pthread_cond_wait(&g_pool.cond, &g_pool.lock);
+
+	ch = g_pool.head;
+	if (ch) {
+		g_pool.head = ch->next;
+		if (!g_pool.head)
+			g_pool.tail = NULL;
+	}
+
+	pthread_mutex_unlock(&g_pool.lock);
+
+	return ch;
+}
+
+static void
+pool_chan_done(void)
+{
+	pthread_mutex_lock(&g_pool.lock);
+	if (!--g_pool.active)
+		pthread_cond_broadcast(&g_pool.cond);
+	pthread_mutex_unlock(&g_pool.lock);
+}
+
+
+/* Reader ----------------------------------------------------------------- */
+
+static void
+chan_push(struct live_chan *ch, const float complex *samples, int n)
+{
+	pthread_mutex_lock(&ch->lock);
+
+	while ((ch->cap - ch->len) < n)
+		pthread_cond_wait(&ch->space, &ch->lock);
+
+	memcpy(&ch->data[ch->len], samples, n * sizeof(float complex));
+	ch->len += n;
+
+	if (!ch->queued) {
+		ch->queued = 1;
+		pool_push(ch);
+	}
+
+	pthread_mutex_unlock(&ch->lock);
+}
+
+static void *
+chan_reader(void *arg)
+{
+	struct live_chan *ch = arg;
+	float complex chunk[LIVE_READ_CHUNK];
+	uint8_t *buf = (uint8_t *)chunk;
+	size_t have = 0;
+
+	ch->fd = open(ch->path, O_RDONLY);
+	if (ch->fd < 0)
+		fprintf(stderr, "[!] ARFCN %d: Failed to open '%s'\n", ch->arfcn, ch->path);
+
+	while (ch->fd >= 0)
+	{
+		ssize_t rv;
+		int n;
+
+		rv = read(ch->fd, buf + have, sizeof(chunk) - have);
+		if (rv < 0 && errno == EINTR)
+			continue;
+		if (rv <= 0)
+			break;
+
+		have += rv;
+
+		/* Push complete samples, keep any partial one */
+		n = have / sizeof(float complex);
+		if (!n)
+			continue;
+
+		chan_push(ch, chunk, n);
+
+		have -= n * sizeof(float complex);
+		memmove(buf, buf + n * sizeof(float complex), have);
+	}
+
+	if (ch->fd >= 0)
+		close(ch->fd);
+
+	/* Signal the end of the stream */
+	pthread_mutex_lock(&ch->lock);
+	ch->eof = 1;
+	if (!ch->queued) {
+		ch->queued = 1;
+		pool_push(ch);
+	}
+	pthread_mutex_unlock(&ch->lock);
+
+	return NULL;
+}
+
+
+/* Processing ------------------------------------------------------------- */
+
+static int
+ms_to_samples(int sps, int ms)
+{
+	return (int)(((int64_t)ms * GMR1_SYM_RATE * sps) / 1000);
+}
+
+static int
+chan_add_track(struct chan_desc *cd, void *data)
+{
+	struct live_chan *ch = data;
+
+	if (ch->n_tracks >= LIVE_MAX_TRACKS)
+		return 0;
+
+	fprintf(stderr, "[+] ARFCN %d: Following FCCH @%lld. [freq_err = %.1f Hz]\n",
+		ch->arfcn, (long long)(ch->base + cd->align), to_hz(cd->freq_err));
+
+	memcpy(&ch->tracks[ch->n_tracks++], cd, sizeof(struct chan_desc));
+
+	return 0;
+}
+
+static void
+chan_fcch_cb(void *data, int64_t toa, float pwr)
+{
+	struct live_chan *ch = data;
+
+	if (ch->acq_n < LIVE_MAX_TRACKS)
+		ch->acq_toa[ch->acq_n++] = ch->fcch_base + toa;
+}
+
+static int
+chan_acquire_check(struct live_chan *ch)
+{
+	struct chan_desc *cd = &ch->cd;
+	int mtoa[LIVE_MAX_TRACKS];
+	int i, n, rv;
+
+	/* Detections are absolute, make them relative to the buffer */
+	for (i=0, n=0; i<ch->acq_n; i++) {
+		int64_t p = ch->acq_toa[i] - ch->base;
+		if (p >= 0)
+			mtoa[n++] = p;
+	}
+
+	ch->acq_n = 0;
+
+	if (!n)
+		return -ENOENT;
+
+	/* Primary FCCH (the strongest) for the frequency error */
+	cd->align = mtoa[0];
+	cd->freq_err = 0.0f;
+
+	rv = fcch_fine_init(cd);
+	if (rv)
+		return rv;
+
+	fprintf(stderr, "[+] ARFCN %d: Primary FCCH found @%lld. [freq_err = %.1f Hz]\n",
+		ch->arfcn, (long long)(ch->base + cd->align), to_hz(cd->freq_err));
+
+	/* Then all the visible ones */
+	rv = fcch_multi_check(cd, 0, mtoa, n, chan_add_track, ch);
+	if (rv)
+		return rv;
+
+	return ch->n_tracks ? 0 : -ENOENT;
+}
+
+static int
+chan_acquire(struct live_chan *ch)
+{
+	struct chan_desc *cd = &ch->cd;
+	struct osmo_cxvec blk;
+	int l;
+
+	/* Start the detector where the acquisition (re)starts */
+	if (!ch->fcch) {
+		ch->fcch = gmr1_fcch_stream_alloc(&gmr1_fcch_burst, cd->sps, 0.0f,
+			chan_fcch_cb, ch);
+		if (!ch->fcch) {
+			fprintf(stderr, "[!] ARFCN %d: Failed to allocate FCCH detector\n", ch->arfcn);
+			return 0;
+		}
+
+		ch->fcch_base = ch->base + cd->align;
+		ch->fcch_fed = cd->align;
+		ch->acq_n = 0;
+	}
+
+	/* Feed what's new, little enough that it covers at most one
+	 * detection window */
+	l = ch->view.len - ch->fcch_fed;
+	if (l <= 0)
+		return 0;
+
+	if (l > ms_to_samples(cd->sps, LIVE_ACQ_FEED_MS))
+		l = ms_to_samples(cd->sps, LIVE_ACQ_FEED_MS);
+
+	osmo_cxvec_init_from_data(&blk, &ch->view.data[ch->fcch_fed], l);
+	gmr1_fcch_stream_process(ch->fcch, &blk);
+	ch->fcch_fed += l;
+
+	/* Validate what was detected */
+	if (!ch->acq_n)
+		return 1;
+
+	if (chan_acquire_check(ch)) {
+		ch->n_tracks = 0;
+		cd->align = ch->fcch_fed;
+		return 1;
+	}
+
+	gmr1_fcch_stream_release(ch->fcch);
+	ch->fcch = NULL;
+
+	ch->state = LIVE_TRACK;
+
+	return 1;
+}
+
+static int
+chan_track(struct live_chan *ch)
+{
+	struct chan_desc *cds[LIVE_MAX_TRACKS];
+	int i, j, n, progress = 0;
+
+	/* Advance all the tracks frame by frame together, so their control
+	 * channel bursts get decoded in batches */
+	do {
+		for (i=0, n=0; i<ch->n_tracks; i++) {
+			struct chan_desc *cd = &ch->tracks[i];
+
+			if ((cd->bcch_fail <= LIVE_BCCH_LOST) &&
+			    ((cd->align + 2 * frame_len(cd)) <= ch->view.len))
+				cds[n++] = cd;
+		}
+
+		if (n) {
+			rx_frames(cds, n);
+			progress = 1;
+		}
+	} while (n);
+
+	/* Drop the tracks that lost the BCCH */
+	for (i=0, j=0; i<ch->n_tracks; i++) {
+		if (ch->tracks[i].bcch_fail > LIVE_BCCH_LOST) {
+			fprintf(stderr, "[!] ARFCN %d: Lost BCCH @%lld\n",
+				ch->arfcn, (long long)(ch->base + ch->tracks[i].align));
+			ch->cd.align = ch->tracks[i].align;
+			continue;
+		}
+		if (i != j)
+			memcpy(&ch->tracks[j], &ch->tracks[i], sizeof(struct chan_desc));
+		j++;
+	}
+
+	ch->n_tracks = j;
+
+	/* Nothing left to follow, acquire again */
+	if (!ch->n_tracks)
+		ch->state = LIVE_ACQ;
+
+	return progress;
+}
+
+static int
+chan_oldest(struct live_chan *ch)
+{
+	int i, align = ch->cd.align;
+
+	/* The detector reports FCCH up to about two periods late */
+	if (ch->fcch) {
+		align = ch->fcch_fed - ms_to_samples(ch->cd.sps, LIVE_ACQ_KEEP_MS);
+		if (align < 0)
+			align = 0;
+	}
+
+	if (ch->state == LIVE_TRACK)
+		for (i=0; i<ch->n_tracks; i++)
+			if (ch->tracks[i].align < align || !i)
+				align = ch->tracks[i].align;
+
+	return align;
+}
+
+static void
+chan_process(struct live_chan *ch)
+{
+	int avail, shift, more, progress = 0;
+	int i, eof, done = 0;
+
+	/* Snapshot of the available samples, the reader only appends */
+	pthread_mutex_lock(&ch->lock);
+	avail = ch->len;
+	eof = ch->eof;
+	pthread_mutex_unlock(&ch->lock);
+
+	osmo_cxvec_init_from_data(&ch->view, ch->data, avail);
+
+	/* Run as much as we can */
+	while (1) {
+		int p;
+
+		if (ch->state == LIVE_ACQ)
+			p = chan_acquire(ch);
+		else
+			p = chan_track(ch);
+
+		if (!p)
+			break;
+
+		progress = 1;
+	}
+
+	/* Discard what's not needed anymore */
+	shift = chan_oldest(ch) - LIVE_GUARD_SYMS * ch->cd.sps;
+	if (shift < 0)
+		shift = 0;
+	if (shift > avail)
+		shift = avail;
+
+	pthread_mutex_lock(&ch->lock);
+
+	if (shift) {
+		memmove(ch->data, &ch->data[shift], (ch->len - shift) * sizeof(float complex));
+		ch->len  -= shift;
+		ch->base += shift;
+
+		ch->cd.align -= shift;
+		ch->fcch_fed -= shift;
+		for (i=0; i<ch->n_tracks; i++)
+			ch->tracks[i].align -= shift;
+
+		pthread_cond_signal(&ch->space);
+	}
+
+	/* Reschedule if new samples arrived meanwhile or if the stream
+	 * ended and we might not be done with what's left */
+	more = (ch->len > (avail - shift)) || (ch->eof != eof) || (eof && progress);
+
+	if (more) {
+		pool_push(ch);
+	} else if (eof && !progress) {
+		ch->state = LIVE_DONE;
+		done = 1;
+	} else {
+		ch->queued = 0;
+	}
+
+	pthread_mutex_unlock(&ch->lock);
+
+	/* Once requeued, the channel belongs to another worker, so don't
+	 * look at it anymore */
+	if (done) {
+		fprintf(stderr, "[+] ARFCN %d: End of stream\n", ch->arfcn);
+		pool_chan_done();
+	}
+}
+
+static void *
+worker(void *arg)
+{
+	struct live_chan *ch;
+
+	while ((ch = pool_pop()) != NULL)
+		chan_process(ch);
+
+	return NULL;
+}
+
+
+/* Main ------------------------------------------------------------------- */
+
+static void
+usage(const char *argv0)
+{
+	fprintf(stderr, "Usage: %s [-j workers] [-b buffer_ms] [-k key] [-d] sps arfcn:file [arfcn:file ...]\n", argv0);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Each arfcn:file is followed on its own. A TCH3 assignment is only\n");
+	fprintf(stderr, "followed if the TCH3 is on the same carrier as the CCCH it was sent\n");
+	fprintf(stderr, "on (the assigned ARFCN is ignored), and TCH9 / CSD assignments are\n");
+	fprintf(stderr, "not followed at all. Use gmr1_rx with a capture of the assigned\n");
+	fprintf(stderr, "carrier for those.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct live_chan *chans = NULL;
+	pthread_t *workers = NULL;
+	uint8_t kc[8] = { 0 };
+	int n_chans, n_workers, buf_ms, sps, debug = 0;
+	int i, opt, rv = 0;
+
+	/* Options */
+	n_workers = sysconf(_SC_NPROCESSORS_ONLN);
+	buf_ms = LIVE_DEFAULT_BUF_MS;
+
+	while ((opt = getopt(argc, argv, "j:b:k:dh")) != -1) {
+		switch (opt) {
+		case 'j':
+			n_workers = atoi(optarg);
+			break;
+		case 'b':
+			buf_ms = atoi(optarg);
+			break;
+		case 'k':
+			if (osmo_hexparse(optarg, kc, 8) != 8) {
+				fprintf(stderr, "[!] Invalid key\n");
+				return -EINVAL;
+			}
+			break;
+		case 'd':
+			debug = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return -EINVAL;
+		}
+	}
+
+	if ((argc - optind) < 2) {
+		usage(argv[0]);
+		return -EINVAL;
+	}
+
+	sps = atoi(argv[optind++]);
+
+	if (sps < 1 || sps > 16) {
+		fprintf(stderr, "[!] sps must be within [1,16]\n");
+		return -EINVAL;
+	}
+
+	if (n_workers < 1)
+		n_workers = 1;
+
+	/* The buffer must at least hold what acquisition keeps around */
+	if (buf_ms < 2 * LIVE_ACQ_KEEP_MS)
+		buf_ms = 2 * LIVE_ACQ_KEEP_MS;
+
+	/* Channels */
+	n_chans = argc - optind;
+
+	chans = calloc(n_chans, sizeof(struct live_chan));
+	workers = calloc(n_workers, sizeof(pthread_t));
+	if (!chans || !workers) {
+		rv = -ENOMEM;
+		goto err;
+	}
+
+	/* Load FFTW wisdom (if any) before any planning */
+	if (gmr1_fft_wisdom_load(NULL) < 0)
+		fprintf(stderr, "[!] Failed to load FFTW wisdom from $%s\n", GMR1_FFT_WISDOM_ENV);
+
+	for (i=0; i<n_chans; i++)
+	{
+		struct live_chan *ch = &chans[i];
+		char *arg = argv[optind + i];
+		char *sep;
+
+		ch->arfcn = strtol(arg, &sep, 10);
+		if (sep == arg || *sep != ':' || !sep[1]) {
+			fprintf(stderr, "[!] Invalid channel '%s' (expected arfcn:file)\n", arg);
+			rv = -EINVAL;
+			goto err;
+		}
+		ch->path = sep + 1;
+		ch->fd = -1;
+
+		pthread_mutex_init(&ch->lock, NULL);
+		pthread_cond_init(&ch->space, NULL);
+
+		ch->cap = ms_to_samples(sps, buf_ms);
+		ch->data = malloc(ch->cap * sizeof(float complex));
+		if (!ch->data) {
+			rv = -ENOMEM;
+			goto err;
+		}
+
+		/* Channel description template. TCH3 is only looked for on
+		 * this same ARFCN, and without tch_csd TCH9 is never started
+		 * (see the limitations at the top of this file) */
+		ch->state = LIVE_ACQ;
+		ch->cd.sps = sps;
+		ch->cd.arfcn = ch->arfcn;
+		ch->cd.align = START_DISCARD;
+		ch->cd.bcch = &ch->view;
+		ch->cd.tch = &ch->view;
+		ch->cd.debug = debug;
+		memcpy(ch->cd.kc, kc, 8);
+
+		rv = demod_init(&ch->cd);
+		if (rv) {
+			fprintf(stderr, "[!] Failed to allocate demodulators\n");
+			goto err;
+		}
+	}
+
+	/* Init GSMTap */
+	rx_gsmtap_init("127.0.0.1");
+
+	/* Start everything */
+	g_pool.active = n_chans;
+
+	for (i=0; i<n_workers; i++)
+		pthread_create(&workers[i], NULL, worker, NULL);
+
+	for (i=0; i<n_chans; i++)
+		pthread_create(&chans[i].reader, NULL, chan_reader, &chans[i]);
+
+	/* Wait for all streams to end */
+	for (i=0; i<n_chans; i++)
+		pthread_join(chans[i].reader, NULL);
+
+	for (i=0; i<n_workers; i++)
+		pthread_join(workers[i], NULL);
+
+	/* Save FFTW wisdom for the next run */
+	if (gmr1_fft_wisdom_save(NULL) < 0)
+		fprintf(stderr, "[!] Failed to save FFTW wisdom to $%s\n", GMR1_FFT_WISDOM_ENV);
+
+	/* Done ! */
+	rv = 0;
+
+	/* Clean up */
+err:
+	for (i=0; chans && i<n_chans; i++) {
+		gmr1_fcch_stream_release(chans[i].fcch);
+		demod_fini(&chans[i].cd);
+		free(chans[i].data);
+	}
+
+	free(workers);
+	free(chans);
+
+	return rv;
+}
@@ -34,6 +34,7 @@
  *  \brief Osmocom GMR-1 A5 ciphering algorithm implementation
  */
 
+#include <pthread.h>
 #include <string.h>
 #include <stdint.h>
 
@@ -213,6 +214,28 @@ _a5_1_output(uint32_t *r)
 	return m[0] ^ m[1] ^ m[2];
 }
 
+/*! \brief GMR1-A5/1: Prepare the key mixed with the frame number
+ *  \param[out] lkey 8 byte array for the mixed key
+ *  \param[in] key 8 byte array for the key (as received from the SIM)
+ *  \param[in] fn Frame number
+ */
+static void
+_a5_1_lkey(uint8_t *lkey, const uint8_t *key, uint32_t fn)
+{
+	int i;
+
+	/* Reorganize the key */
+	for (i=0; i<8; i++)
+		lkey[i] = key[i ^ 1];
+
+	/* Mix-in frame number */
+	lkey[6] ^= (fn & 0x0000f) <<  4; /* MFFN */
+	lkey[3] ^= (fn & 0x00030) <<  2; /* MultiFrame Number */
+	lkey[1] ^= (fn & 0x007c0) >>  3; /* SuperFrame Number */
+	lkey[0] ^= (fn & 0x0f800) >> 11; /* ... */
+	lkey[0] ^= (fn & 0x70000) >> 11; /* ... */
+}
+
 /*! \brief Generate a GMR-1 A5/1 cipher stream
  *  \param[in] key 8 byte array for the key (as received from the SIM)
  *  \param[in] fn Frame number
@@ -229,16 +252,8 @@ gmr1_a5_1(uint8_t *key, uint32_t fn, int nbits, ubit_t *dl, ubit_t *ul)
 	uint8_t lkey[8];
 	int i;
 
-	/* Reorganize the key */
-	for (i=0; i<8; i++)
-		lkey[i] = key[i ^ 1];
-
 	/* Mix-in frame number */
-	lkey[6] ^= (fn & 0x0000f) <<  4; /* MFFN */
-	lkey[3] ^= (fn & 0x00030) <<  2; /* MultiFrame Number */
-	lkey[1] ^= (fn & 0x007c0) >>  3; /* SuperFrame Number */
-	lkey[0] ^= (fn & 0x0f800) >> 11; /* ... */
-	lkey[0] ^= (fn & 0x70000) >> 11; /* ... */
+	_a5_1_lkey(lkey, key, fn);
 
 	/* Init Rx */
 	r[0] = r[1] = r[2] = r[3] = 0;
@@ -281,4 +296,288 @@ gmr1_a5_1(uint8_t *key, uint32_t fn, int nbits, ubit_t *dl, ubit_t *ul)
 	}
 }
 
+
+/* Bitsliced A5/1 ----------------------------------------------------------
+ *
+ * Each register bit is held in a slice word whose bit l belongs to stream
+ * l, so one pass over the registers clocks A51_BATCH_W streams at once.
+ */
+
+#define A51_BATCH_W	256	/* Streams per bitsliced pass */
+#define A51_BATCH_MIN	16	/* Below that, scalar is faster */
+
+typedef uint64_t a51_slice_t __attribute__((vector_size(A51_BATCH_W / 8)));
+
+/* Shift the register by one where clk is set, inserting fb */
+#define A51_SHIFT(r, len, clk, fb) do {				\
+		int j_;						\
+		for (j_=(len)-1; j_>0; j_--)			\
+			r[j_] ^= (r[j_] ^ r[j_-1]) & (clk);	\
+		r[0] ^= (r[0] ^ (fb)) & (clk);			\
+	} while (0)
+
+/* Shift the register by one unconditionally, inserting fb */
+#define A51_SHIFT_FORCE(r, len, fb) do {			\
+		memmove(&r[1], &r[0], ((len)-1) * sizeof(a51_slice_t)); \
+		r[0] = (fb);					\
+	} while (0)
+
+#define A51_MAJ(a, b, c)	(((a) & (b)) | ((c) & ((a) | (b))))
+
+/*! \brief Transpose a 64x64 bit matrix in place
+ *  \param[in,out] a 64 words, bit j of a[i] moves to bit i of a[j]
+ */
+static void
+_a5_transpose64(uint64_t *a)
+{
+	uint64_t m, t;
+	int j, k;
+
+	for (j=32, m=0x00000000ffffffffULL; j; j>>=1, m^=m<<j)
+		for (k=0; k<64; k=((k|j)+1)&~j) {
+			t = ((a[k] >> j) ^ a[k|j]) & m;
+			a[k]   ^= t << j;
+			a[k|j] ^= t;
+		}
+}
+
+/* Byte to 8 ubits (LSB first) expansion table */
+static ubit_t g_a5_expand[256][8];
+
+/*! \brief Write back a block of bitsliced output to the per-stream arrays
+ *  \param[in] ob Output slices, one per generated bit
+ *  \param[in] cnt Number of slices in ob (1 to 64)
+ *  \param[out] out Array of nl output pointers (entries can be NULL)
+ *  \param[in] nl Number of streams
+ *  \param[in] ofs Bit offset of the block in the output
+ */
+static void
+_a5_1_batch_store(const a51_slice_t *ob, int cnt,
+                  ubit_t * const *out, int nl, int ofs)
+{
+	uint64_t m[64];
+	int w, l, t;
+
+	for (w=0; w<(nl+63)>>6; w++)
+	{
+		for (t=0; t<cnt; t++)
+			m[t] = ob[t][w];
+		for (; t<64; t++)
+			m[t] = 0;
+
+		_a5_transpose64(m);
+
+		for (l=0; l<64 && (w<<6)+l<nl; l++)
+		{
+			ubit_t *d = out[(w<<6)+l];
+
+			if (!d)
+				continue;
+
+			d += ofs;
+
+			for (t=0; t+8<=cnt; t+=8)
+				memcpy(&d[t], g_a5_expand[(m[l] >> t) & 0xff], 8);
+			for (; t<cnt; t++)
+				d[t] = (m[l] >> t) & 1;
+		}
+	}
+}
+
+/*! \brief GMR1-A5/1: Bitsliced generation of up to A51_BATCH_W streams
+ *  \param[in] lkey Per-stream mixed keys, first key bit as MSB
+ *  \param[in] nl Number of streams
+ *  \param[in] nbits How many bits to generate
+ *  \param[out] dl Array of nl DL cipher stream pointers (can be NULL)
+ *  \param[out] ul Array of nl UL cipher stream pointers (can be NULL)
+ *
+ * Always inlined in each of the per-ISA wrappers below.
+ */
+static inline __attribute__((always_inline)) void
+_a5_1_batch_core(const uint64_t *lkey, int nl, int nbits,
+                 ubit_t * const *dl, ubit_t * const *ul)
+{
+	a51_slice_t r1[A51_R1_LEN], r2[A51_R2_LEN], r3[A51_R3_LEN], r4[A51_R4_LEN];
+	a51_slice_t ks[64], ob[64];
+	int has_dl = 0, has_ul = 0;
+	int i, l, p, t;
+
+	/* Transpose the mixed keys into slices */
+	memset(ks, 0x00, sizeof(ks));
+
+	for (l=0; l<nl; l++) {
+		for (i=0; i<64; i++)
+			ks[i][l >> 6] |= ((lkey[l] >> (63 - i)) & 1) << (l & 63);
+
+		if (dl && dl[l])
+			has_dl = 1;
+		if (ul && ul[l])
+			has_ul = 1;
+	}
+
+	/* Key mixing */
+	memset(r1, 0x00, sizeof(r1));
+	memset(r2, 0x00, sizeof(r2));
+	memset(r3, 0x00, sizeof(r3));
+	memset(r4, 0x00, sizeof(r4));
+
+	for (i=0; i<64; i++)
+	{
+		a51_slice_t fb1, fb2, fb3, fb4;
+
+		fb1 = r1[13] ^ r1[16] ^ r1[17] ^ r1[18];
+		fb2 = r2[12] ^ r2[16] ^ r2[20] ^ r2[21];
+		fb3 = r3[17] ^ r3[18] ^ r3[21] ^ r3[22];
+		fb4 = r4[ 8] ^ r4[12] ^ r4[13] ^ r4[16];
+
+		A51_SHIFT_FORCE(r1, A51_R1_LEN, fb1 ^ ks[i]);
+		A51_SHIFT_FORCE(r2, A51_R2_LEN, fb2 ^ ks[i]);
+		A51_SHIFT_FORCE(r3, A51_R3_LEN, fb3 ^ ks[i]);
+		A51_SHIFT_FORCE(r4, A51_R4_LEN, fb4 ^ ks[i]);
+	}
+
+	/* Set high bits */
+	r1[0] = r2[0] = r3[0] = r4[0] = ~(a51_slice_t){ 0 };
+
+	/* Mixing, then DL and UL output */
+	for (p=0; p<3; p++)
+	{
+		ubit_t * const *out = p == 1 ? (has_dl ? dl : NULL) :
+		                      p == 2 ? (has_ul ? ul : NULL) : NULL;
+		int nc = p ? nbits : 250;
+
+		if (p == 2 && !has_ul)
+			break;
+
+		for (i=0; i<nc; i++)
+		{
+			a51_slice_t c0, c1, c2, m, fb1, fb2, fb3, fb4, o;
+
+			/* Clocking rule */
+			c0 = r4[15];
+			c1 = r4[6];
+			c2 = r4[1];
+			m = A51_MAJ(c0, c1, c2);
+
+			fb1 = r1[13] ^ r1[16] ^ r1[17] ^ r1[18];
+			fb2 = r2[12] ^ r2[16] ^ r2[20] ^ r2[21];
+			fb3 = r3[17] ^ r3[18] ^ r3[21] ^ r3[22];
+			fb4 = r4[ 8] ^ r4[12] ^ r4[13] ^ r4[16];
+
+			A51_SHIFT(r1, A51_R1_LEN, ~(c0 ^ m), fb1);
+			A51_SHIFT(r2, A51_R2_LEN, ~(c1 ^ m), fb2);
+			A51_SHIFT(r3, A51_R3_LEN, ~(c2 ^ m), fb3);
+			A51_SHIFT_FORCE(r4, A51_R4_LEN, fb4);
+
+			if (!out)
+				continue;
+
+			/* Output */
+			o = A51_MAJ(r1[1], r1[ 6], r1[15]) ^ r1[11] ^
+			    A51_MAJ(r2[3], r2[ 8], r2[14]) ^ r2[ 1] ^
+			    A51_MAJ(r3[4], r3[15], r3[19]) ^ r3[ 0];
+
+			t = i & 63;
+			ob[t] = o;
+
+			if ((t == 63) || (i == nc-1))
+				_a5_1_batch_store(ob, t+1, out, nl, i-t);
+		}
+	}
+}
+
+#undef A51_MAJ
+#undef A51_SHIFT_FORCE
+#undef A51_SHIFT
+
+typedef void (*a5_1_batch_fn_t)(const uint64_t *lkey, int nl, int nbits,
+                                ubit_t * const *dl, ubit_t * const *ul);
+
+static void
+_a5_1_batch_generic(const uint64_t *lkey, int nl, int nbits,
+                    ubit_t * const *dl, ubit_t * const *ul)
+{
+	_a5_1_batch_core(lkey, nl, nbits, dl, ul);
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_AVX2_KERNEL
+
+__attribute__((target("avx2")))
+static void
+_a5_1_batch_avx2(const uint64_t *lkey, int nl, int nbits,
+                 ubit_t * const *dl, ubit_t * const *ul)
+{
+	_a5_1_batch_core(lkey, nl, nbits, dl, ul);
+}
+#endif
+
+static a5_1_batch_fn_t g_a5_1_batch_fn = _a5_1_batch_generic;
+static pthread_once_t g_a5_1_once = PTHREAD_ONCE_INIT;
+
+/*! \brief Select the best bitsliced kernel for the running CPU */
+static void
+_a5_1_select(void)
+{
+	int i, j;
+
+	for (i=0; i<256; i++)
+		for (j=0; j<8; j++)
+			g_a5_expand[i][j] = (i >> j) & 1;
+
+#if defined(HAVE_AVX2_KERNEL)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		g_a5_1_batch_fn = _a5_1_batch_avx2;
+#endif
+}
+
+/*! \brief Generate a batch of GMR-1 A5/1 cipher streams
+ *  \param[in] n Number of streams to generate
+ *  \param[in] key Array of n 8 byte keys (as received from the SIM)
+ *  \param[in] fn Array of n frame numbers
+ *  \param[in] nbits How many bits to generate for each stream
+ *  \param[out] dl Array of n pointers to ubits for the Downlink streams
+ *  \param[out] ul Array of n pointers to ubits for the Uplink streams
+ *
+ * Produces the same output as calling \ref gmr1_a5_1 for each (key, fn)
+ * pair, but runs the streams bitsliced, 256 at a time.
+ * Either (or both) of dl/ul can be NULL if not needed, and so can any of
+ * their entries.
+ */
+void
+gmr1_a5_1_batch(int n, uint8_t * const *key, const uint32_t *fn, int nbits,
+                ubit_t * const *dl, ubit_t * const *ul)
+{
+	uint64_t lkey[A51_BATCH_W];
+	uint8_t k[8];
+	int i, j, b, nl;
+
+	/* Not worth it for a handful of streams */
+	if (n < A51_BATCH_MIN) {
+		for (i=0; i<n; i++)
+			gmr1_a5_1(key[i], fn[i], nbits,
+			          dl ? dl[i] : NULL, ul ? ul[i] : NULL);
+		return;
+	}
+
+	pthread_once(&g_a5_1_once, _a5_1_select);
+
+	for (b=0; b<n; b+=A51_BATCH_W)
+	{
+		nl = n - b;
+		if (nl > A51_BATCH_W)
+			nl = A51_BATCH_W;
+
+		for (i=0; i<nl; i++) {
+			_a5_1_lkey(k, key[b+i], fn[b+i]);
+			for (lkey[i]=0, j=0; j<8; j++)
+				lkey[i] = (lkey[i] << 8) | k[j];
+		}
+
+		g_a5_1_batch_fn(lkey, nl, nbits,
+		                dl ? &dl[b] : NULL, ul ? &ul[b] : NULL);
+	}
+}
+
 /*! @} */
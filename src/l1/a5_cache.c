@@ -0,0 +1,369 @@
+/* GMR-1 A5 cipher stream cache */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \addtogroup a5
+ *  @{
+ */
+
+/*! \file l1/a5_cache.c
+ *  \brief Osmocom GMR-1 A5 cipher stream cache implementation
+ *
+ * A traffic channel needs the A5/1 stream of every frame it decodes, and
+ * some of them more than once (FACCH retries). This keeps the streams of
+ * recent and upcoming frames around, keyed by (key, fn, direction), both
+ * as ubits and packed. With a lookahead, a background thread generates the frames following the
+ * most recent requested one (bitsliced, see \ref gmr1_a5_1_batch) so the
+ * decoding path normally only copies them. Requests for frames behind it
+ * (FACCH retries) don't move that window back.
+ *
+ * The DL stream of a frame doesn't depend on its length, so requests for
+ * fewer DL bits than the cache holds are served from the same entry.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <osmocom/core/bits.h>
+
+#include <osmocom/gmr1/l1/a5.h>
+#include <osmocom/gmr1/l1/a5_cache.h>
+
+
+#define A5_CACHE_HISTORY	16	/* Past frames kept (retries, FACCH) */
+
+/*! \brief Cached cipher stream of one (key, fn, direction) */
+struct a5_cache_slot {
+	int valid;
+	uint8_t key[8];
+	uint32_t fn;
+	int ul;
+	ubit_t *ubits;
+	pbit_t *pbits;
+};
+
+/*! \brief A5 cipher stream cache */
+struct gmr1_a5_cache {
+	int nbits;
+	int lookahead;
+
+	/* Direct mapped slots, indexed by (fn, direction) */
+	int n_slots;
+	struct a5_cache_slot *slots;
+	uint8_t *data;
+
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	/* Lookahead thread */
+	pthread_t thread;
+	int thread_running;
+	int stop;
+
+	int req_pending;
+	int req_valid;
+	uint8_t req_key[8];
+	uint32_t req_fn;
+	int req_ul;
+
+	uint8_t **w_key;
+	uint32_t *w_fn;
+	ubit_t **w_out;
+	ubit_t *w_bits;
+
+	/* Stream generated on a miss (lock held) */
+	ubit_t *miss_bits;
+};
+
+
+static inline struct a5_cache_slot *
+_a5_cache_slot(struct gmr1_a5_cache *c, uint32_t fn, int ul)
+{
+	return &c->slots[((fn << 1) | !!ul) & (c->n_slots - 1)];
+}
+
+static inline int
+_a5_cache_match(const struct a5_cache_slot *s,
+                const uint8_t *key, uint32_t fn, int ul)
+{
+	return s->valid && (s->fn == fn) && (s->ul == !!ul) &&
+	       !memcmp(s->key, key, 8);
+}
+
+/*! \brief Store a full length stream in its slot (lock held) */
+static void
+_a5_cache_fill(struct gmr1_a5_cache *c, const uint8_t *key, uint32_t fn,
+               int ul, const ubit_t *bits)
+{
+	struct a5_cache_slot *s = _a5_cache_slot(c, fn, ul);
+
+	memcpy(s->key, key, 8);
+	s->fn = fn;
+	s->ul = !!ul;
+	memcpy(s->ubits, bits, c->nbits);
+	osmo_ubit2pbit(s->pbits, bits, c->nbits);
+	s->valid = 1;
+}
+
+/*! \brief Copy the first nbits of a slot to the user buffers */
+static void
+_a5_cache_copy(const struct a5_cache_slot *s, int nbits,
+               ubit_t *ubits, pbit_t *pbits)
+{
+	int nbytes = (nbits + 7) >> 3;
+
+	if (ubits)
+		memcpy(ubits, s->ubits, nbits);
+
+	if (pbits) {
+		memcpy(pbits, s->pbits, nbytes);
+		if (nbits & 7)
+			pbits[nbytes-1] &= 0xff << (8 - (nbits & 7));
+	}
+}
+
+/*! \brief Whether a request should move the lookahead window (lock held)
+ *
+ * Only requests ahead of the current window start move it, or ones that
+ * are far away from it (resync, fn wrap) or for another stream.
+ */
+static int
+_a5_cache_moves(struct gmr1_a5_cache *c, const uint8_t *key, uint32_t fn, int ul)
+{
+	int32_t d = (int32_t)(fn - c->req_fn);
+
+	if (!c->req_valid || (c->req_ul != !!ul) || memcmp(c->req_key, key, 8))
+		return 1;
+
+	return (d > 0) || (d < -(c->n_slots / 2));
+}
+
+static void *
+_a5_cache_thread(void *arg)
+{
+	struct gmr1_a5_cache *c = arg;
+	uint8_t key[8];
+	uint32_t fn;
+	int ul, i, n;
+
+	pthread_mutex_lock(&c->lock);
+
+	while (!c->stop)
+	{
+		if (!c->req_pending) {
+			pthread_cond_wait(&c->cond, &c->lock);
+			continue;
+		}
+
+		memcpy(key, c->req_key, 8);
+		fn = c->req_fn;
+		ul = c->req_ul;
+		c->req_pending = 0;
+
+		/* Frames of the window that are not there yet */
+		for (i=1, n=0; i<=c->lookahead; i++)
+			if (!_a5_cache_match(_a5_cache_slot(c, fn+i, ul), key, fn+i, ul))
+				c->w_fn[n++] = fn + i;
+
+		/* Refill by large chunks (bitsliced generation) unless the
+		 * very next frame is missing */
+		if (!n || ((n < (c->lookahead + 1) / 2) && (c->w_fn[0] != fn + 1)))
+			continue;
+
+		/* Generate them all at once, without the lock */
+		pthread_mutex_unlock(&c->lock);
+
+		for (i=0; i<n; i++)
+			c->w_key[i] = key;
+
+		gmr1_a5_1_batch(n, c->w_key, c->w_fn, c->nbits,
+		                ul ? NULL : c->w_out, ul ? c->w_out : NULL);
+
+		pthread_mutex_lock(&c->lock);
+
+		for (i=0; i<n; i++)
+			_a5_cache_fill(c, key, c->w_fn[i], ul, c->w_out[i]);
+	}
+
+	pthread_mutex_unlock(&c->lock);
+
+	return NULL;
+}
+
+
+/*! \brief Allocate an A5/1 cipher stream cache
+ *  \param[in] nbits Length of the cached streams
+ *  \param[in] lookahead Number of frames to generate in advance (0 = none)
+ *  \return Cache, NULL on error
+ *
+ * With a non zero lookahead, a background thread is started and the next
+ * lookahead frames after each requested one are generated ahead of time.
+ */
+struct gmr1_a5_cache *
+gmr1_a5_cache_alloc(int nbits, int lookahead)
+{
+	struct gmr1_a5_cache *c;
+	int i, nbytes;
+
+	if ((nbits <= 0) || (lookahead < 0))
+		return NULL;
+
+	c = calloc(1, sizeof(struct gmr1_a5_cache));
+	if (!c)
+		return NULL;
+
+	pthread_mutex_init(&c->lock, NULL);
+	pthread_cond_init(&c->cond, NULL);
+
+	c->nbits = nbits;
+	c->lookahead = lookahead;
+
+	/* Slots, with room for the history and window of both directions */
+	nbytes = (nbits + 7) >> 3;
+
+	for (c->n_slots=1; c->n_slots < 2*(lookahead + A5_CACHE_HISTORY); c->n_slots<<=1);
+
+	c->slots = calloc(c->n_slots, sizeof(struct a5_cache_slot));
+	c->data  = malloc(c->n_slots * (nbits + nbytes));
+	c->miss_bits = malloc(nbits);
+	if (!c->slots || !c->data || !c->miss_bits)
+		goto err;
+
+	for (i=0; i<c->n_slots; i++) {
+		c->slots[i].ubits = c->data + i * (nbits + nbytes);
+		c->slots[i].pbits = c->slots[i].ubits + nbits;
+	}
+
+	/* Lookahead */
+	if (!lookahead)
+		return c;
+
+	c->w_key  = malloc(lookahead * sizeof(uint8_t *));
+	c->w_fn   = malloc(lookahead * sizeof(uint32_t));
+	c->w_out  = malloc(lookahead * sizeof(ubit_t *));
+	c->w_bits = malloc(lookahead * nbits);
+	if (!c->w_key || !c->w_fn || !c->w_out || !c->w_bits)
+		goto err;
+
+	for (i=0; i<lookahead; i++)
+		c->w_out[i] = c->w_bits + i * nbits;
+
+	if (pthread_create(&c->thread, NULL, _a5_cache_thread, c))
+		goto err;
+
+	c->thread_running = 1;
+
+	return c;
+
+err:
+	gmr1_a5_cache_release(c);
+	return NULL;
+}
+
+/*! \brief Release a cache created by \ref gmr1_a5_cache_alloc
+ *  \param[in] c The cache to release
+ */
+void
+gmr1_a5_cache_release(struct gmr1_a5_cache *c)
+{
+	if (!c)
+		return;
+
+	if (c->thread_running) {
+		pthread_mutex_lock(&c->lock);
+		c->stop = 1;
+		pthread_cond_signal(&c->cond);
+		pthread_mutex_unlock(&c->lock);
+
+		pthread_join(c->thread, NULL);
+	}
+
+	free(c->w_bits);
+	free(c->w_out);
+	free(c->w_fn);
+	free(c->w_key);
+
+	free(c->miss_bits);
+	free(c->data);
+	free(c->slots);
+
+	pthread_cond_destroy(&c->cond);
+	pthread_mutex_destroy(&c->lock);
+
+	free(c);
+}
+
+/*! \brief Get a GMR-1 A5/1 cipher stream through the cache
+ *  \param[in] c Cache
+ *  \param[in] key 8 byte array for the key (as received from the SIM)
+ *  \param[in] fn Frame number
+ *  \param[in] ul 0 for the Downlink stream, 1 for the Uplink one
+ *  \param[in] nbits How many bits to get
+ *  \param[out] ubits Array of nbits ubits for the stream (can be NULL)
+ *  \param[out] pbits Packed stream, MSB first, (nbits+7)/8 bytes (can be NULL)
+ *  \return 0 on success, -EINVAL on error.
+ *
+ * Output is the same as \ref gmr1_a5_1 for nbits. For the Downlink, nbits
+ * can be anything up to the cache stream length, but since the Uplink
+ * stream starts after the Downlink one, it must match it exactly.
+ * Safe to call from several threads. A miss generates the stream right
+ * away, in a buffer of the cache, so this never allocates.
+ */
+int
+gmr1_a5_cache_get(struct gmr1_a5_cache *c, const uint8_t *key, uint32_t fn,
+                  int ul, int nbits, ubit_t *ubits, pbit_t *pbits)
+{
+	struct a5_cache_slot *s;
+	uint8_t lkey[8];
+
+	if ((nbits < 0) || (nbits > c->nbits) || (ul && (nbits != c->nbits)))
+		return -EINVAL;
+
+	pthread_mutex_lock(&c->lock);
+
+	s = _a5_cache_slot(c, fn, ul);
+
+	/* Miss, generate the full stream now */
+	if (!_a5_cache_match(s, key, fn, ul)) {
+		memcpy(lkey, key, 8);
+		gmr1_a5_1(lkey, fn, c->nbits,
+		          ul ? NULL : c->miss_bits, ul ? c->miss_bits : NULL);
+		_a5_cache_fill(c, key, fn, ul, c->miss_bits);
+	}
+
+	_a5_cache_copy(s, nbits, ubits, pbits);
+
+	/* Move the lookahead window */
+	if (c->thread_running && _a5_cache_moves(c, key, fn, ul)) {
+		memcpy(c->req_key, key, 8);
+		c->req_fn = fn;
+		c->req_ul = !!ul;
+		c->req_valid = 1;
+		c->req_pending = 1;
+		pthread_cond_signal(&c->cond);
+	}
+
+	pthread_mutex_unlock(&c->lock);
+
+	return 0;
+}
+
+/*! @} */
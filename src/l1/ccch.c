@@ -26,28 +26,22 @@
  *  \brief Osmocom GMR-1 CCCH (PCH/AGCH) channel coding implementation
  */
 
+#include <errno.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <osmocom/core/bits.h>
 #include <osmocom/core/conv.h>
-#include <osmocom/core/crc16gen.h>
 
 #include <osmocom/gmr1/l1/conv.h>
 #include <osmocom/gmr1/l1/crc.h>
 #include <osmocom/gmr1/l1/interleave.h>
+#include <osmocom/gmr1/l1/rxmap.h>
 #include <osmocom/gmr1/l1/scramb.h>
 
-
-static struct osmo_conv_code gmr1_conv_ccch;
-
-static void __attribute__ ((constructor))
-gmr1_ccch_init(void)
-{
-	/* Init convolutional coder */
-	memcpy(&gmr1_conv_ccch, &gmr1_conv_k5_12, sizeof(struct osmo_conv_code));
-	gmr1_conv_ccch.len = 208;
-}
+#include "private.h"
 
 
 /*! \brief Stateless GMR-1 CCCH channel coder
@@ -69,12 +63,44 @@ gmr1_ccch_encode(ubit_t *bits_e, const uint8_t *l2)
 		bits_ep[i] = bits_ep[431-i] = 0;
 
 	osmo_pbit2ubit_ext(bits_u, 0, l2, 0, 192, 1);
-	osmo_crc16gen_set_bits(&gmr1_crc16, bits_u, 192, bits_u+192);
+	gmr1_crc_set_pbits(&gmr1_crc16_table, l2, 0, 192, bits_u+192);
 	osmo_conv_encode(&gmr1_conv_ccch, bits_u, bits_c);
 	gmr1_interleave_intra(&bits_ep[4], bits_c, 53);
 	gmr1_scramble_ubit(bits_e, bits_ep, 432);
 }
 
+/* e -> c : unscrambling + de-interleaving (first 4 bits unused) */
+static struct gmr1_rxmap gmr1_ccch_rxmap[424];
+static pthread_once_t gmr1_ccch_rxmap_once = PTHREAD_ONCE_INIT;
+
+static void
+_ccch_rxmap_init(void)
+{
+	struct gmr1_rxmap map_ep[424];
+
+	gmr1_rxmap_segment(map_ep, 4, 4, 4, 424);
+	gmr1_rxmap_intra(gmr1_ccch_rxmap, map_ep, 53);
+}
+
+static void
+_ccch_decode_pre(sbit_t *bits_c, const sbit_t *bits_e)
+{
+	pthread_once(&gmr1_ccch_rxmap_once, _ccch_rxmap_init);
+	gmr1_rxmap_apply(bits_c, bits_e, NULL, gmr1_ccch_rxmap, 424);
+}
+
+static int
+_ccch_decode_post(uint8_t *l2, const ubit_t *bits_u)
+{
+	int rv;
+
+	osmo_ubit2pbit_ext(l2, 0, bits_u, 0, 192, 1);
+
+	rv = gmr1_crc_check_pbits(&gmr1_crc16_table, l2, 0, 192, bits_u+192);
+
+	return rv;
+}
+
 /*! \brief Stateless GMR-1 CCCH channel decoder
  *  \param[out] l2 L2 packet data
  *  \param[in] bits_e Data bits of a burst
@@ -87,21 +113,70 @@ gmr1_ccch_encode(ubit_t *bits_e, const uint8_t *l2)
 int
 gmr1_ccch_decode(uint8_t *l2, const sbit_t *bits_e, int *conv_rv)
 {
-	sbit_t bits_ep[432];
 	sbit_t bits_c[428];
 	ubit_t bits_u[208];
 	int rv;
 
-	gmr1_scramble_sbit(bits_ep, bits_e, 432);
-	gmr1_deinterleave_intra(bits_c, &bits_ep[4], 53);
+	_ccch_decode_pre(bits_c, bits_e);
 
-	rv = osmo_conv_decode(&gmr1_conv_ccch, bits_c, bits_u);
+	rv = gmr1_conv_decode(&gmr1_conv_ccch, bits_c, bits_u);
 	if (conv_rv)
 		*conv_rv = rv;
 
-	rv = osmo_crc16gen_check_bits(&gmr1_crc16, bits_u, 192, bits_u+192);
+	return _ccch_decode_post(l2, bits_u);
+}
 
-	osmo_ubit2pbit_ext(l2, 0, bits_u, 0, 192, 1);
+/*! \brief Stateless GMR-1 CCCH channel decoder for a batch of bursts
+ *  \param[in] n Number of bursts to decode
+ *  \param[out] l2 Array of n L2 packet data buffers
+ *  \param[in] bits_e Array of n data bits of a burst
+ *  \param[out] crc_rv Array of n CRC check results, 0 if pass
+ *  \param[out] conv_rv Array of n convolutional decode returns (can be NULL)
+ *  \return 0 on success, -ENOMEM if the work buffers can't be allocated.
+ *
+ * Same as \ref gmr1_ccch_decode for each burst, but all the bursts go
+ * through a single \ref gmr1_conv_decode_batch call so the Viterbi runs
+ * several frames in parallel. That Viterbi uses libosmocore's generic
+ * metric, so conv_rv and, on very noisy bursts, the decoded data can differ
+ * from the ones of \ref gmr1_ccch_decode.
+ */
+int
+gmr1_ccch_decode_batch(int n, uint8_t * const *l2, const sbit_t * const *bits_e,
+                       int *crc_rv, int *conv_rv)
+{
+	const sbit_t **in;
+	ubit_t **out;
+	sbit_t *bits_c;
+	ubit_t *bits_u;
+	int i, rv;
+
+	if (n <= 0)
+		return 0;
+
+	in = malloc(n * (sizeof(sbit_t *) + sizeof(ubit_t *) +
+	                 428 * sizeof(sbit_t) + 208 * sizeof(ubit_t)));
+	if (!in)
+		return -ENOMEM;
+
+	out    = (ubit_t **) &in[n];
+	bits_c = (sbit_t *) &out[n];
+	bits_u = (ubit_t *) &bits_c[n * 428];
+
+	for (i=0; i<n; i++) {
+		in[i]  = &bits_c[i * 428];
+		out[i] = &bits_u[i * 208];
+		_ccch_decode_pre(&bits_c[i * 428], bits_e[i]);
+	}
+
+	rv = gmr1_conv_decode_batch(&gmr1_conv_ccch, n, in, out, conv_rv);
+	if (rv)
+		goto err;
+
+	for (i=0; i<n; i++)
+		crc_rv[i] = _ccch_decode_post(l2[i], out[i]);
+
+err:
+	free(in);
 
 	return rv;
 }
@@ -0,0 +1,1319 @@
+/* GMR-1 convolutional decoding */
+/* See GMR-1 05.003 (ETSI TS 101 376-5-3 V3.3.1) - Section 4.4 */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \addtogroup conv
+ *  @{
+ */
+
+/*! \file l1/conv_dec.c
+ *  \brief Osmocom GMR-1 specialized Viterbi decoder
+ *
+ * This is a drop-in replacement for osmo_conv_decode() that returns the
+ * exact same output bits and error metric as libosmocore's generic Viterbi
+ * decoder, but runs the add-compare-select on all the states at once (SSE2,
+ * AVX2 or NEON, selected at runtime). Like all the NEON code of the
+ * library, the NEON kernels are only built with --enable-neon (GMR1_NEON).
+ *
+ * It relies on the structure shared by all GMR-1 codes : a shift register
+ * state (next_state[s][b] = (s << 1 | b) & mask) and every generator
+ * polynomial having a D^0 term (next_output[s][1] = ~next_output[s][0]).
+ * The metric of libosmocore's generic decoder is a sum of per bit terms, so
+ * with that structure the branch metrics of a whole trellis step derive from
+ * N+2 scalars and a constant per state bit mask. Path metrics are kept
+ * relative to the one of state 0 in 16 bits, which is exact since the
+ * spread between states is bounded by (K-1) times the largest branch metric.
+ *
+ * Codes libosmocore decodes with its own accelerated implementation
+ * (K=5 and K=7 with N <= 4, which uses a different metric) and any code not
+ * matching the above are passed through to osmo_conv_decode() unchanged, so
+ * the output of \ref gmr1_conv_decode is always the one of osmo_conv_decode().
+ * The batch decoder has no such counterpart and uses the generic metric for
+ * every code it supports.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <osmocom/core/bits.h>
+#include <osmocom/core/conv.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON) && defined(GMR1_NEON)
+#define HAVE_NEON_KERNEL
+#include <arm_neon.h>
+#endif
+
+#include <osmocom/gmr1/l1/conv.h>
+
+#include "private.h"
+
+
+#define VIT_MIN_K	5	/* At least 8 states per half trellis */
+#define VIT_MAX_K	9	/* State history is 8 bits wide */
+#define VIT_MAX_N	8
+#define VIT_UNREACH	0x3fff	/* Metric of a not yet reachable state */
+
+
+/*! \brief Viterbi decoder working state */
+struct vit_state {
+	int n_states;		/*!< \brief Number of trellis states */
+	int N;			/*!< \brief Output bits per input bit */
+
+	/*! \brief Bit j of next_output[s][0] as 0 / -1, at [j * n_states + s] */
+	int16_t *masks;
+
+	/*! \brief Per step branch metric description (N+2 values) :
+	 *  sum of the '0' terms, sum of both terms, '1' - '0' delta of each bit
+	 */
+	int16_t *bm;
+
+	/*! \brief Per step decisions : bit 2*j of the first n_states/8 bytes is
+	 *  set if state 2*j comes from j + n_states/2, same for state 2*j+1 in
+	 *  the next n_states/8 bytes */
+	uint8_t *dec;
+
+	int16_t *ae;		/*!< \brief Current path metrics (relative) */
+	int16_t *ae_next;	/*!< \brief Next path metrics */
+	int offset;		/*!< \brief Absolute metric of the reference */
+};
+
+/*! \brief Viterbi ACS kernel signature
+ *  \param[in] vs Decoder state
+ *  \param[in] first First trellis step to process
+ *  \param[in] last Last trellis step to process (excluded)
+ *  \param[in] flush Only follow the '0' branches (termination steps)
+ */
+typedef void (*vit_fn_t)(struct vit_state *vs, int first, int last, int flush);
+
+
+static inline void
+_vit_swap(struct vit_state *vs)
+{
+	int16_t *t = vs->ae;
+	vs->ae = vs->ae_next;
+	vs->ae_next = t;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/* Scalar                                                                   */
+/* ------------------------------------------------------------------------ */
+
+static void
+_vit_scalar(struct vit_state *vs, int first, int last, int flush)
+{
+	const int n = vs->n_states, h = n >> 1, N = vs->N;
+	int k, j, i;
+
+	for (k=first; k<last; k++)
+	{
+		const int16_t *bm = &vs->bm[k * (N + 2)];
+		uint8_t *dec = &vs->dec[k * (n >> 2)];
+		int norm = 0;
+
+		memset(dec, 0x00, n >> 2);
+
+		for (j=0; j<h; j++)
+		{
+			int ba = bm[0], bb = bm[0];
+			int m0, m1, e, o;
+
+			for (i=0; i<N; i++) {
+				ba += vs->masks[i * n + j]     & bm[2+i];
+				bb += vs->masks[i * n + j + h] & bm[2+i];
+			}
+
+			/* Even state, '0' branch */
+			m0 = vs->ae[j]     + ba;
+			m1 = vs->ae[j + h] + bb;
+			e  = m1 < m0 ? m1 : m0;
+			if (m1 < m0)
+				dec[(2*j) >> 3] |= 1 << ((2*j) & 7);
+
+			/* Odd state, '1' branch */
+			if (flush) {
+				o = VIT_UNREACH;
+			} else {
+				m0 = vs->ae[j]     + (bm[1] - ba);
+				m1 = vs->ae[j + h] + (bm[1] - bb);
+				o  = m1 < m0 ? m1 : m0;
+				if (m1 < m0)
+					dec[(n >> 3) + ((2*j) >> 3)] |= 1 << ((2*j) & 7);
+			}
+
+			/* Normalize against state 0 */
+			if (!j)
+				norm = e;
+
+			vs->ae_next[2*j]   = e - norm;
+			vs->ae_next[2*j+1] = o - norm;
+		}
+
+		vs->offset += norm;
+		_vit_swap(vs);
+	}
+}
+
+
+/* ------------------------------------------------------------------------ */
+/* SSE2                                                                     */
+/* ------------------------------------------------------------------------ */
+
+#if defined(__SSE2__)
+
+static void
+_vit_sse2(struct vit_state *vs, int first, int last, int flush)
+{
+	const int n = vs->n_states, h = n >> 1, N = vs->N;
+	int k, j, i;
+
+	for (k=first; k<last; k++)
+	{
+		const int16_t *bm = &vs->bm[k * (N + 2)];
+		uint8_t *dec = &vs->dec[k * (n >> 2)];
+		__m128i c0, t, d[VIT_MAX_N], norm = _mm_setzero_si128();
+
+		c0 = _mm_set1_epi16(bm[0]);
+		t  = _mm_set1_epi16(bm[1]);
+		for (i=0; i<N; i++)
+			d[i] = _mm_set1_epi16(bm[2+i]);
+
+		for (j=0; j<h; j+=8)
+		{
+			__m128i ae_l, ae_h, ba, bb, m0, m1, e, o, de, dof;
+			uint16_t mde, mdo;
+
+			ae_l = _mm_load_si128((const __m128i *)&vs->ae[j]);
+			ae_h = _mm_load_si128((const __m128i *)&vs->ae[j + h]);
+
+			ba = bb = c0;
+			for (i=0; i<N; i++) {
+				ba = _mm_add_epi16(ba, _mm_and_si128(d[i],
+					_mm_load_si128((const __m128i *)&vs->masks[i * n + j])));
+				bb = _mm_add_epi16(bb, _mm_and_si128(d[i],
+					_mm_load_si128((const __m128i *)&vs->masks[i * n + j + h])));
+			}
+
+			/* Even states, '0' branches */
+			m0 = _mm_add_epi16(ae_l, ba);
+			m1 = _mm_add_epi16(ae_h, bb);
+			e  = _mm_min_epi16(m0, m1);
+			de = _mm_cmpgt_epi16(m0, m1);
+
+			/* Odd states, '1' branches */
+			if (flush) {
+				o   = _mm_set1_epi16(VIT_UNREACH);
+				dof = _mm_setzero_si128();
+			} else {
+				m0  = _mm_add_epi16(ae_l, _mm_sub_epi16(t, ba));
+				m1  = _mm_add_epi16(ae_h, _mm_sub_epi16(t, bb));
+				o   = _mm_min_epi16(m0, m1);
+				dof = _mm_cmpgt_epi16(m0, m1);
+			}
+
+			/* Normalize against state 0 */
+			if (!j) {
+				norm = _mm_shufflelo_epi16(e, 0x00);
+				norm = _mm_unpacklo_epi64(norm, norm);
+			}
+
+			e = _mm_sub_epi16(e, norm);
+			o = _mm_sub_epi16(o, norm);
+
+			_mm_store_si128((__m128i *)&vs->ae_next[2*j],     _mm_unpacklo_epi16(e, o));
+			_mm_store_si128((__m128i *)&vs->ae_next[2*j + 8], _mm_unpackhi_epi16(e, o));
+
+			/* Decisions */
+			mde = _mm_movemask_epi8(de);
+			mdo = _mm_movemask_epi8(dof);
+			memcpy(&dec[j >> 2], &mde, 2);
+			memcpy(&dec[(n >> 3) + (j >> 2)], &mdo, 2);
+		}
+
+		vs->offset += (int16_t)_mm_cvtsi128_si32(norm);
+		_vit_swap(vs);
+	}
+}
+
+#endif /* __SSE2__ */
+
+
+/* ------------------------------------------------------------------------ */
+/* AVX2                                                                     */
+/* ------------------------------------------------------------------------ */
+
+#if defined(HAVE_AVX2_KERNEL)
+
+__attribute__((target("avx2")))
+static void
+_vit_avx2(struct vit_state *vs, int first, int last, int flush)
+{
+	const int n = vs->n_states, h = n >> 1, N = vs->N;
+	int k, j, i;
+
+	for (k=first; k<last; k++)
+	{
+		const int16_t *bm = &vs->bm[k * (N + 2)];
+		uint8_t *dec = &vs->dec[k * (n >> 2)];
+		__m256i c0, t, d[VIT_MAX_N], norm = _mm256_setzero_si256();
+
+		c0 = _mm256_set1_epi16(bm[0]);
+		t  = _mm256_set1_epi16(bm[1]);
+		for (i=0; i<N; i++)
+			d[i] = _mm256_set1_epi16(bm[2+i]);
+
+		for (j=0; j<h; j+=16)
+		{
+			__m256i ae_l, ae_h, ba, bb, m0, m1, e, o, de, dof, lo, hi;
+			uint32_t mde, mdo;
+
+			ae_l = _mm256_load_si256((const __m256i *)&vs->ae[j]);
+			ae_h = _mm256_load_si256((const __m256i *)&vs->ae[j + h]);
+
+			ba = bb = c0;
+			for (i=0; i<N; i++) {
+				ba = _mm256_add_epi16(ba, _mm256_and_si256(d[i],
+					_mm256_load_si256((const __m256i *)&vs->masks[i * n + j])));
+				bb = _mm256_add_epi16(bb, _mm256_and_si256(d[i],
+					_mm256_load_si256((const __m256i *)&vs->masks[i * n + j + h])));
+			}
+
+			/* Even states, '0' branches */
+			m0 = _mm256_add_epi16(ae_l, ba);
+			m1 = _mm256_add_epi16(ae_h, bb);
+			e  = _mm256_min_epi16(m0, m1);
+			de = _mm256_cmpgt_epi16(m0, m1);
+
+			/* Odd states, '1' branches */
+			if (flush) {
+				o   = _mm256_set1_epi16(VIT_UNREACH);
+				dof = _mm256_setzero_si256();
+			} else {
+				m0  = _mm256_add_epi16(ae_l, _mm256_sub_epi16(t, ba));
+				m1  = _mm256_add_epi16(ae_h, _mm256_sub_epi16(t, bb));
+				o   = _mm256_min_epi16(m0, m1);
+				dof = _mm256_cmpgt_epi16(m0, m1);
+			}
+
+			/* Normalize against state 0 */
+			if (!j)
+				norm = _mm256_broadcastw_epi16(_mm256_castsi256_si128(e));
+
+			e = _mm256_sub_epi16(e, norm);
+			o = _mm256_sub_epi16(o, norm);
+
+			/* Interleave (unpack works within 128 bits lanes) */
+			lo = _mm256_unpacklo_epi16(e, o);
+			hi = _mm256_unpackhi_epi16(e, o);
+
+			_mm256_store_si256((__m256i *)&vs->ae_next[2*j],
+				_mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_store_si256((__m256i *)&vs->ae_next[2*j + 16],
+				_mm256_permute2x128_si256(lo, hi, 0x31));
+
+			/* Decisions */
+			mde = _mm256_movemask_epi8(de);
+			mdo = _mm256_movemask_epi8(dof);
+			memcpy(&dec[j >> 2], &mde, 4);
+			memcpy(&dec[(n >> 3) + (j >> 2)], &mdo, 4);
+		}
+
+		vs->offset += (int16_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(norm));
+		_vit_swap(vs);
+	}
+}
+
+#endif /* HAVE_AVX2_KERNEL */
+
+
+/* ------------------------------------------------------------------------ */
+/* NEON                                                                     */
+/* ------------------------------------------------------------------------ */
+
+#if defined(HAVE_NEON_KERNEL)
+
+static void
+_vit_neon(struct vit_state *vs, int first, int last, int flush)
+{
+	static const uint16_t w[8] = {
+		0x0003, 0x000c, 0x0030, 0x00c0, 0x0300, 0x0c00, 0x3000, 0xc000,
+	};
+	const int n = vs->n_states, h = n >> 1, N = vs->N;
+	const uint16x8_t weights = vld1q_u16(w);
+	int k, j, i;
+
+	for (k=first; k<last; k++)
+	{
+		const int16_t *bm = &vs->bm[k * (N + 2)];
+		uint8_t *dec = &vs->dec[k * (n >> 2)];
+		int16x8_t c0, t, d[VIT_MAX_N], norm = vdupq_n_s16(0);
+
+		c0 = vdupq_n_s16(bm[0]);
+		t  = vdupq_n_s16(bm[1]);
+		for (i=0; i<N; i++)
+			d[i] = vdupq_n_s16(bm[2+i]);
+
+		for (j=0; j<h; j+=8)
+		{
+			int16x8_t ae_l, ae_h, ba, bb, m0, m1, e, o;
+			uint16x8_t de, dof;
+			uint16_t mde, mdo;
+
+			ae_l = vld1q_s16(&vs->ae[j]);
+			ae_h = vld1q_s16(&vs->ae[j + h]);
+
+			ba = bb = c0;
+			for (i=0; i<N; i++) {
+				ba = vaddq_s16(ba, vandq_s16(d[i], vld1q_s16(&vs->masks[i * n + j])));
+				bb = vaddq_s16(bb, vandq_s16(d[i], vld1q_s16(&vs->masks[i * n + j + h])));
+			}
+
+			/* Even states, '0' branches */
+			m0 = vaddq_s16(ae_l, ba);
+			m1 = vaddq_s16(ae_h, bb);
+			e  = vminq_s16(m0, m1);
+			de = vcgtq_s16(m0, m1);
+
+			/* Odd states, '1' branches */
+			if (flush) {
+				o   = vdupq_n_s16(VIT_UNREACH);
+				dof = vdupq_n_u16(0);
+			} else {
+				m0  = vaddq_s16(ae_l, vsubq_s16(t, ba));
+				m1  = vaddq_s16(ae_h, vsubq_s16(t, bb));
+				o   = vminq_s16(m0, m1);
+				dof = vcgtq_s16(m0, m1);
+			}
+
+			/* Normalize against state 0 */
+			if (!j)
+				norm = vdupq_n_s16(vgetq_lane_s16(e, 0));
+
+			e = vsubq_s16(e, norm);
+			o = vsubq_s16(o, norm);
+
+			vst1q_s16(&vs->ae_next[2*j],     vzip1q_s16(e, o));
+			vst1q_s16(&vs->ae_next[2*j + 8], vzip2q_s16(e, o));
+
+			/* Decisions (same layout as SSE2 movemask) */
+			mde = vaddvq_u16(vandq_u16(de,  weights));
+			mdo = vaddvq_u16(vandq_u16(dof, weights));
+			memcpy(&dec[j >> 2], &mde, 2);
+			memcpy(&dec[(n >> 3) + (j >> 2)], &mdo, 2);
+		}
+
+		vs->offset += vgetq_lane_s16(norm, 0);
+		_vit_swap(vs);
+	}
+}
+
+#endif /* HAVE_NEON_KERNEL */
+
+
+/* ------------------------------------------------------------------------ */
+/* Batch kernels                                                            */
+/* ------------------------------------------------------------------------ */
+
+/*
+ * The batch decoder runs one frame per 16 bits lane, so 8 (SSE2 / NEON) or
+ * 16 (AVX2) frames of the same code share each trellis sweep. The metric
+ * is the same as above, for every code with the right trellis structure
+ * (including those libosmocore decodes with its own implementation).
+ */
+
+#define VITB_MAX_W	16
+
+/*! \brief Batch Viterbi decoder working state */
+struct vitb_state {
+	int n_states;		/*!< \brief Number of trellis states */
+	int N;			/*!< \brief Output bits per input bit */
+	int W;			/*!< \brief Number of frames per sweep */
+
+	/*! \brief next_output[s][0] of each state */
+	uint8_t *out0;
+
+	/*! \brief Index in a step's branch metric description of the delta to
+	 *  add to go from output o & (o-1) to output o */
+	uint8_t bmt_d[1 << VIT_MAX_N];
+
+	/*! \brief Per step branch metric description, [N+2][W] */
+	int16_t *bm;
+
+	/*! \brief Per step and state decisions, bit 2*lane is set if the state
+	 *  comes from its predecessor in the upper half of the trellis */
+	uint32_t *dec;
+
+	int16_t *ae;		/*!< \brief Current path metrics, [n_states][W] */
+	int16_t *ae_next;	/*!< \brief Next path metrics, [n_states][W] */
+	int offset[VITB_MAX_W];	/*!< \brief Absolute metric of the references */
+};
+
+/*! \brief Batch Viterbi ACS kernel signature (see \ref vit_fn_t) */
+typedef void (*vitb_fn_t)(struct vitb_state *vb, int first, int last, int flush);
+
+
+static inline void
+_vitb_swap(struct vitb_state *vb)
+{
+	int16_t *t = vb->ae;
+	vb->ae = vb->ae_next;
+	vb->ae_next = t;
+}
+
+static void
+_vitb_scalar(struct vitb_state *vb, int first, int last, int flush)
+{
+	const int n = vb->n_states, h = n >> 1, N = vb->N, W = vb->W;
+	const int all = (1 << N) - 1;
+	int16_t bmt[1 << VIT_MAX_N][VITB_MAX_W];
+	int k, j, l, o;
+
+	for (k=first; k<last; k++)
+	{
+		const int16_t *bm = &vb->bm[k * (N + 2) * W];
+		uint32_t *dec = &vb->dec[k * n];
+		int16_t norm[VITB_MAX_W];
+
+		/* Branch metric of each possible output */
+		for (l=0; l<W; l++)
+			bmt[0][l] = bm[l];
+
+		for (o=1; o<=all; o++)
+			for (l=0; l<W; l++)
+				bmt[o][l] = bmt[o & (o-1)][l] + bm[vb->bmt_d[o] * W + l];
+
+		for (j=0; j<h; j++)
+		{
+			const int o0 = vb->out0[j], o1 = vb->out0[j + h];
+			uint32_t de = 0, dof = 0;
+
+			for (l=0; l<W; l++)
+			{
+				int a0 = vb->ae[j * W + l];
+				int a1 = vb->ae[(j + h) * W + l];
+				int m0, m1, e, od;
+
+				/* Even state, '0' branch */
+				m0 = a0 + bmt[o0][l];
+				m1 = a1 + bmt[o1][l];
+				e  = m1 < m0 ? m1 : m0;
+				if (m1 < m0)
+					de |= 1 << (2*l);
+
+				/* Odd state, '1' branch */
+				if (flush) {
+					od = VIT_UNREACH;
+				} else {
+					m0 = a0 + bmt[o0 ^ all][l];
+					m1 = a1 + bmt[o1 ^ all][l];
+					od = m1 < m0 ? m1 : m0;
+					if (m1 < m0)
+						dof |= 1 << (2*l);
+				}
+
+				/* Normalize against state 0 */
+				if (!j)
+					norm[l] = e;
+
+				vb->ae_next[(2*j)   * W + l] = e  - norm[l];
+				vb->ae_next[(2*j+1) * W + l] = od - norm[l];
+			}
+
+			dec[2*j]   = de;
+			dec[2*j+1] = dof;
+		}
+
+		for (l=0; l<W; l++)
+			vb->offset[l] += norm[l];
+
+		_vitb_swap(vb);
+	}
+}
+
+#if defined(__SSE2__)
+
+static void
+_vitb_sse2(struct vitb_state *vb, int first, int last, int flush)
+{
+	const int n = vb->n_states, h = n >> 1, N = vb->N;
+	const int all = (1 << N) - 1;
+	__m128i bmt[1 << VIT_MAX_N];
+	int16_t norm_l[8] __attribute__((aligned(16)));
+	int k, j, l, o;
+
+	for (k=first; k<last; k++)
+	{
+		const __m128i *bm = (const __m128i *)&vb->bm[k * (N + 2) * 8];
+		const __m128i *ae = (const __m128i *)vb->ae;
+		__m128i *ae_next = (__m128i *)vb->ae_next;
+		uint32_t *dec = &vb->dec[k * n];
+		__m128i norm = _mm_setzero_si128();
+
+		/* Branch metric of each possible output */
+		bmt[0] = bm[0];
+		for (o=1; o<=all; o++)
+			bmt[o] = _mm_add_epi16(bmt[o & (o-1)], bm[vb->bmt_d[o]]);
+
+		for (j=0; j<h; j++)
+		{
+			const int o0 = vb->out0[j], o1 = vb->out0[j + h];
+			__m128i a0 = ae[j], a1 = ae[j + h];
+			__m128i m0, m1, e, od, de, dof;
+
+			/* Even state, '0' branch */
+			m0 = _mm_add_epi16(a0, bmt[o0]);
+			m1 = _mm_add_epi16(a1, bmt[o1]);
+			e  = _mm_min_epi16(m0, m1);
+			de = _mm_cmpgt_epi16(m0, m1);
+
+			/* Odd state, '1' branch */
+			if (flush) {
+				od  = _mm_set1_epi16(VIT_UNREACH);
+				dof = _mm_setzero_si128();
+			} else {
+				m0  = _mm_add_epi16(a0, bmt[o0 ^ all]);
+				m1  = _mm_add_epi16(a1, bmt[o1 ^ all]);
+				od  = _mm_min_epi16(m0, m1);
+				dof = _mm_cmpgt_epi16(m0, m1);
+			}
+
+			/* Normalize against state 0 */
+			if (!j)
+				norm = e;
+
+			ae_next[2*j]   = _mm_sub_epi16(e,  norm);
+			ae_next[2*j+1] = _mm_sub_epi16(od, norm);
+
+			dec[2*j]   = _mm_movemask_epi8(de);
+			dec[2*j+1] = _mm_movemask_epi8(dof);
+		}
+
+		_mm_store_si128((__m128i *)norm_l, norm);
+		for (l=0; l<8; l++)
+			vb->offset[l] += norm_l[l];
+
+		_vitb_swap(vb);
+	}
+}
+
+#endif /* __SSE2__ */
+
+#if defined(HAVE_AVX2_KERNEL)
+
+__attribute__((target("avx2")))
+static void
+_vitb_avx2(struct vitb_state *vb, int first, int last, int flush)
+{
+	const int n = vb->n_states, h = n >> 1, N = vb->N;
+	const int all = (1 << N) - 1;
+	__m256i bmt[1 << VIT_MAX_N];
+	int16_t norm_l[16] __attribute__((aligned(32)));
+	int k, j, l, o;
+
+	for (k=first; k<last; k++)
+	{
+		const __m256i *bm = (const __m256i *)&vb->bm[k * (N + 2) * 16];
+		const __m256i *ae = (const __m256i *)vb->ae;
+		__m256i *ae_next = (__m256i *)vb->ae_next;
+		uint32_t *dec = &vb->dec[k * n];
+		__m256i norm = _mm256_setzero_si256();
+
+		/* Branch metric of each possible output */
+		bmt[0] = bm[0];
+		for (o=1; o<=all; o++)
+			bmt[o] = _mm256_add_epi16(bmt[o & (o-1)], bm[vb->bmt_d[o]]);
+
+		for (j=0; j<h; j++)
+		{
+			const int o0 = vb->out0[j], o1 = vb->out0[j + h];
+			__m256i a0 = ae[j], a1 = ae[j + h];
+			__m256i m0, m1, e, od, de, dof;
+
+			/* Even state, '0' branch */
+			m0 = _mm256_add_epi16(a0, bmt[o0]);
+			m1 = _mm256_add_epi16(a1, bmt[o1]);
+			e  = _mm256_min_epi16(m0, m1);
+			de = _mm256_cmpgt_epi16(m0, m1);
+
+			/* Odd state, '1' branch */
+			if (flush) {
+				od  = _mm256_set1_epi16(VIT_UNREACH);
+				dof = _mm256_setzero_si256();
+			} else {
+				m0  = _mm256_add_epi16(a0, bmt[o0 ^ all]);
+				m1  = _mm256_add_epi16(a1, bmt[o1 ^ all]);
+				od  = _mm256_min_epi16(m0, m1);
+				dof = _mm256_cmpgt_epi16(m0, m1);
+			}
+
+			/* Normalize against state 0 */
+			if (!j)
+				norm = e;
+
+			ae_next[2*j]   = _mm256_sub_epi16(e,  norm);
+			ae_next[2*j+1] = _mm256_sub_epi16(od, norm);
+
+			dec[2*j]   = _mm256_movemask_epi8(de);
+			dec[2*j+1] = _mm256_movemask_epi8(dof);
+		}
+
+		_mm256_store_si256((__m256i *)norm_l, norm);
+		for (l=0; l<16; l++)
+			vb->offset[l] += norm_l[l];
+
+		_vitb_swap(vb);
+	}
+}
+
+#endif /* HAVE_AVX2_KERNEL */
+
+#if defined(HAVE_NEON_KERNEL)
+
+static void
+_vitb_neon(struct vitb_state *vb, int first, int last, int flush)
+{
+	static const uint16_t w[8] = {
+		0x0003, 0x000c, 0x0030, 0x00c0, 0x0300, 0x0c00, 0x3000, 0xc000,
+	};
+	const int n = vb->n_states, h = n >> 1, N = vb->N;
+	const int all = (1 << N) - 1;
+	const uint16x8_t weights = vld1q_u16(w);
+	int16x8_t bmt[1 << VIT_MAX_N];
+	int16_t norm_l[8];
+	int k, j, l, o;
+
+	for (k=first; k<last; k++)
+	{
+		const int16_t *bm = &vb->bm[k * (N + 2) * 8];
+		uint32_t *dec = &vb->dec[k * n];
+		int16x8_t norm = vdupq_n_s16(0);
+
+		/* Branch metric of each possible output */
+		bmt[0] = vld1q_s16(bm);
+		for (o=1; o<=all; o++)
+			bmt[o] = vaddq_s16(bmt[o & (o-1)], vld1q_s16(&bm[vb->bmt_d[o] * 8]));
+
+		for (j=0; j<h; j++)
+		{
+			const int o0 = vb->out0[j], o1 = vb->out0[j + h];
+			int16x8_t a0 = vld1q_s16(&vb->ae[j * 8]);
+			int16x8_t a1 = vld1q_s16(&vb->ae[(j + h) * 8]);
+			int16x8_t m0, m1, e, od;
+			uint16x8_t de, dof;
+
+			/* Even state, '0' branch */
+			m0 = vaddq_s16(a0, bmt[o0]);
+			m1 = vaddq_s16(a1, bmt[o1]);
+			e  = vminq_s16(m0, m1);
+			de = vcgtq_s16(m0, m1);
+
+			/* Odd state, '1' branch */
+			if (flush) {
+				od  = vdupq_n_s16(VIT_UNREACH);
+				dof = vdupq_n_u16(0);
+			} else {
+				m0  = vaddq_s16(a0, bmt[o0 ^ all]);
+				m1  = vaddq_s16(a1, bmt[o1 ^ all]);
+				od  = vminq_s16(m0, m1);
+				dof = vcgtq_s16(m0, m1);
+			}
+
+			/* Normalize against state 0 */
+			if (!j)
+				norm = e;
+
+			vst1q_s16(&vb->ae_next[(2*j)   * 8], vsubq_s16(e,  norm));
+			vst1q_s16(&vb->ae_next[(2*j+1) * 8], vsubq_s16(od, norm));
+
+			dec[2*j]   = vaddvq_u16(vandq_u16(de,  weights));
+			dec[2*j+1] = vaddvq_u16(vandq_u16(dof, weights));
+		}
+
+		vst1q_s16(norm_l, norm);
+		for (l=0; l<8; l++)
+			vb->offset[l] += norm_l[l];
+
+		_vitb_swap(vb);
+	}
+}
+
+#endif /* HAVE_NEON_KERNEL */
+
+
+/* ------------------------------------------------------------------------ */
+/* Dispatch                                                                 */
+/* ------------------------------------------------------------------------ */
+
+static vit_fn_t g_vit_fn_8  = _vit_scalar;	/* 8 states per half trellis */
+static vit_fn_t g_vit_fn_16 = _vit_scalar;	/* >= 16 states per half */
+static vitb_fn_t g_vitb_fn  = _vitb_scalar;
+static int g_vitb_w = 8;			/* Frames per batch sweep */
+static pthread_once_t g_vit_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_vit_ws_key;		/* Per thread work memory */
+
+/* Metric of osmo_conv_decode() for a '0' / '1' bit, by soft bit value */
+static int16_t g_vit_c0[256];
+static int16_t g_vit_c1[256];
+
+/*! \brief Work memory of the decoders, kept between calls of a thread */
+struct vit_ws {
+	void *mem;
+	size_t len;
+};
+
+static void
+_vit_ws_free(void *arg)
+{
+	struct vit_ws *ws = arg;
+
+	free(ws->mem);
+	free(ws);
+}
+
+/*! \brief Get at least len bytes of 32 bytes aligned work memory
+ *
+ * The memory belongs to the calling thread and is only valid until the
+ * next call.
+ */
+static void *
+_vit_ws_get(size_t len)
+{
+	struct vit_ws *ws = pthread_getspecific(g_vit_ws_key);
+
+	if (!ws) {
+		ws = calloc(1, sizeof(struct vit_ws));
+		if (!ws)
+			return NULL;
+
+		if (pthread_setspecific(g_vit_ws_key, ws)) {
+			free(ws);
+			return NULL;
+		}
+	}
+
+	if (ws->len < len) {
+		free(ws->mem);
+		ws->len = 0;
+
+		if (posix_memalign(&ws->mem, 32, len)) {
+			ws->mem = NULL;
+			return NULL;
+		}
+
+		ws->len = len;
+	}
+
+	return ws->mem;
+}
+
+/*! \brief Select the best kernels for the running CPU, init the tables */
+static void
+_vit_select(void)
+{
+	int v;
+
+	pthread_key_create(&g_vit_ws_key, _vit_ws_free);
+
+	for (v=-128; v<128; v++) {
+		g_vit_c0[v & 0xff] = v ? ((v - 127) * (v - 127)) >> 9 : 0;
+		g_vit_c1[v & 0xff] = v ? ((v + 127) * (v + 127)) >> 9 : 0;
+	}
+
+#if defined(HAVE_NEON_KERNEL)
+	g_vit_fn_8 = g_vit_fn_16 = _vit_neon;
+	g_vitb_fn = _vitb_neon;
+#endif
+#if defined(__SSE2__)
+	g_vit_fn_8 = g_vit_fn_16 = _vit_sse2;
+	g_vitb_fn = _vitb_sse2;
+#endif
+#if defined(HAVE_AVX2_KERNEL)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		g_vit_fn_16 = _vit_avx2;
+		g_vitb_fn = _vitb_avx2;
+		g_vitb_w = 16;
+	}
+#endif
+}
+
+/*! \brief Check if a code has the trellis structure the kernels need */
+static int
+_vit_trellis_ok(const struct osmo_conv_code *code)
+{
+	int n, s, all;
+
+	if ((code->K < VIT_MIN_K) || (code->K > VIT_MAX_K))
+		return 0;
+
+	if ((code->N < 1) || (code->N > VIT_MAX_N))
+		return 0;
+
+	/* Twice the metric spread must stay below the unreachable marker */
+	if (((2 * (code->K - 1) + 1) * code->N * 127) >= VIT_UNREACH)
+		return 0;
+
+	if (code->next_term_output || code->next_term_state)
+		return 0;
+
+	if ((code->term != CONV_TERM_FLUSH) &&
+	    (code->term != CONV_TERM_TRUNCATION) &&
+	    (code->term != CONV_TERM_TAIL_BITING))
+		return 0;
+
+	/* Trellis structure */
+	n = 1 << (code->K - 1);
+	all = (1 << code->N) - 1;
+
+	for (s=0; s<n; s++) {
+		if ((code->next_state[s][0] != ((s << 1) & (n - 1))) ||
+		    (code->next_state[s][1] != (((s << 1) | 1) & (n - 1))))
+			return 0;
+
+		if (code->next_output[s][1] != (code->next_output[s][0] ^ all))
+			return 0;
+	}
+
+	return 1;
+}
+
+/*! \brief Check if a code can use the specialized single frame decoder */
+static int
+_vit_supported(const struct osmo_conv_code *code)
+{
+	/* libosmocore has its own implementation for those */
+	if ((code->N <= 4) && ((code->K == 5) || (code->K == 7)))
+		return 0;
+
+	return _vit_trellis_ok(code);
+}
+
+/*! \brief Per step mask of the transmitted (not punctured) output bits
+ *  \param[in] code Description of the convolutional code
+ *  \param[out] live Bit j of live[k] is set if output bit j of step k is
+ *                   transmitted
+ *  \param[in] n_steps Number of trellis steps
+ */
+static void
+_vit_punct_mask(const struct osmo_conv_code *code, uint8_t *live, int n_steps)
+{
+	const int N = code->N;
+	const int *p = code->puncture;
+	int k, base;
+
+	memset(live, (1 << N) - 1, n_steps);
+
+	if (!p)
+		return;
+
+	/* Puncture positions are in increasing order */
+	for (k=0, base=0; (*p >= 0) && (k < n_steps); p++) {
+		while (*p >= base + N) {
+			base += N;
+			if (++k == n_steps)
+				return;
+		}
+		live[k] &= ~(1 << (*p - base));
+	}
+}
+
+/*! \brief Per step mask of the transmitted output bits, if any punctured
+ *  \param[in] code Description of the convolutional code
+ *  \param[out] buf Buffer of n_steps bytes, used if the mask isn't known
+ *  \param[in] n_steps Number of trellis steps
+ *  \returns The mask, NULL if no bit is punctured
+ *
+ * The masks of the channel codes are generated with them (see
+ * gen_conv_spec.c), they're only computed for other punctured codes.
+ */
+static const uint8_t *
+_vit_live(const struct osmo_conv_code *code, uint8_t *buf, int n_steps)
+{
+	const struct gmr1_conv_live *l;
+
+	if (!code->puncture)
+		return NULL;
+
+	for (l=gmr1_conv_live; l->code; l++)
+		if (l->code == code)
+			return l->live;
+
+	_vit_punct_mask(code, buf, n_steps);
+
+	return buf;
+}
+
+/*! \brief Compute the branch metrics description of each trellis step
+ *  \param[in] code Description of the convolutional code
+ *  \param[in] input Input soft bits (punctured stream)
+ *  \param[in] live Transmitted bits of each step (see \ref _vit_live),
+ *                  NULL if all are
+ *  \param[out] bm Branch metrics description, value x of step k is written
+ *                 at bm[(k * (N+2) + x) * stride]
+ *  \param[in] n_steps Number of trellis steps
+ *  \param[in] stride Distance between two values in bm
+ *
+ * The input is consumed as is, punctured bits contribute nothing to the
+ * metric, same as the zeros osmo_conv_decode() inserts for them.
+ */
+static void
+_vit_branch_metrics(const struct osmo_conv_code *code, const sbit_t *input,
+                    const uint8_t *live, int16_t *bm, int n_steps, int stride)
+{
+	const int N = code->N;
+	int k, j, i_idx = 0;
+
+	for (k=0; k<n_steps; k++)
+	{
+		int16_t *b = &bm[k * (N + 2) * stride];
+		int lk = live ? live[k] : 0xff;
+		int c0_sum = 0, c_sum = 0;
+
+		for (j=0; j<N; j++)
+		{
+			uint8_t is;
+			int c0, c1;
+
+			if (!(lk & (1 << j))) {
+				b[(2+j) * stride] = 0;
+				continue;
+			}
+
+			is = input[i_idx++];
+			c0 = g_vit_c0[is];
+			c1 = g_vit_c1[is];
+
+			c0_sum += c0;
+			c_sum  += c0 + c1;
+			b[(2+j) * stride] = c1 - c0;
+		}
+
+		b[0]      = c0_sum;
+		b[stride] = c_sum;
+	}
+}
+
+/*! \brief Predecessor of a state according to the stored decisions */
+static inline int
+_vit_prev(const struct vit_state *vs, int k, int s)
+{
+	const uint8_t *dec = &vs->dec[k * (vs->n_states >> 2)];
+	int h = vs->n_states >> 1;
+	int j = s >> 1;
+	int bit;
+
+	if (s & 1)
+		dec += vs->n_states >> 3;
+
+	bit = (dec[(2*j) >> 3] >> ((2*j) & 7)) & 1;
+
+	return bit ? (j + h) : j;
+}
+
+/*! \brief Viterbi decoding, bit-exact with osmo_conv_decode()
+ *  \param[in] code Description of the convolutional code
+ *  \param[in] input Input soft bits (-127...127)
+ *  \param[out] output Output decoded bits
+ *  \returns Same as osmo_conv_decode(), accumulated error metric of the
+ *           selected path, or negative error code
+ *
+ * Uses a vectorized implementation for the codes it supports (see the file
+ * description) and osmo_conv_decode() for any other.
+ */
+int
+gmr1_conv_decode(const struct osmo_conv_code *code,
+                 const sbit_t *input, ubit_t *output)
+{
+	struct vit_state _vs, *vs = &_vs;
+	vit_fn_t fn;
+	void *mem;
+	int16_t *ae;
+	const uint8_t *live;
+	int n, h, n_steps, len, i, j, s, min_s, min_ae;
+	size_t sz_ae, sz_masks, sz_bm, sz_dec, sz_live;
+
+	if (!_vit_supported(code))
+		return osmo_conv_decode(code, input, output);
+
+	pthread_once(&g_vit_once, _vit_select);
+
+	/* Dimensions */
+	n = 1 << (code->K - 1);
+	h = n >> 1;
+	len = code->len;
+	n_steps = len + ((code->term == CONV_TERM_FLUSH) ? (code->K - 1) : 0);
+
+	/* Work memory, metrics and masks 32 bytes aligned first */
+	sz_ae    = 2 * n * sizeof(int16_t);
+	sz_masks = code->N * n * sizeof(int16_t);
+	sz_bm    = n_steps * (code->N + 2) * sizeof(int16_t);
+	sz_dec   = n_steps * (n >> 2);
+	sz_live  = n_steps;
+
+	mem = _vit_ws_get(sz_ae + sz_masks + sz_bm + sz_dec + sz_live);
+	if (!mem)
+		return -ENOMEM;
+
+	ae = mem;
+
+	vs->n_states = n;
+	vs->N        = code->N;
+	vs->ae       = &ae[0];
+	vs->ae_next  = &ae[n];
+	vs->masks    = (int16_t *)((uint8_t *)mem + sz_ae);
+	vs->bm       = (int16_t *)((uint8_t *)mem + sz_ae + sz_masks);
+	vs->dec      = (uint8_t *)mem + sz_ae + sz_masks + sz_bm;
+	vs->offset   = 0;
+
+	/* Output bits of the '0' branch of each state, first bit as MSB */
+	for (j=0; j<code->N; j++)
+		for (s=0; s<n; s++)
+			vs->masks[j * n + s] =
+				((code->next_output[s][0] >> (code->N - 1 - j)) & 1) ? -1 : 0;
+
+	/* Branch metrics of each step, straight from the punctured input */
+	live = _vit_live(code, vs->dec + sz_dec, n_steps);
+	_vit_branch_metrics(code, input, live, vs->bm, n_steps, 1);
+
+	fn = (h >= 16) ? g_vit_fn_16 : g_vit_fn_8;
+
+	/* Initial state, tail biting first runs the whole trellis from
+	 * there (like libosmocore) to estimate the metric of each state */
+	for (s=0; s<n; s++)
+		vs->ae[s] = s ? VIT_UNREACH : 0;
+
+	if (code->term == CONV_TERM_TAIL_BITING) {
+		fn(vs, 0, len, 0);
+
+		for (s=1, min_ae=vs->ae[0]; s<n; s++)
+			if (vs->ae[s] < min_ae)
+				min_ae = vs->ae[s];
+
+		vs->offset = -min_ae;
+	}
+
+	/* Run the trellis */
+	fn(vs, 0, len, 0);
+
+	if (code->term == CONV_TERM_FLUSH)
+		fn(vs, len, n_steps, 1);
+
+	/* End state */
+	if (code->term == CONV_TERM_FLUSH) {
+		min_s  = 0;
+		min_ae = vs->ae[0];
+	} else {
+		for (s=1, min_s=0, min_ae=vs->ae[0]; s<n; s++) {
+			if (vs->ae[s] < min_ae) {
+				min_ae = vs->ae[s];
+				min_s = s;
+			}
+		}
+	}
+
+	min_ae += vs->offset;
+
+	/* Traceback */
+	s = min_s;
+
+	for (i=n_steps-1; i>=len; i--)
+		s = _vit_prev(vs, i, s);
+
+	for (i=len-1; i>=0; i--) {
+		output[i] = s & 1;
+		s = _vit_prev(vs, i, s);
+	}
+
+	return min_ae;
+}
+
+/*! \brief Predecessor of a state of a given lane */
+static inline int
+_vitb_prev(const struct vitb_state *vb, int k, int s, int l)
+{
+	int bit = (vb->dec[k * vb->n_states + s] >> (2*l)) & 1;
+	return (s >> 1) | (bit ? (vb->n_states >> 1) : 0);
+}
+
+/*! \brief Batch Viterbi decoding of frames using the same code
+ *  \param[in] code Description of the convolutional code
+ *  \param[in] n Number of frames
+ *  \param[in] input Input soft bits of each frame
+ *  \param[out] output Output decoded bits of each frame
+ *  \param[out] rv Accumulated error metric of the selected path of each
+ *                 frame (can be NULL)
+ *  \returns 0 for success, negative error code otherwise
+ *
+ * Frames are decoded 8 or 16 at a time, one per vector lane. The result of
+ * each frame is the one of libosmocore's generic Viterbi decoder, which is
+ * also what \ref gmr1_conv_decode returns for the codes it specializes.
+ *
+ * For the codes libosmocore decodes with its own accelerated implementation
+ * (K=5 and K=7 with N <= 4 : BCCH, CCCH, FACCH3, FACCH9, RACH, TCH3 speech,
+ * TCH9 4k8 and 9k6), the generic metric is still used here. It is the same
+ * maximum likelihood decoding with a different metric, so the returned
+ * metric differs from the one of \ref gmr1_conv_decode and the decoded bits
+ * can differ on very noisy frames. Codes without the expected trellis
+ * structure are decoded one by one with \ref gmr1_conv_decode.
+ */
+int
+gmr1_conv_decode_batch(const struct osmo_conv_code *code, int n,
+                       const sbit_t * const *input, ubit_t * const *output,
+                       int *rv)
+{
+	struct vitb_state _vb, *vb = &_vb;
+	vitb_fn_t fn;
+	void *mem;
+	const uint8_t *live;
+	int ns, W, N, n_steps, len, g, i, l, o, s;
+	size_t sz_ae, sz_bm, sz_dec;
+
+	if (n <= 0)
+		return 0;
+
+	if (!_vit_trellis_ok(code)) {
+		for (i=0; i<n; i++) {
+			int r = gmr1_conv_decode(code, input[i], output[i]);
+			if (r < 0)
+				return r;
+			if (rv)
+				rv[i] = r;
+		}
+		return 0;
+	}
+
+	pthread_once(&g_vit_once, _vit_select);
+
+	fn = g_vitb_fn;
+	W  = g_vitb_w;
+
+	/* Dimensions */
+	ns = 1 << (code->K - 1);
+	N  = code->N;
+	len = code->len;
+	n_steps = len + ((code->term == CONV_TERM_FLUSH) ? (code->K - 1) : 0);
+
+	/* Work memory, metrics first to keep them aligned */
+	sz_ae  = 2 * ns * W * sizeof(int16_t);
+	sz_bm  = n_steps * (N + 2) * W * sizeof(int16_t);
+	sz_dec = n_steps * ns * sizeof(uint32_t);
+
+	mem = _vit_ws_get(sz_ae + sz_bm + sz_dec + ns + n_steps);
+	if (!mem)
+		return -ENOMEM;
+
+	vb->n_states = ns;
+	vb->N        = N;
+	vb->W        = W;
+	vb->bm       = (int16_t *)((uint8_t *)mem + sz_ae);
+	vb->dec      = (uint32_t *)((uint8_t *)mem + sz_ae + sz_bm);
+	vb->out0     = (uint8_t *)mem + sz_ae + sz_bm + sz_dec;
+	live         = _vit_live(code, vb->out0 + ns, n_steps);
+
+	for (s=0; s<ns; s++)
+		vb->out0[s] = code->next_output[s][0];
+
+	/* Output o differs from o & (o-1) by its lowest bit set, which is
+	 * bit N-1-j of the output, with delta j stored at index 2+j */
+	for (o=1; o<(1<<N); o++) {
+		for (i=0; !(o & (1 << i)); i++);
+		vb->bmt_d[o] = 2 + (N - 1 - i);
+	}
+
+	/* Process the frames by groups of W */
+	for (g=0; g<n; g+=W)
+	{
+		int nl = (n - g) < W ? (n - g) : W;
+
+		vb->ae      = (int16_t *)mem;
+		vb->ae_next = (int16_t *)mem + ns * W;
+
+		/* Unused lanes just duplicate the first frame */
+		for (l=0; l<W; l++)
+			_vit_branch_metrics(code, input[g + (l < nl ? l : 0)],
+			                    live, &vb->bm[l], n_steps, W);
+
+		/* Initial state (see gmr1_conv_decode) */
+		for (s=0; s<ns; s++)
+			for (l=0; l<W; l++)
+				vb->ae[s * W + l] = s ? VIT_UNREACH : 0;
+		memset(vb->offset, 0x00, sizeof(vb->offset));
+
+		if (code->term == CONV_TERM_TAIL_BITING) {
+			fn(vb, 0, len, 0);
+
+			for (l=0; l<W; l++) {
+				int min_ae = vb->ae[l];
+				for (s=1; s<ns; s++)
+					if (vb->ae[s * W + l] < min_ae)
+						min_ae = vb->ae[s * W + l];
+				vb->offset[l] = -min_ae;
+			}
+		}
+
+		/* Run the trellis */
+		fn(vb, 0, len, 0);
+
+		if (code->term == CONV_TERM_FLUSH)
+			fn(vb, len, n_steps, 1);
+
+		/* End state and traceback of each frame */
+		for (l=0; l<nl; l++)
+		{
+			ubit_t *out = output[g + l];
+			int min_s = 0, min_ae = vb->ae[l];
+
+			if (code->term != CONV_TERM_FLUSH) {
+				for (s=1; s<ns; s++) {
+					if (vb->ae[s * W + l] < min_ae) {
+						min_ae = vb->ae[s * W + l];
+						min_s = s;
+					}
+				}
+			}
+
+			if (rv)
+				rv[g + l] = min_ae + vb->offset[l];
+
+			s = min_s;
+
+			for (i=n_steps-1; i>=len; i--)
+				s = _vitb_prev(vb, i, s, l);
+
+			for (i=len-1; i>=0; i--) {
+				out[i] = s & 1;
+				s = _vitb_prev(vb, i, s, l);
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*! @} */
@@ -0,0 +1,684 @@
+/* Generated by gen_conv_spec, do not edit */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <osmocom/core/conv.h>
+
+#include "private.h"
+
+
+static const uint8_t gmr1_conv_k5_12_next_output[][2] = {
+	{   0,   3 }, {   1,   2 }, {   1,   2 }, {   0,   3 },
+	{   2,   1 }, {   3,   0 }, {   3,   0 }, {   2,   1 },
+	{   3,   0 }, {   2,   1 }, {   2,   1 }, {   3,   0 },
+	{   1,   2 }, {   0,   3 }, {   0,   3 }, {   1,   2 },
+};
+
+static const uint8_t gmr1_conv_k5_12_next_state[][2] = {
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+};
+
+static const uint8_t gmr1_conv_k5_14_next_output[][2] = {
+	{   0,  15 }, {   5,  10 }, {   7,   8 }, {   2,  13 },
+	{   9,   6 }, {  12,   3 }, {  14,   1 }, {  11,   4 },
+	{  15,   0 }, {  10,   5 }, {   8,   7 }, {  13,   2 },
+	{   6,   9 }, {   3,  12 }, {   1,  14 }, {   4,  11 },
+};
+
+static const uint8_t gmr1_conv_k5_14_next_state[][2] = {
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+};
+
+static const uint8_t gmr1_conv_tch3_next_output[][2] = {
+	{   0,   3 }, {   1,   2 }, {   3,   0 }, {   2,   1 },
+	{   3,   0 }, {   2,   1 }, {   0,   3 }, {   1,   2 },
+	{   0,   3 }, {   1,   2 }, {   3,   0 }, {   2,   1 },
+	{   3,   0 }, {   2,   1 }, {   0,   3 }, {   1,   2 },
+	{   2,   1 }, {   3,   0 }, {   1,   2 }, {   0,   3 },
+	{   1,   2 }, {   0,   3 }, {   2,   1 }, {   3,   0 },
+	{   2,   1 }, {   3,   0 }, {   1,   2 }, {   0,   3 },
+	{   1,   2 }, {   0,   3 }, {   2,   1 }, {   3,   0 },
+	{   3,   0 }, {   2,   1 }, {   0,   3 }, {   1,   2 },
+	{   0,   3 }, {   1,   2 }, {   3,   0 }, {   2,   1 },
+	{   3,   0 }, {   2,   1 }, {   0,   3 }, {   1,   2 },
+	{   0,   3 }, {   1,   2 }, {   3,   0 }, {   2,   1 },
+	{   1,   2 }, {   0,   3 }, {   2,   1 }, {   3,   0 },
+	{   2,   1 }, {   3,   0 }, {   1,   2 }, {   0,   3 },
+	{   1,   2 }, {   0,   3 }, {   2,   1 }, {   3,   0 },
+	{   2,   1 }, {   3,   0 }, {   1,   2 }, {   0,   3 },
+};
+
+static const uint8_t gmr1_conv_tch3_next_state[][2] = {
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{  16,  17 }, {  18,  19 }, {  20,  21 }, {  22,  23 },
+	{  24,  25 }, {  26,  27 }, {  28,  29 }, {  30,  31 },
+	{  32,  33 }, {  34,  35 }, {  36,  37 }, {  38,  39 },
+	{  40,  41 }, {  42,  43 }, {  44,  45 }, {  46,  47 },
+	{  48,  49 }, {  50,  51 }, {  52,  53 }, {  54,  55 },
+	{  56,  57 }, {  58,  59 }, {  60,  61 }, {  62,  63 },
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{  16,  17 }, {  18,  19 }, {  20,  21 }, {  22,  23 },
+	{  24,  25 }, {  26,  27 }, {  28,  29 }, {  30,  31 },
+	{  32,  33 }, {  34,  35 }, {  36,  37 }, {  38,  39 },
+	{  40,  41 }, {  42,  43 }, {  44,  45 }, {  46,  47 },
+	{  48,  49 }, {  50,  51 }, {  52,  53 }, {  54,  55 },
+	{  56,  57 }, {  58,  59 }, {  60,  61 }, {  62,  63 },
+};
+
+static const uint8_t gmr1_conv_k5_15_next_output[][2] = {
+	{   0,  31 }, {  13,  18 }, {  23,   8 }, {  26,   5 },
+	{  14,  17 }, {   3,  28 }, {  25,   6 }, {  20,  11 },
+	{  31,   0 }, {  18,  13 }, {   8,  23 }, {   5,  26 },
+	{  17,  14 }, {  28,   3 }, {   6,  25 }, {  11,  20 },
+};
+
+static const uint8_t gmr1_conv_k5_15_next_state[][2] = {
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+};
+
+static const uint8_t gmr1_conv_k5_13_next_output[][2] = {
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+};
+
+static const uint8_t gmr1_conv_k5_13_next_state[][2] = {
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+};
+
+static const uint8_t gmr1_conv_k9_13_next_output[][2] = {
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   6,   1 }, {   5,   2 }, {   3,   4 }, {   0,   7 },
+	{   2,   5 }, {   1,   6 }, {   7,   0 }, {   4,   3 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+	{   5,   2 }, {   6,   1 }, {   0,   7 }, {   3,   4 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   1,   6 }, {   2,   5 }, {   4,   3 }, {   7,   0 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+	{   2,   5 }, {   1,   6 }, {   7,   0 }, {   4,   3 },
+	{   6,   1 }, {   5,   2 }, {   3,   4 }, {   0,   7 },
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   1,   6 }, {   2,   5 }, {   4,   3 }, {   7,   0 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   5,   2 }, {   6,   1 }, {   0,   7 }, {   3,   4 },
+	{   6,   1 }, {   5,   2 }, {   3,   4 }, {   0,   7 },
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+	{   2,   5 }, {   1,   6 }, {   7,   0 }, {   4,   3 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   5,   2 }, {   6,   1 }, {   0,   7 }, {   3,   4 },
+	{   1,   6 }, {   2,   5 }, {   4,   3 }, {   7,   0 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   2,   5 }, {   1,   6 }, {   7,   0 }, {   4,   3 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   6,   1 }, {   5,   2 }, {   3,   4 }, {   0,   7 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   1,   6 }, {   2,   5 }, {   4,   3 }, {   7,   0 },
+	{   5,   2 }, {   6,   1 }, {   0,   7 }, {   3,   4 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   1,   6 }, {   2,   5 }, {   4,   3 }, {   7,   0 },
+	{   5,   2 }, {   6,   1 }, {   0,   7 }, {   3,   4 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   2,   5 }, {   1,   6 }, {   7,   0 }, {   4,   3 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   6,   1 }, {   5,   2 }, {   3,   4 }, {   0,   7 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   5,   2 }, {   6,   1 }, {   0,   7 }, {   3,   4 },
+	{   1,   6 }, {   2,   5 }, {   4,   3 }, {   7,   0 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   6,   1 }, {   5,   2 }, {   3,   4 }, {   0,   7 },
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+	{   2,   5 }, {   1,   6 }, {   7,   0 }, {   4,   3 },
+	{   1,   6 }, {   2,   5 }, {   4,   3 }, {   7,   0 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   5,   2 }, {   6,   1 }, {   0,   7 }, {   3,   4 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+	{   2,   5 }, {   1,   6 }, {   7,   0 }, {   4,   3 },
+	{   6,   1 }, {   5,   2 }, {   3,   4 }, {   0,   7 },
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   5,   2 }, {   6,   1 }, {   0,   7 }, {   3,   4 },
+	{   3,   4 }, {   0,   7 }, {   6,   1 }, {   5,   2 },
+	{   7,   0 }, {   4,   3 }, {   2,   5 }, {   1,   6 },
+	{   1,   6 }, {   2,   5 }, {   4,   3 }, {   7,   0 },
+	{   0,   7 }, {   3,   4 }, {   5,   2 }, {   6,   1 },
+	{   6,   1 }, {   5,   2 }, {   3,   4 }, {   0,   7 },
+	{   2,   5 }, {   1,   6 }, {   7,   0 }, {   4,   3 },
+	{   4,   3 }, {   7,   0 }, {   1,   6 }, {   2,   5 },
+};
+
+static const uint8_t gmr1_conv_k9_13_next_state[][2] = {
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{  16,  17 }, {  18,  19 }, {  20,  21 }, {  22,  23 },
+	{  24,  25 }, {  26,  27 }, {  28,  29 }, {  30,  31 },
+	{  32,  33 }, {  34,  35 }, {  36,  37 }, {  38,  39 },
+	{  40,  41 }, {  42,  43 }, {  44,  45 }, {  46,  47 },
+	{  48,  49 }, {  50,  51 }, {  52,  53 }, {  54,  55 },
+	{  56,  57 }, {  58,  59 }, {  60,  61 }, {  62,  63 },
+	{  64,  65 }, {  66,  67 }, {  68,  69 }, {  70,  71 },
+	{  72,  73 }, {  74,  75 }, {  76,  77 }, {  78,  79 },
+	{  80,  81 }, {  82,  83 }, {  84,  85 }, {  86,  87 },
+	{  88,  89 }, {  90,  91 }, {  92,  93 }, {  94,  95 },
+	{  96,  97 }, {  98,  99 }, { 100, 101 }, { 102, 103 },
+	{ 104, 105 }, { 106, 107 }, { 108, 109 }, { 110, 111 },
+	{ 112, 113 }, { 114, 115 }, { 116, 117 }, { 118, 119 },
+	{ 120, 121 }, { 122, 123 }, { 124, 125 }, { 126, 127 },
+	{ 128, 129 }, { 130, 131 }, { 132, 133 }, { 134, 135 },
+	{ 136, 137 }, { 138, 139 }, { 140, 141 }, { 142, 143 },
+	{ 144, 145 }, { 146, 147 }, { 148, 149 }, { 150, 151 },
+	{ 152, 153 }, { 154, 155 }, { 156, 157 }, { 158, 159 },
+	{ 160, 161 }, { 162, 163 }, { 164, 165 }, { 166, 167 },
+	{ 168, 169 }, { 170, 171 }, { 172, 173 }, { 174, 175 },
+	{ 176, 177 }, { 178, 179 }, { 180, 181 }, { 182, 183 },
+	{ 184, 185 }, { 186, 187 }, { 188, 189 }, { 190, 191 },
+	{ 192, 193 }, { 194, 195 }, { 196, 197 }, { 198, 199 },
+	{ 200, 201 }, { 202, 203 }, { 204, 205 }, { 206, 207 },
+	{ 208, 209 }, { 210, 211 }, { 212, 213 }, { 214, 215 },
+	{ 216, 217 }, { 218, 219 }, { 220, 221 }, { 222, 223 },
+	{ 224, 225 }, { 226, 227 }, { 228, 229 }, { 230, 231 },
+	{ 232, 233 }, { 234, 235 }, { 236, 237 }, { 238, 239 },
+	{ 240, 241 }, { 242, 243 }, { 244, 245 }, { 246, 247 },
+	{ 248, 249 }, { 250, 251 }, { 252, 253 }, { 254, 255 },
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{  16,  17 }, {  18,  19 }, {  20,  21 }, {  22,  23 },
+	{  24,  25 }, {  26,  27 }, {  28,  29 }, {  30,  31 },
+	{  32,  33 }, {  34,  35 }, {  36,  37 }, {  38,  39 },
+	{  40,  41 }, {  42,  43 }, {  44,  45 }, {  46,  47 },
+	{  48,  49 }, {  50,  51 }, {  52,  53 }, {  54,  55 },
+	{  56,  57 }, {  58,  59 }, {  60,  61 }, {  62,  63 },
+	{  64,  65 }, {  66,  67 }, {  68,  69 }, {  70,  71 },
+	{  72,  73 }, {  74,  75 }, {  76,  77 }, {  78,  79 },
+	{  80,  81 }, {  82,  83 }, {  84,  85 }, {  86,  87 },
+	{  88,  89 }, {  90,  91 }, {  92,  93 }, {  94,  95 },
+	{  96,  97 }, {  98,  99 }, { 100, 101 }, { 102, 103 },
+	{ 104, 105 }, { 106, 107 }, { 108, 109 }, { 110, 111 },
+	{ 112, 113 }, { 114, 115 }, { 116, 117 }, { 118, 119 },
+	{ 120, 121 }, { 122, 123 }, { 124, 125 }, { 126, 127 },
+	{ 128, 129 }, { 130, 131 }, { 132, 133 }, { 134, 135 },
+	{ 136, 137 }, { 138, 139 }, { 140, 141 }, { 142, 143 },
+	{ 144, 145 }, { 146, 147 }, { 148, 149 }, { 150, 151 },
+	{ 152, 153 }, { 154, 155 }, { 156, 157 }, { 158, 159 },
+	{ 160, 161 }, { 162, 163 }, { 164, 165 }, { 166, 167 },
+	{ 168, 169 }, { 170, 171 }, { 172, 173 }, { 174, 175 },
+	{ 176, 177 }, { 178, 179 }, { 180, 181 }, { 182, 183 },
+	{ 184, 185 }, { 186, 187 }, { 188, 189 }, { 190, 191 },
+	{ 192, 193 }, { 194, 195 }, { 196, 197 }, { 198, 199 },
+	{ 200, 201 }, { 202, 203 }, { 204, 205 }, { 206, 207 },
+	{ 208, 209 }, { 210, 211 }, { 212, 213 }, { 214, 215 },
+	{ 216, 217 }, { 218, 219 }, { 220, 221 }, { 222, 223 },
+	{ 224, 225 }, { 226, 227 }, { 228, 229 }, { 230, 231 },
+	{ 232, 233 }, { 234, 235 }, { 236, 237 }, { 238, 239 },
+	{ 240, 241 }, { 242, 243 }, { 244, 245 }, { 246, 247 },
+	{ 248, 249 }, { 250, 251 }, { 252, 253 }, { 254, 255 },
+};
+
+
+/*! \brief GMR-1 bcch convolutional code */
+const struct osmo_conv_code gmr1_conv_bcch = {
+	.N = 2,
+	.K = 5,
+	.len = 208,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_conv_k5_12_next_output,
+	.next_state  = gmr1_conv_k5_12_next_state,
+};
+
+/*! \brief GMR-1 ccch convolutional code */
+const struct osmo_conv_code gmr1_conv_ccch = {
+	.N = 2,
+	.K = 5,
+	.len = 208,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_conv_k5_12_next_output,
+	.next_state  = gmr1_conv_k5_12_next_state,
+};
+
+/*! \brief GMR-1 facch3 convolutional code */
+const struct osmo_conv_code gmr1_conv_facch3 = {
+	.N = 4,
+	.K = 5,
+	.len = 92,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_conv_k5_14_next_output,
+	.next_state  = gmr1_conv_k5_14_next_state,
+};
+
+/*! \brief GMR-1 facch9 convolutional code */
+const struct osmo_conv_code gmr1_conv_facch9 = {
+	.N = 2,
+	.K = 5,
+	.len = 316,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_conv_k5_12_next_output,
+	.next_state  = gmr1_conv_k5_12_next_state,
+};
+
+static const int gmr1_conv_rach_puncture[] = {
+	   2,    3,    6,    7,   10,   11,   14,   15,
+	  18,   19,   22,   23,   26,   27,   30,   31,
+	  34,   35,   38,   39,   42,   43,   46,   47,
+	  50,   51,   54,   55,   58,   59,   62,   63,
+	  66,   67,   70,   71,   74,   75,   78,   79,
+	  82,   83,   86,   87,   90,   91,   94,   95,
+	  98,   99,  102,  103,  106,  107,  110,  111,
+	 114,  115,  118,  119,  122,  123,  126,  127,
+	 130,  131,  134,  135,  138,  139,  142,  143,
+	 146,  147,  150,  151,  154,  155,  158,  159,
+	 162,  163,  166,  167,  170,  171,  174,  175,
+	 178,  179,  182,  183,  186,  187,  190,  191,
+	 194,  195,  198,  199,  202,  203,  206,  207,
+	 210,  211,  214,  215,  218,  219,  222,  223,
+	 226,  227,  230,  231,  234,  235,  238,  239,
+	 242,  243,  246,  247,  250,  251,  254,  255,
+	 258,  259,  262,  263,  266,  267,  270,  271,
+	 274,  275,  278,  279,  282,  283,  286,  287,
+	 290,  291,  294,  295,  298,  299,  302,  303,
+	 306,  307,  310,  311,  314,  315,  318,  319,
+	 322,  323,  326,  327,  330,  331,  334,  335,
+	 338,  339,  342,  343,  346,  347,  350,  351,
+	 354,  355,  358,  359,  362,  363,  366,  367,
+	 370,  371,  374,  375,  378,  379,  382,  383,
+	 386,  387,  390,  391,  394,  395,  398,  399,
+	 402,  403,  406,  407,  410,  411,  414,  415,
+	 418,  419,  422,  423,  426,  427,  430,  431,
+	 434,  435,  438,  439,  442,  443,  446,  447,
+	 450,  451,  454,  455,  458,  459,  462,  463,
+	 466,  467,  470,  471,  474,  475,  478,  479,
+	 482,  483,  486,  487,  490,  491,  494,  495,
+	 498,  499,  502,  503,  506,  507,  510,  511,
+	 514,  515,  518,  519,  522,  523,  526,  527,
+	 530,  531,  534,  535,  538,  539,
+	-1,
+};
+
+static const uint8_t gmr1_conv_rach_live[] = {
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   3,  15,
+	 15,  15,  15,  15,  15,  15,  15,  15,
+	 15,  15,  15,  15,  15,  15,  15,  15,
+	 15,  15,  15,  15,  15,  15,  15,  15,
+	 15,  15,  15,
+};
+
+/*! \brief GMR-1 rach convolutional code */
+const struct osmo_conv_code gmr1_conv_rach = {
+	.N = 4,
+	.K = 5,
+	.len = 159,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_conv_k5_14_next_output,
+	.next_state  = gmr1_conv_k5_14_next_state,
+	.puncture = gmr1_conv_rach_puncture,
+};
+
+static const int gmr1_conv_tch3_speech_puncture[] = {
+	   3,    7,   11,   15,   19,   23,   27,   31,
+	  35,   39,   43,   47,   51,   55,   59,   63,
+	  67,   71,   75,   79,   83,   87,   91,   95,
+	-1,
+};
+
+static const uint8_t gmr1_conv_tch3_speech_live[] = {
+	  3,   1,   3,   1,   3,   1,   3,   1,
+	  3,   1,   3,   1,   3,   1,   3,   1,
+	  3,   1,   3,   1,   3,   1,   3,   1,
+	  3,   1,   3,   1,   3,   1,   3,   1,
+	  3,   1,   3,   1,   3,   1,   3,   1,
+	  3,   1,   3,   1,   3,   1,   3,   1,
+};
+
+/*! \brief GMR-1 tch3_speech convolutional code */
+const struct osmo_conv_code gmr1_conv_tch3_speech = {
+	.N = 2,
+	.K = 7,
+	.len = 48,
+	.term = CONV_TERM_TAIL_BITING,
+	.next_output = gmr1_conv_tch3_next_output,
+	.next_state  = gmr1_conv_tch3_next_state,
+	.puncture = gmr1_conv_tch3_speech_puncture,
+};
+
+static const int gmr1_conv_tch9_24_puncture[] = {
+	   3,    6,    7,   13,   14,   22,   29,   37,
+	  44,   52,   59,   67,   74,   82,   89,   97,
+	 104,  112,  119,  127,  134,  142,  149,  157,
+	 164,  172,  179,  187,  194,  202,  209,  217,
+	 224,  232,  239,  247,  254,  262,  269,  277,
+	 284,  292,  299,  307,  314,  322,  329,  337,
+	 344,  352,  359,  367,  374,  382,  389,  397,
+	 404,  412,  419,  427,  434,  442,  449,  457,
+	 464,  472,  479,  487,  494,  502,  509,  517,
+	 524,  532,  539,  547,  554,  562,  569,  577,
+	 584,  592,  599,  607,  614,  622,  629,  728,
+	 729,  731,  732,  738,
+	-1,
+};
+
+static const uint8_t gmr1_conv_tch9_24_live[] = {
+	 23,  25,   7,  31,  27,  15,  31,  27,
+	 15,  31,  27,  15,  31,  27,  15,  31,
+	 27,  15,  31,  27,  15,  31,  27,  15,
+	 31,  27,  15,  31,  27,  15,  31,  27,
+	 15,  31,  27,  15,  31,  27,  15,  31,
+	 27,  15,  31,  27,  15,  31,  27,  15,
+	 31,  27,  15,  31,  27,  15,  31,  27,
+	 15,  31,  27,  15,  31,  27,  15,  31,
+	 27,  15,  31,  27,  15,  31,  27,  15,
+	 31,  27,  15,  31,  27,  15,  31,  27,
+	 15,  31,  27,  15,  31,  27,  15,  31,
+	 27,  15,  31,  27,  15,  31,  27,  15,
+	 31,  27,  15,  31,  27,  15,  31,  27,
+	 15,  31,  27,  15,  31,  27,  15,  31,
+	 27,  15,  31,  27,  15,  31,  27,  15,
+	 31,  27,  15,  31,  27,  15,  31,  31,
+	 31,  31,  31,  31,  31,  31,  31,  31,
+	 31,  31,  31,  31,  31,  31,  31,  31,
+	 31,   7,  25,  23,
+};
+
+/*! \brief GMR-1 tch9_24 convolutional code */
+const struct osmo_conv_code gmr1_conv_tch9_24 = {
+	.N = 5,
+	.K = 5,
+	.len = 144,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_conv_k5_15_next_output,
+	.next_state  = gmr1_conv_k5_15_next_state,
+	.puncture = gmr1_conv_tch9_24_puncture,
+};
+
+static const int gmr1_conv_tch9_48_puncture[] = {
+	   1,   22,   28,   37,   43,   52,   58,   67,
+	  73,   82,   88,   97,  103,  112,  118,  127,
+	 133,  142,  148,  157,  163,  172,  178,  187,
+	 193,  202,  208,  217,  223,  232,  238,  247,
+	 253,  262,  268,  277,  283,  292,  298,  307,
+	 313,  322,  328,  337,  343,  352,  358,  367,
+	 373,  382,  388,  397,  403,  412,  418,  427,
+	 433,  442,  448,  457,  463,  472,  478,  487,
+	 493,  502,  508,  517,  523,  532,  538,  547,
+	 553,  562,  568,  577,  583,  592,  598,  607,
+	 613,  622,  628,  730,
+	-1,
+};
+
+static const uint8_t gmr1_conv_tch9_48_live[] = {
+	  5,   7,   7,   7,   7,   7,   7,   5,
+	  7,   5,   7,   7,   5,   7,   5,   7,
+	  7,   5,   7,   5,   7,   7,   5,   7,
+	  5,   7,   7,   5,   7,   5,   7,   7,
+	  5,   7,   5,   7,   7,   5,   7,   5,
+	  7,   7,   5,   7,   5,   7,   7,   5,
+	  7,   5,   7,   7,   5,   7,   5,   7,
+	  7,   5,   7,   5,   7,   7,   5,   7,
+	  5,   7,   7,   5,   7,   5,   7,   7,
+	  5,   7,   5,   7,   7,   5,   7,   5,
+	  7,   7,   5,   7,   5,   7,   7,   5,
+	  7,   5,   7,   7,   5,   7,   5,   7,
+	  7,   5,   7,   5,   7,   7,   5,   7,
+	  5,   7,   7,   5,   7,   5,   7,   7,
+	  5,   7,   5,   7,   7,   5,   7,   5,
+	  7,   7,   5,   7,   5,   7,   7,   5,
+	  7,   5,   7,   7,   5,   7,   5,   7,
+	  7,   5,   7,   5,   7,   7,   5,   7,
+	  5,   7,   7,   5,   7,   5,   7,   7,
+	  5,   7,   5,   7,   7,   5,   7,   5,
+	  7,   7,   5,   7,   5,   7,   7,   5,
+	  7,   5,   7,   7,   5,   7,   5,   7,
+	  7,   5,   7,   5,   7,   7,   5,   7,
+	  5,   7,   7,   5,   7,   5,   7,   7,
+	  5,   7,   5,   7,   7,   5,   7,   5,
+	  7,   7,   5,   7,   5,   7,   7,   5,
+	  7,   5,   7,   7,   7,   7,   7,   7,
+	  7,   7,   7,   7,   7,   7,   7,   7,
+	  7,   7,   7,   7,   7,   7,   7,   7,
+	  7,   7,   7,   7,   7,   7,   7,   7,
+	  7,   7,   7,   5,
+};
+
+/*! \brief GMR-1 tch9_48 convolutional code */
+const struct osmo_conv_code gmr1_conv_tch9_48 = {
+	.N = 3,
+	.K = 5,
+	.len = 240,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_conv_k5_13_next_output,
+	.next_state  = gmr1_conv_k5_13_next_state,
+	.puncture = gmr1_conv_tch9_48_puncture,
+};
+
+static const int gmr1_conv_tch9_96_puncture[] = {
+	   1,    5,   10,   13,   16,   19,   22,   25,
+	  28,   31,   34,   37,   40,   43,   46,   49,
+	  52,   55,   58,   61,   64,   67,   70,   73,
+	  76,   79,   82,   85,   88,   91,   94,   97,
+	 100,  103,  106,  109,  112,  115,  118,  121,
+	 124,  127,  130,  133,  136,  139,  142,  145,
+	 148,  151,  154,  157,  160,  163,  166,  169,
+	 172,  175,  178,  181,  184,  187,  190,  193,
+	 196,  199,  202,  205,  208,  211,  214,  217,
+	 220,  223,  226,  229,  232,  235,  238,  241,
+	 244,  247,  250,  253,  256,  259,  262,  265,
+	 268,  271,  274,  277,  280,  283,  286,  289,
+	 292,  295,  298,  301,  304,  307,  310,  313,
+	 316,  319,  322,  325,  328,  331,  334,  337,
+	 340,  343,  346,  349,  352,  355,  358,  361,
+	 364,  367,  370,  373,  376,  379,  382,  385,
+	 388,  391,  394,  397,  400,  403,  406,  409,
+	 412,  415,  418,  421,  424,  427,  430,  433,
+	 436,  439,  442,  445,  448,  451,  454,  457,
+	 460,  463,  466,  469,  472,  475,  478,  481,
+	 484,  487,  490,  493,  496,  499,  502,  505,
+	 508,  511,  514,  517,  520,  523,  526,  529,
+	 532,  535,  538,  541,  544,  547,  550,  553,
+	 556,  559,  562,  565,  568,  571,  574,  577,
+	 580,  583,  586,  589,  592,  595,  598,  601,
+	 604,  607,  610,  613,  616,  619,  622,  625,
+	 628,  631,  634,  637,  640,  643,  646,  649,
+	 652,  655,  658,  661,  664,  667,  670,  673,
+	 676,  679,  682,  685,  688,  691,  694,  697,
+	 700,  703,  706,  709,  712,  715,  718,  721,
+	 724,  727,  730,  733,  736,  739,  742,  745,
+	 748,  751,  754,  757,  760,  763,  766,  769,
+	 772,  775,  778,  781,  784,  787,  790,  793,
+	 796,  799,  802,  805,  808,  811,  814,  817,
+	 820,  823,  826,  829,  832,  835,  838,  841,
+	 844,  847,  850,  853,  856,  859,  862,  865,
+	 868,  871,  874,  877,  880,  883,  886,  889,
+	 892,  895,  898,  901,  904,  907,  910,  913,
+	 916,  919,  922,  925,  928,  931,  934,  937,
+	 940,  943,  946,  949,  952,  955,  963,  967,
+	-1,
+};
+
+static const uint8_t gmr1_conv_tch9_96_live[] = {
+	  1,   3,   1,   3,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   2,
+	  1,   3,   2,   1,   3,   2,   1,   3,
+	  2,   1,   3,   2,   1,   3,   2,   1,
+	  3,   2,   1,   3,   2,   1,   3,   3,
+	  3,   1,   3,   1,
+};
+
+/*! \brief GMR-1 tch9_96 convolutional code */
+const struct osmo_conv_code gmr1_conv_tch9_96 = {
+	.N = 2,
+	.K = 5,
+	.len = 480,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_conv_k5_12_next_output,
+	.next_state  = gmr1_conv_k5_12_next_state,
+	.puncture = gmr1_conv_tch9_96_puncture,
+};
+
+static const int gmr1_conv_xch_dc12_puncture[] = {
+	   2,    4,    6,   11,   13,   15,   20,   22,
+	  24,   29,   31,   33,   41,   43,   45,   50,
+	  52,   54,   59,   61,   63,   68,   70,   72,
+	  80,   82,   84,   89,   91,   93,   98,  100,
+	 102,  107,  109,  111,  119,  121,  123,  128,
+	 130,  132,  137,  139,  141,  146,  148,  150,
+	 158,  160,  162,  167,  169,  171,  176,  178,
+	 180,  185,  187,  189,  197,  199,  201,  206,
+	 208,  210,  215,  217,  219,  224,  226,  228,
+	 236,  238,  240,  245,  247,  249,  254,  256,
+	 258,  263,  265,  267,  275,  277,  279,  284,
+	 286,  288,  293,  295,  297,  302,  304,  306,
+	 314,  316,  318,  323,  325,  327,  332,  334,
+	 336,  341,  343,  345,  353,  355,  357,  362,
+	 364,  366,  371,  373,  375,  380,  382,  384,
+	 392,  394,  396,  401,  403,  405,  410,  412,
+	 414,  419,  421,  423,  431,  433,  435,  440,
+	 442,  444,  449,  451,  453,  458,  460,  462,
+	 470,  472,  474,  479,  481,  483,  488,  490,
+	 492,  497,  499,  501,  509,  511,  513,  518,
+	 520,  522,  527,  529,  531,  536,  538,  540,
+	 548,  550,  552,  557,  559,  561,  566,  568,
+	 570,  575,  577,  579,  587,  589,  591,  596,
+	 598,  600,  605,  607,  609,  614,  616,  618,
+	-1,
+};
+
+static const uint8_t gmr1_conv_xch_dc12_live[] = {
+	  3,   5,   6,   3,   5,   6,   3,   5,
+	  6,   3,   5,   6,   7,   3,   5,   6,
+	  3,   5,   6,   3,   5,   6,   3,   5,
+	  6,   7,   3,   5,   6,   3,   5,   6,
+	  3,   5,   6,   3,   5,   6,   7,   3,
+	  5,   6,   3,   5,   6,   3,   5,   6,
+	  3,   5,   6,   7,   3,   5,   6,   3,
+	  5,   6,   3,   5,   6,   3,   5,   6,
+	  7,   3,   5,   6,   3,   5,   6,   3,
+	  5,   6,   3,   5,   6,   7,   3,   5,
+	  6,   3,   5,   6,   3,   5,   6,   3,
+	  5,   6,   7,   3,   5,   6,   3,   5,
+	  6,   3,   5,   6,   3,   5,   6,   7,
+	  3,   5,   6,   3,   5,   6,   3,   5,
+	  6,   3,   5,   6,   7,   3,   5,   6,
+	  3,   5,   6,   3,   5,   6,   3,   5,
+	  6,   7,   3,   5,   6,   3,   5,   6,
+	  3,   5,   6,   3,   5,   6,   7,   3,
+	  5,   6,   3,   5,   6,   3,   5,   6,
+	  3,   5,   6,   7,   3,   5,   6,   3,
+	  5,   6,   3,   5,   6,   3,   5,   6,
+	  7,   3,   5,   6,   3,   5,   6,   3,
+	  5,   6,   3,   5,   6,   7,   3,   5,
+	  6,   3,   5,   6,   3,   5,   6,   3,
+	  5,   6,   7,   3,   5,   6,   3,   5,
+	  6,   3,   5,   6,   3,   5,   6,   7,
+};
+
+/*! \brief GMR-1 xch_dc12 convolutional code */
+const struct osmo_conv_code gmr1_conv_xch_dc12 = {
+	.N = 3,
+	.K = 9,
+	.len = 208,
+	.term = CONV_TERM_TAIL_BITING,
+	.next_output = gmr1_conv_k9_13_next_output,
+	.next_state  = gmr1_conv_k9_13_next_state,
+	.puncture = gmr1_conv_xch_dc12_puncture,
+};
+
+const struct gmr1_conv_live gmr1_conv_live[] = {
+	{ &gmr1_conv_rach, gmr1_conv_rach_live },
+	{ &gmr1_conv_tch3_speech, gmr1_conv_tch3_speech_live },
+	{ &gmr1_conv_tch9_24, gmr1_conv_tch9_24_live },
+	{ &gmr1_conv_tch9_48, gmr1_conv_tch9_48_live },
+	{ &gmr1_conv_tch9_96, gmr1_conv_tch9_96_live },
+	{ &gmr1_conv_xch_dc12, gmr1_conv_xch_dc12_live },
+	{ NULL, NULL },
+};
@@ -31,6 +31,8 @@
 #include <osmocom/core/bits.h>
 #include <osmocom/core/crcgen.h>
 
+#include <osmocom/gmr1/l1/crc.h>
+
 
 /*! \brief GMR-1 CRC8
  *  g8(D) = D8 + D7 + D4 + D3 + D + 1
@@ -62,4 +64,223 @@ const struct osmo_crc16gen_code gmr1_crc16 = {
 	.remainder = 0x0000,
 };
 
+/*! \brief GMR-1 CRC8, table driven version of \ref gmr1_crc8 */
+const struct gmr1_crc_table gmr1_crc8_table = {
+	.bits = 8,
+	.poly = 0x00d9,
+	.init = 0x0000,
+	.remainder = 0x0000,
+	.table = {
+		0x0000, 0x00d0, 0x0013, 0x00c3, 0x0026, 0x00f6, 0x0035, 0x00e5,
+		0x004c, 0x009c, 0x005f, 0x008f, 0x006a, 0x00ba, 0x0079, 0x00a9,
+		0x0098, 0x0048, 0x008b, 0x005b, 0x00be, 0x006e, 0x00ad, 0x007d,
+		0x00d4, 0x0004, 0x00c7, 0x0017, 0x00f2, 0x0022, 0x00e1, 0x0031,
+		0x0083, 0x0053, 0x0090, 0x0040, 0x00a5, 0x0075, 0x00b6, 0x0066,
+		0x00cf, 0x001f, 0x00dc, 0x000c, 0x00e9, 0x0039, 0x00fa, 0x002a,
+		0x001b, 0x00cb, 0x0008, 0x00d8, 0x003d, 0x00ed, 0x002e, 0x00fe,
+		0x0057, 0x0087, 0x0044, 0x0094, 0x0071, 0x00a1, 0x0062, 0x00b2,
+		0x00b5, 0x0065, 0x00a6, 0x0076, 0x0093, 0x0043, 0x0080, 0x0050,
+		0x00f9, 0x0029, 0x00ea, 0x003a, 0x00df, 0x000f, 0x00cc, 0x001c,
+		0x002d, 0x00fd, 0x003e, 0x00ee, 0x000b, 0x00db, 0x0018, 0x00c8,
+		0x0061, 0x00b1, 0x0072, 0x00a2, 0x0047, 0x0097, 0x0054, 0x0084,
+		0x0036, 0x00e6, 0x0025, 0x00f5, 0x0010, 0x00c0, 0x0003, 0x00d3,
+		0x007a, 0x00aa, 0x0069, 0x00b9, 0x005c, 0x008c, 0x004f, 0x009f,
+		0x00ae, 0x007e, 0x00bd, 0x006d, 0x0088, 0x0058, 0x009b, 0x004b,
+		0x00e2, 0x0032, 0x00f1, 0x0021, 0x00c4, 0x0014, 0x00d7, 0x0007,
+		0x00d9, 0x0009, 0x00ca, 0x001a, 0x00ff, 0x002f, 0x00ec, 0x003c,
+		0x0095, 0x0045, 0x0086, 0x0056, 0x00b3, 0x0063, 0x00a0, 0x0070,
+		0x0041, 0x0091, 0x0052, 0x0082, 0x0067, 0x00b7, 0x0074, 0x00a4,
+		0x000d, 0x00dd, 0x001e, 0x00ce, 0x002b, 0x00fb, 0x0038, 0x00e8,
+		0x005a, 0x008a, 0x0049, 0x0099, 0x007c, 0x00ac, 0x006f, 0x00bf,
+		0x0016, 0x00c6, 0x0005, 0x00d5, 0x0030, 0x00e0, 0x0023, 0x00f3,
+		0x00c2, 0x0012, 0x00d1, 0x0001, 0x00e4, 0x0034, 0x00f7, 0x0027,
+		0x008e, 0x005e, 0x009d, 0x004d, 0x00a8, 0x0078, 0x00bb, 0x006b,
+		0x006c, 0x00bc, 0x007f, 0x00af, 0x004a, 0x009a, 0x0059, 0x0089,
+		0x0020, 0x00f0, 0x0033, 0x00e3, 0x0006, 0x00d6, 0x0015, 0x00c5,
+		0x00f4, 0x0024, 0x00e7, 0x0037, 0x00d2, 0x0002, 0x00c1, 0x0011,
+		0x00b8, 0x0068, 0x00ab, 0x007b, 0x009e, 0x004e, 0x008d, 0x005d,
+		0x00ef, 0x003f, 0x00fc, 0x002c, 0x00c9, 0x0019, 0x00da, 0x000a,
+		0x00a3, 0x0073, 0x00b0, 0x0060, 0x0085, 0x0055, 0x0096, 0x0046,
+		0x0077, 0x00a7, 0x0064, 0x00b4, 0x0051, 0x0081, 0x0042, 0x0092,
+		0x003b, 0x00eb, 0x0028, 0x00f8, 0x001d, 0x00cd, 0x000e, 0x00de,
+	},
+};
+
+/*! \brief GMR-1 CRC12, table driven version of \ref gmr1_crc12 */
+const struct gmr1_crc_table gmr1_crc12_table = {
+	.bits = 12,
+	.poly = 0x0f01,
+	.init = 0x0000,
+	.remainder = 0x0000,
+	.table = {
+		0x0000, 0x0a0b, 0x0a15, 0x001e, 0x0a29, 0x0022, 0x003c, 0x0a37,
+		0x0a51, 0x005a, 0x0044, 0x0a4f, 0x0078, 0x0a73, 0x0a6d, 0x0066,
+		0x0aa1, 0x00aa, 0x00b4, 0x0abf, 0x0088, 0x0a83, 0x0a9d, 0x0096,
+		0x00f0, 0x0afb, 0x0ae5, 0x00ee, 0x0ad9, 0x00d2, 0x00cc, 0x0ac7,
+		0x0b41, 0x014a, 0x0154, 0x0b5f, 0x0168, 0x0b63, 0x0b7d, 0x0176,
+		0x0110, 0x0b1b, 0x0b05, 0x010e, 0x0b39, 0x0132, 0x012c, 0x0b27,
+		0x01e0, 0x0beb, 0x0bf5, 0x01fe, 0x0bc9, 0x01c2, 0x01dc, 0x0bd7,
+		0x0bb1, 0x01ba, 0x01a4, 0x0baf, 0x0198, 0x0b93, 0x0b8d, 0x0186,
+		0x0881, 0x028a, 0x0294, 0x089f, 0x02a8, 0x08a3, 0x08bd, 0x02b6,
+		0x02d0, 0x08db, 0x08c5, 0x02ce, 0x08f9, 0x02f2, 0x02ec, 0x08e7,
+		0x0220, 0x082b, 0x0835, 0x023e, 0x0809, 0x0202, 0x021c, 0x0817,
+		0x0871, 0x027a, 0x0264, 0x086f, 0x0258, 0x0853, 0x084d, 0x0246,
+		0x03c0, 0x09cb, 0x09d5, 0x03de, 0x09e9, 0x03e2, 0x03fc, 0x09f7,
+		0x0991, 0x039a, 0x0384, 0x098f, 0x03b8, 0x09b3, 0x09ad, 0x03a6,
+		0x0961, 0x036a, 0x0374, 0x097f, 0x0348, 0x0943, 0x095d, 0x0356,
+		0x0330, 0x093b, 0x0925, 0x032e, 0x0919, 0x0312, 0x030c, 0x0907,
+		0x0f01, 0x050a, 0x0514, 0x0f1f, 0x0528, 0x0f23, 0x0f3d, 0x0536,
+		0x0550, 0x0f5b, 0x0f45, 0x054e, 0x0f79, 0x0572, 0x056c, 0x0f67,
+		0x05a0, 0x0fab, 0x0fb5, 0x05be, 0x0f89, 0x0582, 0x059c, 0x0f97,
+		0x0ff1, 0x05fa, 0x05e4, 0x0fef, 0x05d8, 0x0fd3, 0x0fcd, 0x05c6,
+		0x0440, 0x0e4b, 0x0e55, 0x045e, 0x0e69, 0x0462, 0x047c, 0x0e77,
+		0x0e11, 0x041a, 0x0404, 0x0e0f, 0x0438, 0x0e33, 0x0e2d, 0x0426,
+		0x0ee1, 0x04ea, 0x04f4, 0x0eff, 0x04c8, 0x0ec3, 0x0edd, 0x04d6,
+		0x04b0, 0x0ebb, 0x0ea5, 0x04ae, 0x0e99, 0x0492, 0x048c, 0x0e87,
+		0x0780, 0x0d8b, 0x0d95, 0x079e, 0x0da9, 0x07a2, 0x07bc, 0x0db7,
+		0x0dd1, 0x07da, 0x07c4, 0x0dcf, 0x07f8, 0x0df3, 0x0ded, 0x07e6,
+		0x0d21, 0x072a, 0x0734, 0x0d3f, 0x0708, 0x0d03, 0x0d1d, 0x0716,
+		0x0770, 0x0d7b, 0x0d65, 0x076e, 0x0d59, 0x0752, 0x074c, 0x0d47,
+		0x0cc1, 0x06ca, 0x06d4, 0x0cdf, 0x06e8, 0x0ce3, 0x0cfd, 0x06f6,
+		0x0690, 0x0c9b, 0x0c85, 0x068e, 0x0cb9, 0x06b2, 0x06ac, 0x0ca7,
+		0x0660, 0x0c6b, 0x0c75, 0x067e, 0x0c49, 0x0642, 0x065c, 0x0c57,
+		0x0c31, 0x063a, 0x0624, 0x0c2f, 0x0618, 0x0c13, 0x0c0d, 0x0606,
+	},
+};
+
+/*! \brief GMR-1 CRC16, table driven version of \ref gmr1_crc16 */
+const struct gmr1_crc_table gmr1_crc16_table = {
+	.bits = 16,
+	.poly = 0x8408,
+	.init = 0x0000,
+	.remainder = 0x0000,
+	.table = {
+		0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
+		0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
+		0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
+		0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
+		0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+		0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
+		0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
+		0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
+		0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
+		0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
+		0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
+		0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
+		0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
+		0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+		0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
+		0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
+		0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
+		0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
+		0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
+		0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
+		0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
+		0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
+		0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+		0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
+		0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
+		0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
+		0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
+		0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
+		0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
+		0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
+		0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
+		0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78,
+	},
+};
+
+
+static inline uint16_t
+_crc_reflect(uint16_t v, int bits)
+{
+	uint16_t r = 0;
+	int i;
+
+	for (i=0; i<bits; i++)
+		r = (r << 1) | ((v >> i) & 1);
+
+	return r;
+}
+
+/*! \brief Compute the CRC of a packed bit array
+ *  \param[in] code Table driven CRC code
+ *  \param[in] in Packed input bits (LSB first, like GMR-1 L2 data)
+ *  \param[in] ofs Offset of the first bit in the input array
+ *  \param[in] len Number of bits
+ *  \return CRC value
+ *
+ * Same result as osmo_crc16gen_compute_bits() on the bits unpacked with
+ * osmo_pbit2ubit_ext(..., 1), but runs byte by byte on the packed data.
+ * Since the bytes come LSB first, the register is kept reflected.
+ */
+uint16_t
+gmr1_crc_compute_pbits(const struct gmr1_crc_table *code,
+                       const pbit_t *in, int ofs, int len)
+{
+	uint16_t r = _crc_reflect(code->init, code->bits);
+	int i, end = ofs + len;
+
+	/* Leading bits up to a byte boundary */
+	for (i=ofs; (i < end) && (i & 7); i++) {
+		r ^= (in[i >> 3] >> (i & 7)) & 1;
+		r = (r & 1) ? ((r >> 1) ^ code->poly) : (r >> 1);
+	}
+
+	/* Whole bytes */
+	for (; i+8 <= end; i+=8)
+		r = (r >> 8) ^ code->table[(r ^ in[i >> 3]) & 0xff];
+
+	/* Trailing bits */
+	for (; i < end; i++) {
+		r ^= (in[i >> 3] >> (i & 7)) & 1;
+		r = (r & 1) ? ((r >> 1) ^ code->poly) : (r >> 1);
+	}
+
+	return _crc_reflect(r, code->bits) ^ code->remainder;
+}
+
+/*! \brief Check the CRC of a packed bit array
+ *  \param[in] code Table driven CRC code
+ *  \param[in] in Packed input bits (LSB first, like GMR-1 L2 data)
+ *  \param[in] ofs Offset of the first bit in the input array
+ *  \param[in] len Number of bits
+ *  \param[in] crc_bits Received CRC as code->bits ubits
+ *  \return 0 if the CRC matches, 1 otherwise (like osmo_crc16gen_check_bits)
+ */
+int
+gmr1_crc_check_pbits(const struct gmr1_crc_table *code,
+                     const pbit_t *in, int ofs, int len,
+                     const ubit_t *crc_bits)
+{
+	uint16_t crc = 0;
+	int i;
+
+	for (i=0; i<code->bits; i++)
+		crc = (crc << 1) | (crc_bits[i] & 1);
+
+	return gmr1_crc_compute_pbits(code, in, ofs, len) != crc;
+}
+
+/*! \brief Compute the CRC of a packed bit array into ubits
+ *  \param[in] code Table driven CRC code
+ *  \param[in] in Packed input bits (LSB first, like GMR-1 L2 data)
+ *  \param[in] ofs Offset of the first bit in the input array
+ *  \param[in] len Number of bits
+ *  \param[out] crc_bits CRC as code->bits ubits
+ */
+void
+gmr1_crc_set_pbits(const struct gmr1_crc_table *code,
+                   const pbit_t *in, int ofs, int len,
+                   ubit_t *crc_bits)
+{
+	uint16_t crc;
+	int i;
+
+	crc = gmr1_crc_compute_pbits(code, in, ofs, len);
+
+	for (i=0; i<code->bits; i++)
+		crc_bits[i] = (crc >> (code->bits - i - 1)) & 1;
+}
+
 /*! @} */
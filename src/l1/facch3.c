@@ -26,28 +26,22 @@
  *  \brief Osmocom GMR-1 FACCH3 channel coding implementation
  */
 
+#include <errno.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <osmocom/core/bits.h>
 #include <osmocom/core/conv.h>
-#include <osmocom/core/crc16gen.h>
 
 #include <osmocom/gmr1/l1/conv.h>
 #include <osmocom/gmr1/l1/crc.h>
 #include <osmocom/gmr1/l1/interleave.h>
+#include <osmocom/gmr1/l1/rxmap.h>
 #include <osmocom/gmr1/l1/scramb.h>
 
-
-static struct osmo_conv_code gmr1_conv_facch3;
-
-static void __attribute__ ((constructor))
-gmr1_facch3_init(void)
-{
-	/* Init convolutional coder */
-	memcpy(&gmr1_conv_facch3, &gmr1_conv_k5_14, sizeof(struct osmo_conv_code));
-	gmr1_conv_facch3.len = 92;
-}
+#include "private.h"
 
 
 /*! \brief Stateless GMR-1 FACCH3 channel coder
@@ -74,7 +68,7 @@ gmr1_facch3_encode(ubit_t *bits_e, const uint8_t *l2,
 	int i, j;
 
 	osmo_pbit2ubit_ext(bits_u, 0, l2, 0, 76, 1);
-	osmo_crc16gen_set_bits(&gmr1_crc16, bits_u, 76, bits_u+76);
+	gmr1_crc_set_pbits(&gmr1_crc16_table, l2, 0, 76, bits_u+76);
 
 	osmo_conv_encode(&gmr1_conv_facch3, bits_u, bits_c);
 
@@ -104,6 +98,56 @@ gmr1_facch3_encode(ubit_t *bits_e, const uint8_t *l2,
 	}
 }
 
+/* e -> c : demultiplexing (around the status bits), deciphering,
+ * unscrambling and de-interleaving of the 4 bursts */
+static struct gmr1_rxmap gmr1_facch3_rxmap[384];
+static pthread_once_t gmr1_facch3_rxmap_once = PTHREAD_ONCE_INIT;
+
+static void
+_facch3_rxmap_init(void)
+{
+	struct gmr1_rxmap map_ep[96];
+	struct gmr1_rxmap map_cp[96*4];
+	int i;
+
+	for (i=0; i<4; i++)
+	{
+		gmr1_rxmap_segment(map_ep,    104*i,    96*i,     0, 22);
+		gmr1_rxmap_segment(map_ep+22, 104*i+30, 96*i+22, 22, 74);
+		gmr1_rxmap_intra(map_cp + 96*i, map_ep, 12);
+	}
+
+	for (i=0; i<384; i++)
+		gmr1_facch3_rxmap[i] = map_cp[(i&3)*96 + (i>>2)];
+}
+
+static void
+_facch3_decode_pre(sbit_t *bits_c, ubit_t *bits_s,
+                   const sbit_t *bits_e, const ubit_t *ciph)
+{
+	int i, j;
+
+	for (i=0; i<4; i++)
+		for (j=0; j<8; j++)
+			bits_s[8*i+j] = bits_e[104*i+22+j] < 0;
+
+	pthread_once(&gmr1_facch3_rxmap_once, _facch3_rxmap_init);
+	gmr1_rxmap_apply(bits_c, bits_e, ciph, gmr1_facch3_rxmap, 384);
+}
+
+static int
+_facch3_decode_post(uint8_t *l2, const ubit_t *bits_u)
+{
+	int rv;
+
+	l2[9] = 0; /* upper nibble won't be written */
+	osmo_ubit2pbit_ext(l2, 0, bits_u, 0, 76, 1);
+
+	rv = gmr1_crc_check_pbits(&gmr1_crc16_table, l2, 0, 76, bits_u+76);
+
+	return rv;
+}
+
 /*! \brief Stateless GMR-1 FACCH3 channel decoder
  *  \param[out] l2 L2 packet data
  *  \param[out] bits_s 4*8 status bits de-multiplexed
@@ -122,49 +166,76 @@ int
 gmr1_facch3_decode(uint8_t *l2, ubit_t *bits_s,
                    const sbit_t *bits_e, const ubit_t *ciph, int *conv_rv)
 {
-	sbit_t bits_xmy[96*4];
-	sbit_t bits_ep[96*4];
-	sbit_t bits_cp[96*4];
 	sbit_t bits_c[384];
 	ubit_t bits_u[92];
-	int rv, i, j;
+	int rv;
 
-	for (i=0; i<4; i++)
-	{
-		const sbit_t *b_bits_e = bits_e + 104*i;
-		ubit_t *b_bits_s   = bits_s   +   8*i;
-		sbit_t *b_bits_xmy = bits_xmy +  96*i;
-		sbit_t *b_bits_ep  = bits_ep  +  96*i;
-		sbit_t *b_bits_cp  = bits_cp  +  96*i;
-		const ubit_t *b_ciph = ciph + 96*i;
+	_facch3_decode_pre(bits_c, bits_s, bits_e, ciph);
 
-		for (j=0; j<8; j++)
-			b_bits_s[j] = b_bits_e[22+j] < 0;
-
-		memcpy(b_bits_xmy,    b_bits_e,    22);
-		memcpy(b_bits_xmy+22, b_bits_e+30, 74);
-
-		if (ciph) {
-			for (j=0; j<96; j++)
-				if (b_ciph[j])
-					b_bits_xmy[j] *= -1;
-		}
+	rv = gmr1_conv_decode(&gmr1_conv_facch3, bits_c, bits_u);
+	if (conv_rv)
+		*conv_rv = rv;
 
-		gmr1_scramble_sbit(b_bits_ep, b_bits_xmy, 96);
-		gmr1_deinterleave_intra(b_bits_cp, b_bits_ep, 12);
-	};
+	return _facch3_decode_post(l2, bits_u);
+}
 
-	for (i=0; i<384; i++)
-		bits_c[i] = bits_cp[(i&3)*96 + (i>>2)];
+/*! \brief Stateless GMR-1 FACCH3 channel decoder for a batch of blocks
+ *  \param[in] n Number of FACCH3 blocks to decode
+ *  \param[out] l2 Array of n L2 packet data buffers
+ *  \param[out] bits_s Array of n 4*8 status bits buffers
+ *  \param[in] bits_e Array of n 4*104 encoded bits of 4 bursts
+ *  \param[in] ciph Array of n 4*96 bits cipher streams (can be NULL,
+ *                  and so can any entry)
+ *  \param[out] crc_rv Array of n CRC check results, 0 if pass
+ *  \param[out] conv_rv Array of n convolutional decode returns (can be NULL)
+ *  \return 0 on success, -ENOMEM if the work buffers can't be allocated.
+ *
+ * Same as \ref gmr1_facch3_decode for each block, but all the blocks go
+ * through a single \ref gmr1_conv_decode_batch call so the Viterbi runs
+ * several frames in parallel. That Viterbi uses libosmocore's generic
+ * metric, so conv_rv and, on very noisy bursts, the decoded data can differ
+ * from the ones of \ref gmr1_facch3_decode.
+ */
+int
+gmr1_facch3_decode_batch(int n, uint8_t * const *l2, ubit_t * const *bits_s,
+                         const sbit_t * const *bits_e,
+                         const ubit_t * const *ciph,
+                         int *crc_rv, int *conv_rv)
+{
+	const sbit_t **in;
+	ubit_t **out;
+	sbit_t *bits_c;
+	ubit_t *bits_u;
+	int i, rv;
+
+	if (n <= 0)
+		return 0;
+
+	in = malloc(n * (sizeof(sbit_t *) + sizeof(ubit_t *) +
+	                 384 * sizeof(sbit_t) + 92 * sizeof(ubit_t)));
+	if (!in)
+		return -ENOMEM;
+
+	out    = (ubit_t **) &in[n];
+	bits_c = (sbit_t *) &out[n];
+	bits_u = (ubit_t *) &bits_c[n * 384];
+
+	for (i=0; i<n; i++) {
+		in[i]  = &bits_c[i * 384];
+		out[i] = &bits_u[i * 92];
+		_facch3_decode_pre(&bits_c[i * 384], bits_s[i], bits_e[i],
+		                   ciph ? ciph[i] : NULL);
+	}
 
-	rv = osmo_conv_decode(&gmr1_conv_facch3, bits_c, bits_u);
-	if (conv_rv)
-		*conv_rv = rv;
+	rv = gmr1_conv_decode_batch(&gmr1_conv_facch3, n, in, out, conv_rv);
+	if (rv)
+		goto err;
 
-	rv = osmo_crc16gen_check_bits(&gmr1_crc16, bits_u, 76, bits_u+76);
+	for (i=0; i<n; i++)
+		crc_rv[i] = _facch3_decode_post(l2[i], out[i]);
 
-	l2[9] = 0; /* upper nibble won't be written */
-	osmo_ubit2pbit_ext(l2, 0, bits_u, 0, 76, 1);
+err:
+	free(in);
 
 	return rv;
 }
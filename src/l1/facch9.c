@@ -26,28 +26,20 @@
  *  \brief Osmocom GMR-1 FACCH9 channel coding implementation
  */
 
+#include <pthread.h>
 #include <stdint.h>
 #include <string.h>
 
 #include <osmocom/core/bits.h>
 #include <osmocom/core/conv.h>
-#include <osmocom/core/crc16gen.h>
 
 #include <osmocom/gmr1/l1/conv.h>
 #include <osmocom/gmr1/l1/crc.h>
 #include <osmocom/gmr1/l1/interleave.h>
+#include <osmocom/gmr1/l1/rxmap.h>
 #include <osmocom/gmr1/l1/scramb.h>
 
-
-static struct osmo_conv_code gmr1_conv_facch9;
-
-static void __attribute__ ((constructor))
-gmr1_facch9_init(void)
-{
-	/* Init convolutional coder */
-	memcpy(&gmr1_conv_facch9, &gmr1_conv_k5_12, sizeof(struct osmo_conv_code));
-	gmr1_conv_facch9.len = 316;
-}
+#include "private.h"
 
 
 /*! \brief Stateless GMR-1 FACCH9 channel coder
@@ -69,7 +61,7 @@ gmr1_facch9_encode(ubit_t *bits_e, const uint8_t *l2,
 	int i;
 
 	osmo_pbit2ubit_ext(bits_u, 0, l2, 0, 300, 1);
-	osmo_crc16gen_set_bits(&gmr1_crc16, bits_u, 300, bits_u+300);
+	gmr1_crc_set_pbits(&gmr1_crc16_table, l2, 0, 300, bits_u+300);
 
 	osmo_conv_encode(&gmr1_conv_facch9, bits_u, bits_c);
 
@@ -93,6 +85,21 @@ gmr1_facch9_encode(ubit_t *bits_e, const uint8_t *l2,
 	memcpy(bits_e+56, bits_my+52,  606);
 }
 
+/* e -> c : demultiplexing (around status and SACCH bits), deciphering,
+ * unscrambling and de-interleaving (first 4 bits unused) */
+static struct gmr1_rxmap gmr1_facch9_rxmap[640];
+static pthread_once_t gmr1_facch9_rxmap_once = PTHREAD_ONCE_INIT;
+
+static void
+_facch9_rxmap_init(void)
+{
+	struct gmr1_rxmap map_epp_x[648];
+
+	gmr1_rxmap_segment(map_epp_x,     0,  0,  0,  52);
+	gmr1_rxmap_segment(map_epp_x+52, 66, 62, 52, 596);
+	gmr1_rxmap_intra(gmr1_facch9_rxmap, map_epp_x+4, 80);
+}
+
 /*! \brief Stateless GMR-1 FACCH9 channel decoder
  *  \param[out] l2 L2 packet data (38 bytes, last nibble unused)
  *  \param[out] bits_sacch 10 saach bits demultiplexed
@@ -107,39 +114,27 @@ int
 gmr1_facch9_decode(uint8_t *l2, sbit_t *bits_sacch, sbit_t *bits_status,
                    const sbit_t *bits_e, const ubit_t *ciph, int *conv_rv)
 {
-	sbit_t bits_my[658];
-	sbit_t bits_epp_x[648];
 	sbit_t bits_c[640];
 	ubit_t bits_u[316];
 	int i, rv;
 
-	memcpy(bits_my,     bits_e,     52);
-	memcpy(bits_status, bits_e+52,   4);
-	memcpy(bits_my+52,  bits_e+56, 606);
-
-	if (ciph) {
-		for (i=0; i<658; i++)
-			if (ciph[i])
-				bits_my[i] *= -1;
-	}
-
-	memcpy(bits_epp_x,    bits_my,     52);
-	memcpy(bits_sacch,    bits_my+52,  10);
-	memcpy(bits_epp_x+52, bits_my+62, 596);
+	memcpy(bits_status, bits_e+52, 4);
 
-	gmr1_scramble_sbit(bits_epp_x, bits_epp_x, 648);
+	for (i=0; i<10; i++)
+		bits_sacch[i] = (ciph && ciph[52+i]) ? -bits_e[56+i] : bits_e[56+i];
 
-	gmr1_deinterleave_intra(bits_c, bits_epp_x+4, 80);
+	pthread_once(&gmr1_facch9_rxmap_once, _facch9_rxmap_init);
+	gmr1_rxmap_apply(bits_c, bits_e, ciph, gmr1_facch9_rxmap, 640);
 
-	rv = osmo_conv_decode(&gmr1_conv_facch9, bits_c, bits_u);
+	rv = gmr1_conv_decode(&gmr1_conv_facch9, bits_c, bits_u);
 	if (conv_rv)
 		*conv_rv = rv;
 
-	rv = osmo_crc16gen_check_bits(&gmr1_crc16, bits_u, 300, bits_u+300);
-
 	l2[37] = 0; /* upper nibble won't be written */
 	osmo_ubit2pbit_ext(l2, 0, bits_u, 0, 300, 1);
 
+	rv = gmr1_crc_check_pbits(&gmr1_crc16_table, l2, 0, 300, bits_u+300);
+
 	return rv;
 }
 
@@ -0,0 +1,334 @@
+/* GMR-1 specialized convolutional codes table generator */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \addtogroup l1_private
+ *  @{
+ */
+
+/*! \file l1/gen_conv_spec.c
+ *  \brief Osmocom GMR-1 specialized convolutional codes table generator
+ *
+ * Maintainer helper : specializes the generic codes of conv.c for each
+ * channel (length, termination, puncturing from punct.c) and prints them
+ * as const C data on stdout, declared in private.h. This way the library
+ * itself has nothing to set up at load time.
+ *
+ * The output is kept in the tree as conv_spec.c (so cross builds and
+ * release tarballs don't need to run anything), regenerate it with
+ * 'make regen-conv-spec' after changing the codes or the puncturers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <osmocom/core/conv.h>
+
+#include <osmocom/gmr1/l1/conv.h>
+#include <osmocom/gmr1/l1/punct.h>
+
+
+/*! \brief RACH puncturing : only b[0] .. b[539] are punctured */
+static const struct gmr1_puncturer gmr1_punct_rach = {
+	.r = 2,
+	.L = 1,
+	.N = 4,
+	.mask = {
+		1, 1, 0, 0,
+	},
+};
+
+/*! \brief Description of a specialized code */
+struct conv_spec {
+	const char *name;			/*!< \brief Suffix of the code name */
+	const struct osmo_conv_code *base;	/*!< \brief Generic code */
+	const char *base_name;			/*!< \brief Suffix of its name */
+	int len;				/*!< \brief Input length */
+	enum osmo_conv_term term;		/*!< \brief Termination */
+	const struct gmr1_puncturer *pre;	/*!< \brief First block puncturing */
+	const struct gmr1_puncturer *main;	/*!< \brief Puncturing */
+	const struct gmr1_puncturer *post;	/*!< \brief Last block puncturing */
+	int repeat;				/*!< \brief Main puncturing repeat */
+};
+
+static const struct conv_spec specs[] = {
+	{
+		.name = "bcch",
+		.base = &gmr1_conv_k5_12, .base_name = "k5_12",
+		.len = 208, .term = CONV_TERM_FLUSH,
+	},
+	{
+		.name = "ccch",
+		.base = &gmr1_conv_k5_12, .base_name = "k5_12",
+		.len = 208, .term = CONV_TERM_FLUSH,
+	},
+	{
+		.name = "facch3",
+		.base = &gmr1_conv_k5_14, .base_name = "k5_14",
+		.len = 92, .term = CONV_TERM_FLUSH,
+	},
+	{
+		.name = "facch9",
+		.base = &gmr1_conv_k5_12, .base_name = "k5_12",
+		.len = 316, .term = CONV_TERM_FLUSH,
+	},
+	{
+		.name = "rach",
+		.base = &gmr1_conv_k5_14, .base_name = "k5_14",
+		.len = 159, .term = CONV_TERM_FLUSH,
+		.main = &gmr1_punct_rach, .repeat = 135,
+	},
+	{
+		.name = "tch3_speech",
+		.base = &gmr1_conv_tch3, .base_name = "tch3",
+		.len = 48, .term = CONV_TERM_TAIL_BITING,
+		.main = &gmr1_punct_k5_12_P12,
+	},
+	{
+		.name = "tch9_24",
+		.base = &gmr1_conv_k5_15, .base_name = "k5_15",
+		.len = 144, .term = CONV_TERM_FLUSH,
+		.pre = &gmr1_punct_k5_15_P53,
+		.main = &gmr1_punct_k5_15_P23,
+		.post = &gmr1_punct_k5_15_Ps53,
+		.repeat = 41,
+	},
+	{
+		.name = "tch9_48",
+		.base = &gmr1_conv_k5_13, .base_name = "k5_13",
+		.len = 240, .term = CONV_TERM_FLUSH,
+		.pre = &gmr1_punct_k5_13_P15,
+		.main = &gmr1_punct_k5_13_P25,
+		.post = &gmr1_punct_k5_13_Ps15,
+		.repeat = 41,
+	},
+	{
+		.name = "tch9_96",
+		.base = &gmr1_conv_k5_12, .base_name = "k5_12",
+		.len = 480, .term = CONV_TERM_FLUSH,
+		.pre = &gmr1_punct_k5_12_P25,
+		.main = &gmr1_punct_k5_12_P23,
+		.post = &gmr1_punct_k5_12_Ps25,
+		.repeat = 158,
+	},
+	{
+		.name = "xch_dc12",
+		.base = &gmr1_conv_k9_13, .base_name = "k9_13",
+		.len = 208, .term = CONV_TERM_TAIL_BITING,
+		.main = &gmr1_punct_k9_13_P1213,
+	},
+};
+
+static const char *term_names[] = {
+	[CONV_TERM_FLUSH]	= "CONV_TERM_FLUSH",
+	[CONV_TERM_TRUNCATION]	= "CONV_TERM_TRUNCATION",
+	[CONV_TERM_TAIL_BITING]	= "CONV_TERM_TAIL_BITING",
+};
+
+
+static void
+print_table2(const char *name, const uint8_t (*t)[2], int n)
+{
+	int i;
+
+	printf("static const uint8_t %s[][2] = {\n", name);
+	for (i=0; i<n; i++)
+		printf("%s{ %3d, %3d },%s",
+			(i & 3) ? " " : "\t", t[i][0], t[i][1],
+			((i & 3) == 3) ? "\n" : "");
+	printf("%s};\n\n", (n & 3) ? "\n" : "");
+}
+
+static void
+print_table1(const char *name, const uint8_t *t, int n)
+{
+	int i;
+
+	printf("static const uint8_t %s[] = {\n", name);
+	for (i=0; i<n; i++)
+		printf("%s%3d,%s",
+			(i & 7) ? " " : "\t", t[i],
+			((i & 7) == 7) ? "\n" : "");
+	printf("%s};\n\n", (n & 7) ? "\n" : "");
+}
+
+static void
+print_puncture(const char *name, const int *p)
+{
+	int i;
+
+	printf("static const int %s[] = {\n", name);
+	for (i=0; p[i]>=0; i++)
+		printf("%s%4d,%s",
+			(i & 7) ? " " : "\t", p[i],
+			((i & 7) == 7) ? "\n" : "");
+	printf("%s\t-1,\n};\n\n", (i & 7) ? "\n" : "");
+}
+
+/*! \brief Print the per step mask of transmitted bits of a punctured code
+ *
+ * Same as what the specialized Viterbi decoder would otherwise compute for
+ * every frame (see conv_dec.c).
+ */
+static int
+print_live(const char *name, const struct osmo_conv_code *code)
+{
+	const int N = code->N;
+	const int *p = code->puncture;
+	int n_steps, k, base;
+	uint8_t *live;
+
+	n_steps = code->len + ((code->term == CONV_TERM_FLUSH) ? (code->K - 1) : 0);
+
+	live = malloc(n_steps);
+	if (!live)
+		return -1;
+
+	memset(live, (1 << N) - 1, n_steps);
+
+	/* Puncture positions are in increasing order */
+	for (k=0, base=0; (*p >= 0) && (k < n_steps); p++) {
+		while ((*p >= base + N) && (k < n_steps)) {
+			base += N;
+			k++;
+		}
+		if (k < n_steps)
+			live[k] &= ~(1 << (*p - base));
+	}
+
+	print_table1(name, live, n_steps);
+
+	free(live);
+
+	return 0;
+}
+
+/*! \brief Print the state tables of a generic code, once for all its users */
+static void
+print_base(const struct conv_spec *s)
+{
+	const struct osmo_conv_code *c = s->base;
+	int n = 1 << (c->K - 1);
+	char name[64];
+
+	snprintf(name, sizeof(name), "gmr1_conv_%s_next_output", s->base_name);
+	print_table2(name, c->next_output, n);
+
+	snprintf(name, sizeof(name), "gmr1_conv_%s_next_state", s->base_name);
+	print_table2(name, c->next_state, n);
+
+	if (c->next_term_output) {
+		snprintf(name, sizeof(name), "gmr1_conv_%s_next_term_output", s->base_name);
+		print_table1(name, c->next_term_output, n);
+	}
+
+	if (c->next_term_state) {
+		snprintf(name, sizeof(name), "gmr1_conv_%s_next_term_state", s->base_name);
+		print_table1(name, c->next_term_state, n);
+	}
+}
+
+static int
+print_spec(const struct conv_spec *s)
+{
+	struct osmo_conv_code code;
+	const struct osmo_conv_code *c = s->base;
+	char name[64];
+	int rv;
+
+	memcpy(&code, c, sizeof(struct osmo_conv_code));
+	code.len  = s->len;
+	code.term = s->term;
+
+	if (s->main) {
+		rv = gmr1_puncturer_generate(&code, s->pre, s->main, s->post, s->repeat);
+		if (rv)
+			return rv;
+
+		snprintf(name, sizeof(name), "gmr1_conv_%s_puncture", s->name);
+		print_puncture(name, code.puncture);
+
+		snprintf(name, sizeof(name), "gmr1_conv_%s_live", s->name);
+		rv = print_live(name, &code);
+		free((void *)code.puncture);
+		if (rv)
+			return rv;
+	}
+
+	printf("/*! \\brief GMR-1 %s convolutional code */\n", s->name);
+	printf("const struct osmo_conv_code gmr1_conv_%s = {\n", s->name);
+	printf("\t.N = %d,\n", code.N);
+	printf("\t.K = %d,\n", code.K);
+	printf("\t.len = %d,\n", code.len);
+	printf("\t.term = %s,\n", term_names[code.term]);
+	printf("\t.next_output = gmr1_conv_%s_next_output,\n", s->base_name);
+	printf("\t.next_state  = gmr1_conv_%s_next_state,\n", s->base_name);
+	if (c->next_term_output)
+		printf("\t.next_term_output = gmr1_conv_%s_next_term_output,\n", s->base_name);
+	if (c->next_term_state)
+		printf("\t.next_term_state  = gmr1_conv_%s_next_term_state,\n", s->base_name);
+	if (s->main)
+		printf("\t.puncture = gmr1_conv_%s_puncture,\n", s->name);
+	printf("};\n\n");
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const int n = sizeof(specs) / sizeof(specs[0]);
+	int i, j, rv;
+
+	printf("/* Generated by gen_conv_spec, do not edit */\n\n");
+	printf("#include <stdint.h>\n");
+	printf("#include <stdlib.h>\n\n");
+	printf("#include <osmocom/core/conv.h>\n\n");
+	printf("#include \"private.h\"\n\n\n");
+
+	for (i=0; i<n; i++) {
+		for (j=0; j<i; j++)
+			if (specs[j].base == specs[i].base)
+				break;
+		if (j == i)
+			print_base(&specs[i]);
+	}
+
+	printf("\n");
+
+	for (i=0; i<n; i++) {
+		rv = print_spec(&specs[i]);
+		if (rv) {
+			fprintf(stderr, "[!] Failed to specialize %s : %d\n",
+				specs[i].name, rv);
+			return 1;
+		}
+	}
+
+	/* Lookup of the masks by code */
+	printf("const struct gmr1_conv_live gmr1_conv_live[] = {\n");
+	for (i=0; i<n; i++)
+		if (specs[i].main)
+			printf("\t{ &gmr1_conv_%s, gmr1_conv_%s_live },\n",
+				specs[i].name, specs[i].name);
+	printf("\t{ NULL, NULL },\n};\n");
+
+	return 0;
+}
+
+/*! @} */
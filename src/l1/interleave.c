@@ -33,9 +33,25 @@
 
 #include <osmocom/core/bits.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON) && defined(GMR1_NEON)
+#define HAVE_NEON_KERNEL
+#include <arm_neon.h>
+#endif
+
 #include <osmocom/gmr1/l1/interleave.h>
 
 
+/*
+ * The intra burst interleaver sends bit kc = 8*i + r to kep = N*j + i with
+ * j = (5*kc) & 7 = (5*r) & 7. It's a transpose of an 8 x N matrix whose
+ * rows are permuted by _intra_row, no index computation needed per bit.
+ */
+static const uint8_t _intra_row[8] = { 0, 5, 2, 7, 4, 1, 6, 3 };
+
+
 /*! \brief GMR-1 intra burst inteleaver
  *  \param[out] out Interleaved bit array to write to
  *  \param[in] in Original bit array to read from
@@ -50,14 +66,12 @@ gmr1_interleave_intra(void *out, const void *in, int N)
 {
 	const uint8_t *inb = (uint8_t *)in;
 	uint8_t *outb = (uint8_t *)out;
-	int len = N << 3;
-	int kc, kep, i, j;
-
-	for (kc=0; kc<len; kc++) {
-		i = kc >> 3;
-		j = (5 * kc) & 7;
-		kep = N * j + i;
-		outb[kep] = inb[kc];
+	int i, r;
+
+	for (r=0; r<8; r++) {
+		uint8_t *d = &outb[N * _intra_row[r]];
+		for (i=0; i<N; i++)
+			d[i] = inb[(i << 3) + r];
 	}
 }
 
@@ -75,14 +89,139 @@ gmr1_deinterleave_intra(void *out, const void *in, int N)
 {
 	const uint8_t *inb = (uint8_t *)in;
 	uint8_t *outb = (uint8_t *)out;
-	int len = N << 3;
-	int kc, kep, i, j;
-
-	for (kc=0; kc<len; kc++) {
-		i = kc >> 3;
-		j = (5 * kc) & 7;
-		kep = N * j + i;
-		outb[kc] = inb[kep];
+	const uint8_t *s[8];
+	int i = 0, r;
+
+	for (r=0; r<8; r++)
+		s[r] = &inb[N * _intra_row[r]];
+
+#if defined(__SSE2__)
+	/* 8 x 16 transposes */
+	for (; i+16<=N; i+=16)
+	{
+		__m128i a[8], t[8], u[8], w;
+
+		for (r=0; r<8; r++)
+			a[r] = _mm_loadu_si128((const __m128i *)&s[r][i]);
+
+		for (r=0; r<8; r+=2) {
+			t[r]   = _mm_unpacklo_epi8(a[r], a[r+1]);
+			t[r+1] = _mm_unpackhi_epi8(a[r], a[r+1]);
+		}
+
+		for (r=0; r<8; r+=4) {
+			u[r]   = _mm_unpacklo_epi16(t[r],   t[r+2]);
+			u[r+1] = _mm_unpackhi_epi16(t[r],   t[r+2]);
+			u[r+2] = _mm_unpacklo_epi16(t[r+1], t[r+3]);
+			u[r+3] = _mm_unpackhi_epi16(t[r+1], t[r+3]);
+		}
+
+		for (r=0; r<4; r++) {
+			w = _mm_unpacklo_epi32(u[r], u[r+4]);
+			_mm_storeu_si128((__m128i *)&outb[(i << 3) + 32*r], w);
+			w = _mm_unpackhi_epi32(u[r], u[r+4]);
+			_mm_storeu_si128((__m128i *)&outb[(i << 3) + 32*r + 16], w);
+		}
+	}
+#elif defined(HAVE_NEON_KERNEL)
+	/* 8-way interleaved stores */
+	for (; i+16<=N; i+=16)
+	{
+		uint8x16x4_t lo, hi;
+		uint8x16x2_t z[4];
+
+		for (r=0; r<4; r++)
+			z[r] = vzipq_u8(vld1q_u8(&s[2*r][i]), vld1q_u8(&s[2*r+1][i]));
+
+		for (r=0; r<2; r++) {
+			uint16x8x2_t y0 = vzipq_u16(vreinterpretq_u16_u8(z[2*r].val[0]),
+			                            vreinterpretq_u16_u8(z[2*r+1].val[0]));
+			uint16x8x2_t y1 = vzipq_u16(vreinterpretq_u16_u8(z[2*r].val[1]),
+			                            vreinterpretq_u16_u8(z[2*r+1].val[1]));
+			if (!r) {
+				lo.val[0] = vreinterpretq_u8_u16(y0.val[0]);
+				lo.val[1] = vreinterpretq_u8_u16(y0.val[1]);
+				lo.val[2] = vreinterpretq_u8_u16(y1.val[0]);
+				lo.val[3] = vreinterpretq_u8_u16(y1.val[1]);
+			} else {
+				hi.val[0] = vreinterpretq_u8_u16(y0.val[0]);
+				hi.val[1] = vreinterpretq_u8_u16(y0.val[1]);
+				hi.val[2] = vreinterpretq_u8_u16(y1.val[0]);
+				hi.val[3] = vreinterpretq_u8_u16(y1.val[1]);
+			}
+		}
+
+		for (r=0; r<4; r++) {
+			uint32x4x2_t x = vzipq_u32(vreinterpretq_u32_u8(lo.val[r]),
+			                           vreinterpretq_u32_u8(hi.val[r]));
+			vst1q_u8(&outb[(i << 3) + 32*r],      vreinterpretq_u8_u32(x.val[0]));
+			vst1q_u8(&outb[(i << 3) + 32*r + 16], vreinterpretq_u8_u32(x.val[1]));
+		}
+	}
+#endif
+
+	for (; i<N; i++)
+		for (r=0; r<8; r++)
+			outb[(i << 3) + r] = s[r][i];
+}
+
+
+/*
+ * The inter burst interleaver state is a ring of the last N bursts (as
+ * given, row il->row is the current one). Output bit jk is the one from
+ * the row (phase-wise) selected by jk % N, which is precomputed in the
+ * il->phase table so no modulo is needed while processing.
+ */
+
+/*! \brief Select out[jk] = rows[(base +/- phase[jk]) mod N][jk] */
+static void
+_inter_select(uint8_t *out, const uint8_t *rows, const uint8_t *phase,
+              int N, int K, int base, int down)
+{
+	int jk = 0, d, r;
+
+#if defined(__SSE2__)
+	for (; jk+16<=K; jk+=16)
+	{
+		__m128i p = _mm_loadu_si128((const __m128i *)&phase[jk]);
+		__m128i v = _mm_setzero_si128();
+
+		for (d=0, r=base; d<N; d++) {
+			__m128i m = _mm_cmpeq_epi8(p, _mm_set1_epi8(d));
+			__m128i s = _mm_loadu_si128((const __m128i *)&rows[r*K + jk]);
+			v = _mm_or_si128(v, _mm_and_si128(m, s));
+			r = down ? (r ? r - 1 : N - 1) : (r == N - 1 ? 0 : r + 1);
+		}
+
+		_mm_storeu_si128((__m128i *)&out[jk], v);
+	}
+#elif defined(HAVE_NEON_KERNEL)
+	for (; jk+16<=K; jk+=16)
+	{
+		uint8x16_t p = vld1q_u8(&phase[jk]);
+		uint8x16_t v = vdupq_n_u8(0);
+
+		for (d=0, r=base; d<N; d++) {
+			uint8x16_t m = vceqq_u8(p, vdupq_n_u8(d));
+			v = vorrq_u8(v, vandq_u8(m, vld1q_u8(&rows[r*K + jk])));
+			r = down ? (r ? r - 1 : N - 1) : (r == N - 1 ? 0 : r + 1);
+		}
+
+		vst1q_u8(&out[jk], v);
+	}
+#endif
+
+	for (; jk<K; jk++) {
+		if (down) {
+			r = base - phase[jk];
+			if (r < 0)
+				r += N;
+		} else {
+			r = base + phase[jk];
+			if (r >= N)
+				r -= N;
+		}
+		out[jk] = rows[r*K + jk];
 	}
 }
 
@@ -95,21 +234,31 @@ gmr1_deinterleave_intra(void *out, const void *in, int N)
 int
 gmr1_interleaver_init(struct gmr1_interleaver *il, int N, int K)
 {
-	int l;
+	int l, jk, p;
 	uint8_t *b;
 
 	memset(il, 0x00, sizeof(struct gmr1_interleaver));
 
-	l = N * K * sizeof(uint8_t);
+	if ((N < 1) || (N > 255))
+		return -EINVAL;
+
+	l = (N + 1) * K * sizeof(uint8_t);
 	b = malloc(l);
 	if (!b)
 		return -ENOMEM;
 
-	memset(b, 0x00, l);
+	memset(b, 0x00, N * K);
 
 	il->N = N;
 	il->K = K;
 	il->bits_cpp = b;
+	il->phase = b + N * K;
+
+	for (jk=0, p=0; jk<K; jk++) {
+		il->phase[jk] = p;
+		if (++p == N)
+			p = 0;
+	}
 
 	return 0;
 }
@@ -136,24 +285,16 @@ void
 gmr1_interleave_inter(struct gmr1_interleaver *il,
                       void *bits_epp, void *bits_ep)
 {
-	int i, jk;
-	uint8_t *d, *s;
+	/* Store the new burst */
+	memcpy(&il->bits_cpp[il->row * il->K], bits_ep, il->K * sizeof(uint8_t));
 
-	/* Copy ep to cpp */
-	i = il->n % il->N;
-	d = &il->bits_cpp[i * il->K];
-	memcpy(d, bits_ep, il->K * sizeof(uint8_t));
-
-	/* Copy cpp to epp */
-	d = bits_epp;
-	s = il->bits_cpp;
-
-	for (jk=0; jk<il->K; jk++) {
-		i = ((il->n % il->N) - (jk % il->N) + il->N) % il->N;
-		d[jk] = s[(i * il->K) + jk];
-	}
+	/* Bit jk comes from the burst (jk % N) ago */
+	_inter_select(bits_epp, il->bits_cpp, il->phase, il->N, il->K,
+	              il->row, 1);
 
 	/* Next burst */
+	if (++il->row == il->N)
+		il->row = 0;
 	il->n++;
 }
 
@@ -168,24 +309,21 @@ void
 gmr1_deinterleave_inter(struct gmr1_interleaver *il,
                         void *bits_ep, void *bits_epp)
 {
-	int i, jk;
-	uint8_t *d, *s;
+	int base;
 
-	/* Copy epp to cpp */
-	s = bits_epp;
-	d = il->bits_cpp;
+	/* Store the new burst */
+	memcpy(&il->bits_cpp[il->row * il->K], bits_epp, il->K * sizeof(uint8_t));
 
-	for (jk=0; jk<il->K; jk++) {
-		i = ((il->n % il->N) - (jk % il->N) + il->N) % il->N;
-		d[(i * il->K) + jk] = s[jk];
-	}
+	/* Bit jk comes from the burst (N - 1 - jk % N) ago */
+	base = il->row + 1;
+	if (base == il->N)
+		base = 0;
 
-	/* Copy cpp to ep */
-	i = (il->n + 1) % il->N;
-	s = &il->bits_cpp[i * il->K];
-	memcpy(bits_ep, s, il->K * sizeof(uint8_t));
+	_inter_select(bits_ep, il->bits_cpp, il->phase, il->N, il->K, base, 0);
 
 	/* Next burst */
+	if (++il->row == il->N)
+		il->row = 0;
 	il->n++;
 }
 
@@ -0,0 +1,65 @@
+/* GMR-1 L1 private header */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __OSMO_GMR1_L1_PRIVATE_H__
+#define __OSMO_GMR1_L1_PRIVATE_H__
+
+/*! \defgroup l1_private L1 - internal API
+ *  \ingroup l1
+ *  @{
+ */
+
+/*! \file l1/private.h
+ *  \brief Osmocom GMR-1 L1 private header
+ */
+
+#include <stdint.h>
+
+#include <osmocom/core/conv.h>
+
+
+/* Channel specialized convolutional codes (generated, see gen_conv_spec.c) */
+
+extern const struct osmo_conv_code gmr1_conv_bcch;
+extern const struct osmo_conv_code gmr1_conv_ccch;
+extern const struct osmo_conv_code gmr1_conv_facch3;
+extern const struct osmo_conv_code gmr1_conv_facch9;
+extern const struct osmo_conv_code gmr1_conv_rach;
+extern const struct osmo_conv_code gmr1_conv_tch3_speech;
+extern const struct osmo_conv_code gmr1_conv_tch9_24;
+extern const struct osmo_conv_code gmr1_conv_tch9_48;
+extern const struct osmo_conv_code gmr1_conv_tch9_96;
+extern const struct osmo_conv_code gmr1_conv_xch_dc12;
+
+/*! \brief Transmitted output bits of each trellis step of a punctured code
+ *
+ * Bit j of live[k] is set if output bit j of step k isn't punctured. The
+ * table is terminated by a NULL code.
+ */
+struct gmr1_conv_live {
+	const struct osmo_conv_code *code;	/*!< \brief Punctured code */
+	const uint8_t *live;			/*!< \brief Mask of each step */
+};
+
+extern const struct gmr1_conv_live gmr1_conv_live[];
+
+
+/*! @} */
+
+#endif /* __OSMO_GMR1_L1_PRIVATE_H__ */
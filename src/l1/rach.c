@@ -27,43 +27,17 @@
  */
 
 #include <stdint.h>
-#include <stdlib.h>
 #include <string.h>
 
 #include <osmocom/core/bits.h>
 #include <osmocom/core/conv.h>
-#include <osmocom/core/crcgen.h>
 
 #include <osmocom/gmr1/l1/conv.h>
 #include <osmocom/gmr1/l1/crc.h>
 #include <osmocom/gmr1/l1/interleave.h>
 #include <osmocom/gmr1/l1/scramb.h>
 
-static struct osmo_conv_code gmr1_conv_rach;
-
-static void __attribute__ ((constructor))
-gmr1_rach_init(void)
-{
-	int i, *p;
-
-	/* Init convolutional coder */
-	memcpy(&gmr1_conv_rach, &gmr1_conv_k5_14, sizeof(struct osmo_conv_code));
-	gmr1_conv_rach.len = 159;
-
-	/* Generate puncturer (only b[0] .. b[539] punctured) */
-	p = malloc((135*2 + 1) * sizeof(int));
-	if (!p)
-		abort();
-
-	for (i=0; i<135; i++) {
-		p[(i<<1)  ] = (i << 2) + 2;
-		p[(i<<1)+1] = (i << 2) + 3;
-	}
-
-	p[270] = -1;
-
-	gmr1_conv_rach.puncture = p;
-}
+#include "private.h"
 
 
 /*! \brief Stateless GMR-1 RACH channel coder
@@ -92,8 +66,8 @@ gmr1_rach_encode(ubit_t *bits_e, const uint8_t *rach, uint8_t sb_mask)
 	osmo_pbit2ubit_ext(bits_u2, 0, rach, 16, 123, 1);
 
 	/* d -> u : CRC addition */
-	osmo_crc8gen_set_bits (&gmr1_crc8,  bits_u1,  16, bits_u1+16);
-	osmo_crc16gen_set_bits(&gmr1_crc12, bits_u2, 123, bits_u2+123);
+	gmr1_crc_set_pbits(&gmr1_crc8_table,  rach,  0,  16, bits_u1+16);
+	gmr1_crc_set_pbits(&gmr1_crc12_table, rach, 16, 123, bits_u2+123);
 
 	/* u -> u' : masking */
 	for (i=0; i<8; i++)
@@ -164,21 +138,27 @@ gmr1_rach_decode(uint8_t *rach, const sbit_t *bits_e, uint8_t sb_mask,
 	memcpy(bits_c+264, bits_e2p+264, 6);
 
 	/* c -> u' / u : convolutional decoding */
-	rv = osmo_conv_decode(&gmr1_conv_rach, bits_c, bits_u);
+	rv = gmr1_conv_decode(&gmr1_conv_rach, bits_c, bits_u);
 	if (conv_rv)
 		*conv_rv = rv;
 
 	bits_u1 = bits_u + 135;
 	bits_u2 = bits_u;
 
+	/* CRC removal & packing */
+	rach[17] = 0x00;
+
+	osmo_ubit2pbit_ext(rach,  0, bits_u1, 0,  16, 1);
+	osmo_ubit2pbit_ext(rach, 16, bits_u2, 0, 123, 1);
+
 	/* CRC checks */
-	crc[0] = osmo_crc8gen_check_bits (&gmr1_crc8,  bits_u1,  16, bits_u1+16);
-	crc[1] = osmo_crc16gen_check_bits(&gmr1_crc12, bits_u2, 123, bits_u2+123);
+	crc[0] = gmr1_crc_check_pbits(&gmr1_crc8_table,  rach,  0,  16, bits_u1+16);
+	crc[1] = gmr1_crc_check_pbits(&gmr1_crc12_table, rach, 16, 123, bits_u2+123);
 
 	if (crc[0]) {
 		for (i=0; i<8; i++)
 			bits_u1[16+i] ^= (sb_mask >> (7-i)) & 1;
-		crc[0] = osmo_crc8gen_check_bits (&gmr1_crc8,  bits_u1,  16, bits_u1+16);
+		crc[0] = gmr1_crc_check_pbits(&gmr1_crc8_table, rach, 0, 16, bits_u1+16);
 	}
 
 	if (crc_rv) {
@@ -186,12 +166,6 @@ gmr1_rach_decode(uint8_t *rach, const sbit_t *bits_e, uint8_t sb_mask,
 		crc_rv[1] = crc[1];
 	}
 
-	/* CRC removal & packing */
-	rach[17] = 0x00;
-
-	osmo_ubit2pbit_ext(rach,  0, bits_u1, 0,  16, 1);
-	osmo_ubit2pbit_ext(rach, 16, bits_u2, 0, 123, 1);
-
 	return crc[0] || crc[1];
 }
 
@@ -0,0 +1,186 @@
+/* GMR-1 receive maps */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \addtogroup rxmap
+ *  @{
+ */
+
+/*! \file l1/rxmap.c
+ *  \brief Osmocom GMR-1 receive maps implementation
+ *
+ * Between the burst soft bits and the convolutional decoder, the channel
+ * decoders only demultiplex, decipher, unscramble and deinterleave. These
+ * are all permutations and sign flips, so they can be described once per
+ * channel by a map giving, for each decoder input bit, the burst bit it
+ * comes from, the cipher stream bit applied to it and the scrambling sign.
+ * Each burst is then processed in a single gather pass.
+ *
+ * With a packed cipher stream, the scrambling signs are also kept packed
+ * by cipher stream position, so both combine 64 bits at a time into a
+ * sign mask that the gather pass then applies.
+ */
+
+#include <stdint.h>
+
+#include <osmocom/core/bits.h>
+
+#include <osmocom/gmr1/l1/rxmap.h>
+#include <osmocom/gmr1/l1/scramb.h>
+
+
+/*! \brief Describe a contiguous segment of a scrambled block
+ *  \param[out] map len entries to fill
+ *  \param[in] e Burst index of the first bit
+ *  \param[in] c Cipher stream index of the first bit
+ *  \param[in] s Scrambling sequence index of the first bit
+ *  \param[in] len Number of bits in the segment
+ */
+void
+gmr1_rxmap_segment(struct gmr1_rxmap *map, int e, int c, int s, int len)
+{
+	sbit_t sign[64];
+	int i, j, l;
+
+	for (i=0; i<len; i+=l) {
+		l = len - i > 64 ? 64 : len - i;
+
+		gmr1_scramble_sign(sign, s + i, l);
+
+		for (j=0; j<l; j++) {
+			map[i+j].e = e + i + j;
+			map[i+j].c = c + i + j;
+			map[i+j].s = sign[j];
+		}
+	}
+}
+
+/*! \brief Intra burst de-interleave a map
+ *  \param[out] out Deinterleaved map
+ *  \param[in] in Map of the interleaved bits
+ *  \param[in] N Dimension of the interleaving matrix
+ *
+ * Both maps have (8*N) entries, see \ref gmr1_deinterleave_intra.
+ */
+void
+gmr1_rxmap_intra(struct gmr1_rxmap *out, const struct gmr1_rxmap *in, int N)
+{
+	int kc;
+
+	for (kc=0; kc<8*N; kc++)
+		out[kc] = in[N * ((5 * kc) & 7) + (kc >> 3)];
+}
+
+/*! \brief Apply a receive map to a burst
+ *  \param[out] out len soft bits, in decoder input order
+ *  \param[in] bits_e Burst soft bits
+ *  \param[in] ciph Cipher stream (can be NULL)
+ *  \param[in] map Receive map
+ *  \param[in] len Number of entries in the map
+ *
+ * The cipher stream is combined with the scrambling sign, so each bit is
+ * negated at most once, as (v ^ m) - m (see \ref gmr1_scramble_sbit_ext).
+ */
+void
+gmr1_rxmap_apply(sbit_t *out, const sbit_t *bits_e, const ubit_t *ciph,
+                 const struct gmr1_rxmap *map, int len)
+{
+	int i;
+
+	if (ciph) {
+		for (i=0; i<len; i++) {
+			sbit_t m = map[i].s ^ -ciph[map[i].c];
+			out[i] = (bits_e[map[i].e] ^ m) - m;
+		}
+	} else {
+		for (i=0; i<len; i++) {
+			sbit_t m = map[i].s;
+			out[i] = (bits_e[map[i].e] ^ m) - m;
+		}
+	}
+}
+
+/*! \brief Pack the scrambling signs of a map by cipher stream position
+ *  \param[inout] sign Packed signs, bit c is bit (63 - c % 64) of word c / 64
+ *  \param[in] map Receive map
+ *  \param[in] len Number of entries in the map
+ *
+ * Only sets the bits of the map entries with a negative sign, so several
+ * maps over the same cipher stream can be packed in the same zeroed array.
+ */
+void
+gmr1_rxmap_sign_pack(uint64_t *sign, const struct gmr1_rxmap *map, int len)
+{
+	int i;
+
+	for (i=0; i<len; i++)
+		if (map[i].s)
+			sign[map[i].c >> 6] |= 1ULL << (63 - (map[i].c & 63));
+}
+
+/*! \brief Combine packed scrambling signs and cipher stream
+ *  \param[out] mask (nbits+63)/64 words of sign mask
+ *  \param[in] sign Packed scrambling signs (see \ref gmr1_rxmap_sign_pack)
+ *  \param[in] ciph Packed cipher stream, MSB first (can be NULL)
+ *  \param[in] nbits Length of the cipher stream
+ */
+void
+gmr1_rxmap_mask(uint64_t *mask, const uint64_t *sign,
+                const pbit_t *ciph, int nbits)
+{
+	int nbytes = (nbits + 7) >> 3;
+	int i, j;
+
+	for (i=0; i<((nbits + 63) >> 6); i++)
+	{
+		uint64_t w = 0;
+
+		if (ciph) {
+			for (j=0; j<8; j++)
+				w = (w << 8) | (8*i+j < nbytes ? ciph[8*i+j] : 0);
+		}
+
+		mask[i] = sign[i] ^ w;
+	}
+}
+
+/*! \brief Apply a receive map to a burst, with a sign mask
+ *  \param[out] out len soft bits, in decoder input order
+ *  \param[in] bits_e Burst soft bits
+ *  \param[in] mask Sign mask by cipher stream position (see
+ *                  \ref gmr1_rxmap_mask)
+ *  \param[in] map Receive map
+ *  \param[in] len Number of entries in the map
+ *
+ * Same output as \ref gmr1_rxmap_apply, the sign of each entry comes from
+ * the mask instead of the map and cipher stream.
+ */
+void
+gmr1_rxmap_apply_mask(sbit_t *out, const sbit_t *bits_e, const uint64_t *mask,
+                      const struct gmr1_rxmap *map, int len)
+{
+	int i;
+
+	for (i=0; i<len; i++) {
+		int c = map[i].c;
+		sbit_t m = -(sbit_t)((mask[c >> 6] >> (63 - (c & 63))) & 1);
+		out[i] = (bits_e[map[i].e] ^ m) - m;
+	}
+}
+
+/*! @} */
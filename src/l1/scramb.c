@@ -26,10 +26,22 @@
  *  \brief Osmocom GMR-1 scrambling implementation
  */
 
+#include <pthread.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <osmocom/core/bits.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON) && defined(GMR1_NEON)
+#define HAVE_NEON_KERNEL
+#include <arm_neon.h>
+#endif
+
+#include <osmocom/gmr1/l1/scramb.h>
+
 
 /*
  * h(D) = 1 + D + D^15
@@ -38,6 +50,9 @@
 
 #define GMR1_SCRAMBLE_REG_INIT 0x4d4b
 
+/* Longest scrambled block (TCH9 / FACCH9) */
+#define GMR1_SCRAMBLE_SEQ_LEN	648
+
 static inline int
 gmr1_scramble_reg_next(uint16_t *reg)
 {
@@ -52,6 +67,86 @@ gmr1_scramble_reg_next(uint16_t *reg)
 }
 
 
+/* The sequence is always the same, it's generated once as a sign mask
+ * (0 / -1 per bit) and as packed bits (MSB first) */
+static sbit_t g_scramb_sign[GMR1_SCRAMBLE_SEQ_LEN];
+static pbit_t g_scramb_pbit[(GMR1_SCRAMBLE_SEQ_LEN + 7) / 8];
+static pthread_once_t g_scramb_once = PTHREAD_ONCE_INIT;
+
+static void
+_scramb_init(void)
+{
+	uint16_t r = GMR1_SCRAMBLE_REG_INIT;
+	int i, b;
+
+	for (i=0; i<GMR1_SCRAMBLE_SEQ_LEN; i++) {
+		b = gmr1_scramble_reg_next(&r);
+		g_scramb_sign[i] = -b;
+		g_scramb_pbit[i >> 3] |= b << (7 - (i & 7));
+	}
+}
+
+/*! \brief Fallback for blocks beyond the precomputed sequence */
+static void
+_scramb_sbit_slow(sbit_t *out, const sbit_t *in, const ubit_t *ciph,
+                  int ofs, int len)
+{
+	uint16_t r = GMR1_SCRAMBLE_REG_INIT;
+	int i;
+
+	for (i=0; i<ofs; i++)
+		gmr1_scramble_reg_next(&r);
+
+	for (i=0; i<len; i++) {
+		sbit_t v = in[i];
+		int b = gmr1_scramble_reg_next(&r) ^ (ciph ? ciph[i] : 0);
+		out[i] = b ? -v : v;
+	}
+}
+
+/*! \brief Flip the sign of in[i] where sign[i] ^ -ciph[i] is set
+ *
+ * Negation is done as (v ^ m) - m which matches the C negation of a
+ * sbit_t, including the -128 case.
+ */
+static void
+_scramb_sbit_mask(sbit_t *out, const sbit_t *in, const sbit_t *sign,
+                  const ubit_t *ciph, int len)
+{
+	int i = 0;
+
+#if defined(__SSE2__)
+	const __m128i z = _mm_setzero_si128();
+
+	for (; i+16<=len; i+=16) {
+		__m128i v, m;
+		v = _mm_loadu_si128((const __m128i *)&in[i]);
+		m = _mm_loadu_si128((const __m128i *)&sign[i]);
+		if (ciph)
+			m = _mm_xor_si128(m, _mm_sub_epi8(z,
+				_mm_loadu_si128((const __m128i *)&ciph[i])));
+		v = _mm_sub_epi8(_mm_xor_si128(v, m), m);
+		_mm_storeu_si128((__m128i *)&out[i], v);
+	}
+#elif defined(HAVE_NEON_KERNEL)
+	for (; i+16<=len; i+=16) {
+		int8x16_t v, m;
+		v = vld1q_s8(&in[i]);
+		m = vld1q_s8(&sign[i]);
+		if (ciph)
+			m = veorq_s8(m, vnegq_s8(vreinterpretq_s8_u8(vld1q_u8(&ciph[i]))));
+		v = vsubq_s8(veorq_s8(v, m), m);
+		vst1q_s8(&out[i], v);
+	}
+#endif
+
+	for (; i<len; i++) {
+		sbit_t m = sign[i] ^ (ciph ? -ciph[i] : 0);
+		out[i] = (in[i] ^ m) - m;
+	}
+}
+
+
 /*! \brief Scrambles/Unscrambles a softbit vector
  *  \param[out] out output sbit_t array
  *  \param[in] in input sbit_t array
@@ -62,14 +157,57 @@ gmr1_scramble_reg_next(uint16_t *reg)
  */
 void
 gmr1_scramble_sbit(sbit_t *out, const sbit_t *in, int len)
+{
+	gmr1_scramble_sbit_ext(out, in, NULL, 0, len);
+}
+
+/*! \brief Unscrambles and deciphers part of a softbit vector in one pass
+ *  \param[out] out output sbit_t array
+ *  \param[in] in input sbit_t array
+ *  \param[in] ciph len bits of cipher stream to apply (can be NULL)
+ *  \param[in] ofs Position of in[0] in the scrambling sequence
+ *  \param[in] len length of the array to convert
+ *
+ * Same as deciphering in with ciph and then applying
+ * \ref gmr1_scramble_sbit to it, with in being the part of the scrambled
+ * block starting at ofs. The output array can be equal to the input array.
+ */
+void
+gmr1_scramble_sbit_ext(sbit_t *out, const sbit_t *in, const ubit_t *ciph,
+                       int ofs, int len)
+{
+	if (ofs + len > GMR1_SCRAMBLE_SEQ_LEN) {
+		_scramb_sbit_slow(out, in, ciph, ofs, len);
+		return;
+	}
+
+	pthread_once(&g_scramb_once, _scramb_init);
+
+	_scramb_sbit_mask(out, in, &g_scramb_sign[ofs], ciph, len);
+}
+
+/*! \brief Get part of the scrambling sequence as a sign mask
+ *  \param[out] sign len sbit_t, 0 or -1 where the sequence bit is set
+ *  \param[in] ofs Position of the first bit in the scrambling sequence
+ *  \param[in] len Number of bits to get
+ */
+void
+gmr1_scramble_sign(sbit_t *sign, int ofs, int len)
 {
 	uint16_t r = GMR1_SCRAMBLE_REG_INIT;
 	int i;
 
-	for (i=0; i<len; i++) {
-		sbit_t v = in[i];
-		out[i] = gmr1_scramble_reg_next(&r) ? -v : v;
+	if (ofs + len > GMR1_SCRAMBLE_SEQ_LEN) {
+		for (i=0; i<ofs; i++)
+			gmr1_scramble_reg_next(&r);
+		for (i=0; i<len; i++)
+			sign[i] = -gmr1_scramble_reg_next(&r);
+		return;
 	}
+
+	pthread_once(&g_scramb_once, _scramb_init);
+
+	memcpy(sign, &g_scramb_sign[ofs], len);
 }
 
 /*! \brief Scrambles/Unscrambles an unpacked hard bit vector
@@ -84,12 +222,74 @@ void
 gmr1_scramble_ubit(ubit_t *out, const ubit_t *in, int len)
 {
 	uint16_t r = GMR1_SCRAMBLE_REG_INIT;
-	int i;
+	int i = 0;
 
-	for (i=0; i<len; i++) {
-		ubit_t v = in[i];
-		out[i] = v ^ gmr1_scramble_reg_next(&r);
+	if (len > GMR1_SCRAMBLE_SEQ_LEN) {
+		for (i=0; i<len; i++) {
+			ubit_t v = in[i];
+			out[i] = v ^ gmr1_scramble_reg_next(&r);
+		}
+		return;
 	}
+
+	pthread_once(&g_scramb_once, _scramb_init);
+
+#if defined(__SSE2__)
+	for (; i+16<=len; i+=16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)&in[i]);
+		__m128i m = _mm_loadu_si128((const __m128i *)&g_scramb_sign[i]);
+		v = _mm_xor_si128(v, _mm_and_si128(m, _mm_set1_epi8(1)));
+		_mm_storeu_si128((__m128i *)&out[i], v);
+	}
+#elif defined(HAVE_NEON_KERNEL)
+	for (; i+16<=len; i+=16) {
+		uint8x16_t v = vld1q_u8(&in[i]);
+		uint8x16_t m = vreinterpretq_u8_s8(vld1q_s8(&g_scramb_sign[i]));
+		v = veorq_u8(v, vandq_u8(m, vdupq_n_u8(1)));
+		vst1q_u8(&out[i], v);
+	}
+#endif
+
+	for (; i<len; i++)
+		out[i] = in[i] ^ (g_scramb_sign[i] & 1);
+}
+
+/*! \brief Scrambles/Unscrambles a packed hard bit vector
+ *  \param[out] out output pbit_t array
+ *  \param[in] in input pbit_t array (MSB first)
+ *  \param[in] len length of the array to convert (in bits)
+ *
+ * Bits of the last byte past len are copied unchanged. The output array
+ * can be equal to the input array.
+ */
+void
+gmr1_scramble_pbit(pbit_t *out, const pbit_t *in, int len)
+{
+	uint16_t r = GMR1_SCRAMBLE_REG_INIT;
+	int i = 0, nb = len >> 3;
+
+	if (len > GMR1_SCRAMBLE_SEQ_LEN) {
+		memmove(out, in, (len + 7) >> 3);
+		for (i=0; i<len; i++)
+			out[i >> 3] ^= gmr1_scramble_reg_next(&r) << (7 - (i & 7));
+		return;
+	}
+
+	pthread_once(&g_scramb_once, _scramb_init);
+
+	for (; i+8<=nb; i+=8) {
+		uint64_t v, m;
+		memcpy(&v, &in[i], 8);
+		memcpy(&m, &g_scramb_pbit[i], 8);
+		v ^= m;
+		memcpy(&out[i], &v, 8);
+	}
+
+	for (; i<nb; i++)
+		out[i] = in[i] ^ g_scramb_pbit[i];
+
+	if (len & 7)
+		out[nb] = in[nb] ^ (g_scramb_pbit[nb] & (0xff << (8 - (len & 7))));
 }
 
 /*! @} */
@@ -26,6 +26,7 @@
  *  \brief Osmocom GMR-1 TCH3 channel coding implementation
  */
 
+#include <pthread.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -33,20 +34,12 @@
 #include <osmocom/core/conv.h>
 
 #include <osmocom/gmr1/l1/conv.h>
-#include <osmocom/gmr1/l1/punct.h>
+#include <osmocom/gmr1/l1/rxmap.h>
 #include <osmocom/gmr1/l1/scramb.h>
 
+#include <osmocom/gmr1/l1/tch3.h>
 
-static struct osmo_conv_code gmr1_conv_tch3_speech;
-
-static void __attribute__ ((constructor))
-gmr1_tch3_init(void)
-{
-	/* Init convolutional coder */
-	memcpy(&gmr1_conv_tch3_speech, &gmr1_conv_tch3, sizeof(struct osmo_conv_code));
-	gmr1_conv_tch3_speech.len = 48;
-	gmr1_puncturer_generate(&gmr1_conv_tch3_speech, NULL, &gmr1_punct_k5_12_P12, NULL, 0);
-}
+#include "private.h"
 
 
 /*! \brief Stateless GMR-1 TCH3 channel coder
@@ -110,6 +103,42 @@ gmr1_tch3_encode(ubit_t *bits_e,
 	memcpy(bits_e+56, bits_xmy+52, 156);
 }
 
+/* e -> c : demultiplexing (around the status bits, then of the 2 frames
+ * for each mode), deciphering, unscrambling and de-interleaving */
+static struct gmr1_rxmap gmr1_tch3_rxmap[2][2][104];
+static uint64_t gmr1_tch3_sign[4];
+static pthread_once_t gmr1_tch3_rxmap_once = PTHREAD_ONCE_INIT;
+
+static void
+_tch3_rxmap_init(void)
+{
+	struct gmr1_rxmap map_epp[208];
+	struct gmr1_rxmap map_ep[104];
+	int m, i, j, kc;
+
+	gmr1_rxmap_segment(map_epp,     0,  0,  0,  52);
+	gmr1_rxmap_segment(map_epp+52, 56, 52, 52, 156);
+
+	gmr1_rxmap_sign_pack(gmr1_tch3_sign, map_epp, 208);
+
+	for (m=0; m<2; m++)
+	{
+		for (i=0; i<2; i++)
+		{
+			for (j=0; j<104; j++)
+				map_ep[j] = m ? map_epp[(104*i)+j] : map_epp[(j<<1)+i];
+
+			for (kc=0; kc<104; kc++) {
+				int ii, ij, kep;
+				ii = kc % 24;
+				ij = kc / 24;
+				kep = (ii < 8) ? (ij + 5*ii) : (ij + 4*ii + 8);
+				gmr1_tch3_rxmap[m][i][kc] = map_ep[kep];
+			}
+		}
+	}
+}
+
 /*! \brief Stateless GMR-1 TCH3 channel decoder
  *  \param[out] frame0 1st speech frame (10 byte / 80 bits, msb first)
  *  \param[out] frame1 2nd speech frame (10 byte / 80 bits, msb first)
@@ -126,52 +155,54 @@ gmr1_tch3_decode(uint8_t *frame0, uint8_t *frame1, ubit_t *bits_s,
                  const sbit_t *bits_e, const ubit_t *ciph, int m,
                  int *conv0_rv, int *conv1_rv)
 {
-	sbit_t bits_xmy[208];
-	sbit_t bits_epp[208];
+	pbit_t pciph[26];
+
+	if (ciph)
+		osmo_ubit2pbit(pciph, ciph, 208);
+
+	gmr1_tch3_decode_pciph(frame0, frame1, bits_s, bits_e,
+	                       ciph ? pciph : NULL, m, conv0_rv, conv1_rv);
+}
+
+/*! \brief Stateless GMR-1 TCH3 channel decoder, packed cipher stream
+ *  \param[out] frame0 1st speech frame (10 byte / 80 bits, msb first)
+ *  \param[out] frame1 2nd speech frame (10 byte / 80 bits, msb first)
+ *  \param[out] bits_s 4 status bits that were demultiplexed
+ *  \param[in] bits_e 212 softbits demodulated from a burst
+ *  \param[in] ciph 208 bits of cipher stream, packed MSB first (can be NULL)
+ *  \param[in] m Multiplexing mode (0 or 1)
+ *  \param[out] conv0_rv Return of the conv. decode of frame 0 (can be NULL)
+ *  \param[out] conv1_rv Return of the conv. decode of frame 1 (can be NULL)
+ *
+ * Same as \ref gmr1_tch3_decode, the cipher stream is combined with the
+ * scrambling signs 64 bits at a time (see \ref gmr1_rxmap_mask).
+ */
+void
+gmr1_tch3_decode_pciph(uint8_t *frame0, uint8_t *frame1, ubit_t *bits_s,
+                       const sbit_t *bits_e, const pbit_t *ciph, int m,
+                       int *conv0_rv, int *conv1_rv)
+{
+	uint64_t mask[4];
 	int rv, i, j;
 
 	for (i=0; i<4; i++)
 		bits_s[i] = bits_e[52+i] < 0;
 
-	memcpy(bits_xmy,    bits_e,     52);
-	memcpy(bits_xmy+52, bits_e+56, 156);
-
-	if (ciph) {
-		for (i=0; i<208; i++)
-			if (ciph[i])
-				bits_xmy[i] *= -1;
-	}
+	pthread_once(&gmr1_tch3_rxmap_once, _tch3_rxmap_init);
 
-	gmr1_scramble_sbit(bits_epp, bits_xmy, 208);
+	gmr1_rxmap_mask(mask, gmr1_tch3_sign, ciph, 208);
 
 	for (i=0; i<2; i++)
 	{
 		int *conv_rv = i ? conv1_rv : conv0_rv;
 		uint8_t *frame = i ? frame1 : frame0;
 
-		sbit_t bits_ep[104];
 		sbit_t bits_c[104];
 		ubit_t bits_d[80];
 
-		int kc;
-
-		if (m) {
-			for (j=0; j<104; j++)
-				bits_ep[j] = bits_epp[(104*i)+j];
-		} else {
-			for (j=0; j<104; j++)
-				bits_ep[j] = bits_epp[(j<<1)+i];
-		}
-
-		for (kc=0; kc<104; kc++) {
-			int ii, ij, kep;
-			ii = kc % 24;
-			ij = kc / 24;
-			kep = (ii < 8) ? (ij + 5*ii) : (ij + 4*ii + 8);
-			bits_c[kc] = bits_ep[kep];
-		}
+		gmr1_rxmap_apply_mask(bits_c, bits_e, mask, gmr1_tch3_rxmap[!!m][i], 104);
 
-		rv = osmo_conv_decode(&gmr1_conv_tch3_speech, bits_c, bits_d);
+		rv = gmr1_conv_decode(&gmr1_conv_tch3_speech, bits_c, bits_d);
 		if (conv_rv)
 			*conv_rv = rv;
 
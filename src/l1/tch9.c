@@ -26,6 +26,7 @@
  *  \brief Osmocom GMR-1 TCH9 channel coding implementation
  */
 
+#include <pthread.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -36,15 +37,13 @@
 #include <osmocom/gmr1/l1/conv.h>
 #include <osmocom/gmr1/l1/crc.h>
 #include <osmocom/gmr1/l1/interleave.h>
-#include <osmocom/gmr1/l1/punct.h>
+#include <osmocom/gmr1/l1/rxmap.h>
 #include <osmocom/gmr1/l1/scramb.h>
 
 #include <osmocom/gmr1/l1/tch9.h>
 
+#include "private.h"
 
-static struct osmo_conv_code gmr1_conv_tch9_24;
-static struct osmo_conv_code gmr1_conv_tch9_48;
-static struct osmo_conv_code gmr1_conv_tch9_96;
 
 static const struct osmo_conv_code *gmr1_conv_tch9[GMR1_TCH9_MAX] = {
 	[GMR1_TCH9_2k4] = &gmr1_conv_tch9_24,
@@ -52,32 +51,6 @@ static const struct osmo_conv_code *gmr1_conv_tch9[GMR1_TCH9_MAX] = {
 	[GMR1_TCH9_9k6] = &gmr1_conv_tch9_96,
 };
 
-static void __attribute__ ((constructor))
-gmr1_tch9_init(void)
-{
-	/* Init convolutional coders */
-	memcpy(&gmr1_conv_tch9_24, &gmr1_conv_k5_15, sizeof(struct osmo_conv_code));
-	gmr1_conv_tch9_24.len = 144;
-	gmr1_puncturer_generate(
-		&gmr1_conv_tch9_24,
-		&gmr1_punct_k5_15_P53, &gmr1_punct_k5_15_P23, &gmr1_punct_k5_15_Ps53, 41
-	);
-
-	memcpy(&gmr1_conv_tch9_48, &gmr1_conv_k5_13, sizeof(struct osmo_conv_code));
-	gmr1_conv_tch9_48.len = 240;
-	gmr1_puncturer_generate(
-		&gmr1_conv_tch9_48,
-		&gmr1_punct_k5_13_P15, &gmr1_punct_k5_13_P25, &gmr1_punct_k5_13_Ps15, 41
-	);
-
-	memcpy(&gmr1_conv_tch9_96, &gmr1_conv_k5_12, sizeof(struct osmo_conv_code));
-	gmr1_conv_tch9_96.len = 480;
-	gmr1_puncturer_generate(
-		&gmr1_conv_tch9_96,
-		&gmr1_punct_k5_12_P25, &gmr1_punct_k5_12_P23, &gmr1_punct_k5_12_Ps25, 158
-	);
-}
-
 
 /*! \brief GMR-1 TCH9 channel coder
  *  \param[out] bits_e 662 encoded bits of one NT9 burst
@@ -123,6 +96,22 @@ gmr1_tch9_encode(ubit_t *bits_e, const uint8_t *l2, enum gmr1_tch9_mode mode,
 	memcpy(bits_e+56, bits_my+52,  606);
 }
 
+/* e -> ep_epp_x : demultiplexing (around status and SACCH bits),
+ * deciphering and unscrambling. The inter burst de-interleaving that
+ * follows mixes in the previous bursts, so the map stops there. */
+static struct gmr1_rxmap gmr1_tch9_rxmap[648];
+static uint64_t gmr1_tch9_sign[11];
+static pthread_once_t gmr1_tch9_rxmap_once = PTHREAD_ONCE_INIT;
+
+static void
+_tch9_rxmap_init(void)
+{
+	gmr1_rxmap_segment(gmr1_tch9_rxmap,     0,  0,  0,  52);
+	gmr1_rxmap_segment(gmr1_tch9_rxmap+52, 66, 62, 52, 596);
+
+	gmr1_rxmap_sign_pack(gmr1_tch9_sign, gmr1_tch9_rxmap, 648);
+}
+
 /*! \brief GMR-1 TCH9 channel decoder
  *  \param[out] l2 L2 packet data
  *  \param[out] bits_sacch 10 saach bits demultiplexed
@@ -141,33 +130,58 @@ gmr1_tch9_decode(uint8_t *l2, sbit_t *bits_sacch, sbit_t *bits_status,
                  const sbit_t *bits_e, enum gmr1_tch9_mode mode,
 		 const ubit_t *ciph, struct gmr1_interleaver *il,
                  int *conv_rv)
+{
+	pbit_t pciph[83];
+
+	if (ciph)
+		osmo_ubit2pbit(pciph, ciph, 658);
+
+	gmr1_tch9_decode_pciph(l2, bits_sacch, bits_status, bits_e, mode,
+	                       ciph ? pciph : NULL, il, conv_rv);
+}
+
+/*! \brief GMR-1 TCH9 channel decoder, packed cipher stream
+ *  \param[out] l2 L2 packet data
+ *  \param[out] bits_sacch 10 saach bits demultiplexed
+ *  \param[out] bits_status 4 status bits demultiplexed
+ *  \param[in] bits_e 662 encoded bits of one NT9 burst
+ *  \param[in] mode Channel encoding mode
+ *  \param[in] ciph 658 bits of cipher stream, packed MSB first (can be NULL)
+ *  \param[inout] il Inter-burst interleaver state
+ *  \param[out] conv_rv Return of the convolutional decode (can be NULL)
+ *
+ * Same as \ref gmr1_tch9_decode, the cipher stream is combined with the
+ * scrambling signs 64 bits at a time (see \ref gmr1_rxmap_mask).
+ */
+void
+gmr1_tch9_decode_pciph(uint8_t *l2, sbit_t *bits_sacch, sbit_t *bits_status,
+                       const sbit_t *bits_e, enum gmr1_tch9_mode mode,
+                       const pbit_t *ciph, struct gmr1_interleaver *il,
+                       int *conv_rv)
 {
 	const struct osmo_conv_code *cc = gmr1_conv_tch9[mode];
-	sbit_t bits_my[658];
 	sbit_t bits_ep_epp_x[648];
 	sbit_t bits_c[648];
 	ubit_t bits_u[480];
+	uint64_t mask[11];
 	int i, rv;
 
-	memcpy(bits_my,     bits_e,     52);
-	memcpy(bits_status, bits_e+52,   4);
-	memcpy(bits_my+52,  bits_e+56, 606);
+	memcpy(bits_status, bits_e+52, 4);
 
-	if (ciph) {
-		for (i=0; i<658; i++)
-			if (ciph[i])
-				bits_my[i] *= -1;
-	}
+	pthread_once(&gmr1_tch9_rxmap_once, _tch9_rxmap_init);
+
+	/* SACCH bits are not scrambled, their mask is the cipher stream */
+	gmr1_rxmap_mask(mask, gmr1_tch9_sign, ciph, 658);
+
+	for (i=0; i<10; i++)
+		bits_sacch[i] = ((mask[0] >> (63 - (52+i))) & 1) ? -bits_e[56+i] : bits_e[56+i];
 
-	memcpy(bits_ep_epp_x,    bits_my,     52);
-	memcpy(bits_sacch,       bits_my+52,  10);
-	memcpy(bits_ep_epp_x+52, bits_my+62, 596);
+	gmr1_rxmap_apply_mask(bits_ep_epp_x, bits_e, mask, gmr1_tch9_rxmap, 648);
 
-	gmr1_scramble_sbit(bits_ep_epp_x, bits_ep_epp_x, 648);
 	gmr1_deinterleave_inter(il, bits_ep_epp_x, bits_ep_epp_x);
 	gmr1_deinterleave_intra(bits_c, bits_ep_epp_x, 81);
 
-	rv = osmo_conv_decode(cc, bits_c, bits_u);
+	rv = gmr1_conv_decode(cc, bits_c, bits_u);
 	if (conv_rv)
 		*conv_rv = rv;
 
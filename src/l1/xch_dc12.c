@@ -26,31 +26,19 @@
  *  \brief Osmocom GMR-1 xCH over DC12 channel coding implementation
  */
 
+#include <pthread.h>
 #include <stdint.h>
-#include <string.h>
 
 #include <osmocom/core/bits.h>
 #include <osmocom/core/conv.h>
-#include <osmocom/core/crc16gen.h>
 
 #include <osmocom/gmr1/l1/conv.h>
 #include <osmocom/gmr1/l1/crc.h>
 #include <osmocom/gmr1/l1/interleave.h>
-#include <osmocom/gmr1/l1/punct.h>
+#include <osmocom/gmr1/l1/rxmap.h>
 #include <osmocom/gmr1/l1/scramb.h>
 
-
-static struct osmo_conv_code gmr1_conv_xch_dc12;
-
-static void __attribute__ ((constructor))
-gmr1_xch_dc12_init(void)
-{
-	/* Init convolutional coder */
-	memcpy(&gmr1_conv_xch_dc12, &gmr1_conv_k9_13, sizeof(struct osmo_conv_code));
-	gmr1_conv_xch_dc12.len = 208;
-	gmr1_conv_xch_dc12.term = CONV_TERM_TAIL_BITING;
-	gmr1_puncturer_generate(&gmr1_conv_xch_dc12, NULL, &gmr1_punct_k9_13_P1213, NULL, 0);
-}
+#include "private.h"
 
 
 /*! \brief Stateless GMR-1 xCH over DC12 channel coder
@@ -68,12 +56,25 @@ gmr1_xch_dc12_encode(ubit_t *bits_e, const uint8_t *l2)
 	ubit_t bits_ep[432];
 
 	osmo_pbit2ubit_ext(bits_u, 0, l2, 0, 192, 1);
-	osmo_crc16gen_set_bits(&gmr1_crc16, bits_u, 192, bits_u+192);
+	gmr1_crc_set_pbits(&gmr1_crc16_table, l2, 0, 192, bits_u+192);
 	osmo_conv_encode(&gmr1_conv_xch_dc12, bits_u, bits_c);
 	gmr1_interleave_intra(bits_ep, bits_c, 54);
 	gmr1_scramble_ubit(bits_e, bits_ep, 432);
 }
 
+/* e -> c : unscrambling + de-interleaving */
+static struct gmr1_rxmap gmr1_xch_dc12_rxmap[432];
+static pthread_once_t gmr1_xch_dc12_rxmap_once = PTHREAD_ONCE_INIT;
+
+static void
+_xch_dc12_rxmap_init(void)
+{
+	struct gmr1_rxmap map_ep[432];
+
+	gmr1_rxmap_segment(map_ep, 0, 0, 0, 432);
+	gmr1_rxmap_intra(gmr1_xch_dc12_rxmap, map_ep, 54);
+}
+
 /*! \brief Stateless GMR-1 xCH over DC12 channel decoder
  *  \param[out] l2 L2 packet data
  *  \param[in] bits_e Data bits of a burst
@@ -86,22 +87,21 @@ gmr1_xch_dc12_encode(ubit_t *bits_e, const uint8_t *l2)
 int
 gmr1_xch_dc12_decode(uint8_t *l2, const sbit_t *bits_e, int *conv_rv)
 {
-	sbit_t bits_ep[432];
 	sbit_t bits_c[432];
 	ubit_t bits_u[208];
 	int rv;
 
-	gmr1_scramble_sbit(bits_ep, bits_e, 432);
-	gmr1_deinterleave_intra(bits_c, bits_ep, 54);
+	pthread_once(&gmr1_xch_dc12_rxmap_once, _xch_dc12_rxmap_init);
+	gmr1_rxmap_apply(bits_c, bits_e, NULL, gmr1_xch_dc12_rxmap, 432);
 
-	rv = osmo_conv_decode(&gmr1_conv_xch_dc12, bits_c, bits_u);
+	rv = gmr1_conv_decode(&gmr1_conv_xch_dc12, bits_c, bits_u);
 	if (conv_rv)
 		*conv_rv = rv;
 
-	rv = osmo_crc16gen_check_bits(&gmr1_crc16, bits_u, 192, bits_u+192);
-
 	osmo_ubit2pbit_ext(l2, 0, bits_u, 0, 192, 1);
 
+	rv = gmr1_crc_check_pbits(&gmr1_crc16_table, l2, 0, 192, bits_u+192);
+
 	return rv;
 }
 
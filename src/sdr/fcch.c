@@ -29,7 +29,9 @@
 #include <complex.h>
 #include <math.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <fftw3.h>
 
@@ -38,6 +40,7 @@
 
 #include <osmocom/gmr1/sdr/defs.h>
 #include <osmocom/gmr1/sdr/fcch.h>
+#include <osmocom/gmr1/sdr/fft.h>
 
 
 /* ------------------------------------------------------------------------ */
@@ -193,6 +196,211 @@ gmr1_sdr_fcch_gen_dual_chirp(const struct gmr1_fcch_burst *burst_type, int sps)
 }
 
 
+/* ------------------------------------------------------------------------ */
+/* Reference waveform cache                                                 */
+/* ------------------------------------------------------------------------ */
+
+/*! \brief Cached FCCH references for a given burst type and oversampling */
+struct gmr1_fcch_ref
+{
+	struct gmr1_fcch_ref *next;	/*!< \brief Next cache entry */
+
+	const struct gmr1_fcch_burst *burst_type; /*!< \brief Burst format */
+	int sps;			/*!< \brief Oversampling      */
+
+	struct osmo_cxvec *up;		/*!< \brief Up chirp          */
+	struct osmo_cxvec *down;	/*!< \brief Down chirp        */
+	struct osmo_cxvec *dual;	/*!< \brief Dual chirp        */
+
+	int fft_len;			/*!< \brief Overlap-save FFT size */
+	float complex *dual_spec;	/*!< \brief Conj. spectrum of dual chirp (/N) */
+	const struct gmr1_fft_plan *fft_fwd; /*!< \brief Forward FFT plan */
+	const struct gmr1_fft_plan *fft_inv; /*!< \brief Inverse FFT plan */
+};
+
+/*! \brief Lock protecting the reference cache list */
+static pthread_mutex_t g_fcch_ref_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*! \brief Reference cache list. Entries are never modified once inserted */
+static struct gmr1_fcch_ref *g_fcch_refs = NULL;
+
+/*! \brief Release a reference cache entry
+ *  \param[in] ref The entry to release
+ */
+static void
+_gmr1_fcch_ref_free(struct gmr1_fcch_ref *ref)
+{
+	fftwf_free(ref->dual_spec);
+
+	osmo_cxvec_free(ref->dual);
+	osmo_cxvec_free(ref->down);
+	osmo_cxvec_free(ref->up);
+
+	free(ref);
+}
+
+/*! \brief Generate a reference cache entry
+ *  \param[in] burst_type FCCH burst format description
+ *  \param[in] sps Oversampling rate
+ *  \returns A newly allocated entry, NULL for errors
+ *
+ * Besides the three chirps, this precomputes the conjugated spectrum of the
+ * zero-padded dual chirp so that correlating it with a block of signal is
+ * only a forward FFT, a multiply and an inverse FFT.
+ */
+static struct gmr1_fcch_ref *
+_gmr1_fcch_ref_gen(const struct gmr1_fcch_burst *burst_type, int sps)
+{
+	struct gmr1_fcch_ref *ref;
+	float complex *buf = NULL;
+	int i, n;
+
+	ref = calloc(1, sizeof(struct gmr1_fcch_ref));
+	if (!ref)
+		return NULL;
+
+	ref->burst_type = burst_type;
+	ref->sps = sps;
+
+	/* Chirps */
+	ref->up   = gmr1_sdr_fcch_gen_up_chirp(burst_type, sps);
+	ref->down = gmr1_sdr_fcch_gen_down_chirp(burst_type, sps);
+	ref->dual = gmr1_sdr_fcch_gen_dual_chirp(burst_type, sps);
+
+	if (!ref->up || !ref->down || !ref->dual)
+		goto err;
+
+	/* FFT size for overlap-save: at least 4x the reference length */
+	for (n=1; n<(4 * ref->dual->len); n<<=1);
+
+	buf = fftwf_malloc(sizeof(float complex) * n);
+	ref->dual_spec = fftwf_malloc(sizeof(float complex) * n);
+
+	if (!buf || !ref->dual_spec)
+		goto err;
+
+	ref->fft_fwd = gmr1_fft_plan_get(n, FFTW_FORWARD);
+	ref->fft_inv = gmr1_fft_plan_get(n, FFTW_BACKWARD);
+
+	if (!ref->fft_fwd || !ref->fft_inv)
+		goto err;
+
+	ref->fft_len = n;
+
+	/* Spectrum of the dual chirp, including the 1/N of the inverse FFT */
+	memset(buf, 0x00, sizeof(float complex) * n);
+	memcpy(buf, ref->dual->data, sizeof(float complex) * ref->dual->len);
+
+	gmr1_fft_execute(ref->fft_fwd, buf);
+
+	for (i=0; i<n; i++)
+		ref->dual_spec[i] = conjf(buf[i]) / (float)n;
+
+	fftwf_free(buf);
+
+	return ref;
+
+err:
+	fftwf_free(buf);
+	_gmr1_fcch_ref_free(ref);
+	return NULL;
+}
+
+/*! \brief Get the cached references for a burst type and oversampling
+ *  \param[in] burst_type FCCH burst format description
+ *  \param[in] sps Oversampling rate
+ *  \returns The cache entry (not to be modified or freed), NULL for errors
+ *
+ * Entries are generated on first use and kept until the process exits.
+ */
+static const struct gmr1_fcch_ref *
+_gmr1_fcch_ref_get(const struct gmr1_fcch_burst *burst_type, int sps)
+{
+	struct gmr1_fcch_ref *ref;
+
+	pthread_mutex_lock(&g_fcch_ref_lock);
+
+	for (ref=g_fcch_refs; ref; ref=ref->next)
+		if ((ref->burst_type == burst_type) && (ref->sps == sps))
+			break;
+
+	if (!ref) {
+		ref = _gmr1_fcch_ref_gen(burst_type, sps);
+		if (ref) {
+			ref->next = g_fcch_refs;
+			g_fcch_refs = ref;
+		}
+	}
+
+	pthread_mutex_unlock(&g_fcch_ref_lock);
+
+	return ref;
+}
+
+/*! \brief Correlates a signal with the dual chirp using overlap-save FFTs
+ *  \param[in] ref Cached references
+ *  \param[in] win The signal to correlate with
+ *  \returns A newly allocated vector with the correlation, NULL for errors
+ *
+ * Computes the same thing as osmo_cxvec_correlate(ref->dual, win, 1, NULL).
+ */
+static struct osmo_cxvec *
+_gmr1_fcch_ref_correlate(const struct gmr1_fcch_ref *ref,
+                         struct osmo_cxvec *win)
+{
+	struct osmo_cxvec *out;
+	float complex *buf;
+	int n = ref->fft_len;
+	int v = n - ref->dual->len + 1;
+	int w, b, i, l;
+
+	w = win->len - ref->dual->len + 1;
+	if (w <= 0)
+		return NULL;
+
+	out = osmo_cxvec_alloc(w);
+	buf = fftwf_malloc(sizeof(float complex) * n);
+
+	if (!out || !buf) {
+		osmo_cxvec_free(out);
+		fftwf_free(buf);
+		return NULL;
+	}
+
+	for (b=0; b<w; b+=v)
+	{
+		/* Load block (zero padded at the end of the signal) */
+		l = win->len - b;
+		if (l > n)
+			l = n;
+
+		memcpy(buf, &win->data[b], sizeof(float complex) * l);
+		memset(&buf[l], 0x00, sizeof(float complex) * (n - l));
+
+		/* Circular correlation */
+		gmr1_fft_execute(ref->fft_fwd, buf);
+
+		for (i=0; i<n; i++)
+			buf[i] *= ref->dual_spec[i];
+
+		gmr1_fft_execute(ref->fft_inv, buf);
+
+		/* Only the first v points are valid */
+		l = w - b;
+		if (l > v)
+			l = v;
+
+		memcpy(&out->data[b], buf, sizeof(float complex) * l);
+	}
+
+	out->len = w;
+
+	fftwf_free(buf);
+
+	return out;
+}
+
+
 /* ------------------------------------------------------------------------ */
 /* Raw FCCH detection functions                                             */
 /* ------------------------------------------------------------------------ */
@@ -213,14 +421,14 @@ gmr1_fcch_rough(const struct gmr1_fcch_burst *burst_type,
                 struct osmo_cxvec *search_win_in, int sps, float freq_shift,
                 int *toa)
 {
-	struct osmo_cxvec *ref = NULL;
+	const struct gmr1_fcch_ref *ref;
 	struct osmo_cxvec *search_win = NULL;
 	struct osmo_cxvec *corr = NULL;
 	float pos;
 	int rv = 0;
 
-	/* Generate reference dual chirp */
-	ref = gmr1_sdr_fcch_gen_dual_chirp(burst_type, 1);
+	/* Get reference dual chirp */
+	ref = _gmr1_fcch_ref_get(burst_type, 1);
 	if (!ref) {
 		rv = -ENOMEM;
 		goto err;
@@ -228,9 +436,17 @@ gmr1_fcch_rough(const struct gmr1_fcch_burst *burst_type,
 
 	/* Normalize and decimate the search window */
 	search_win = osmo_cxvec_sig_normalize(search_win_in, sps, freq_shift, NULL);
+	if (!search_win) {
+		rv = -ENOMEM;
+		goto err;
+	}
 
 	/* Correlate with the reference */
-	corr = osmo_cxvec_correlate(ref, search_win, 1, NULL);
+	corr = _gmr1_fcch_ref_correlate(ref, search_win);
+	if (!corr) {
+		rv = -EINVAL;
+		goto err;
+	}
 
 	DEBUG_SIGNAL("fcch_rough", corr);
 
@@ -244,7 +460,6 @@ gmr1_fcch_rough(const struct gmr1_fcch_burst *burst_type,
 err:
 	osmo_cxvec_free(corr);
 	osmo_cxvec_free(search_win);
-	osmo_cxvec_free(ref);
 
 	return rv;
 }
@@ -325,71 +540,42 @@ _peak_record(const struct gmr1_fcch_burst *burst_type,
 		*n = *n + 1;
 }
 
-/*! \brief Rough FCCH timing acquisition w/ multiple FCCH detection
+/*! \brief Internal method to find FCCH peaks in two cycles of correlation power
  *  \param[in] burst_type FCCH burst format description
- *  \param[in] search_win_in Complex signal where to search for FCCH
- *  \param[in] sps Oversampling used in the input complex signal
- *  \param[in] freq_shift Frequency shift to pre-apply to search_win_in (rad/sym)
- *  \param[out] peaks_toa Array of floats to store the returned alignements
- *  \param[in] N Maximum number of alignements to returns
- *  \returns A positive value of the number of FCCH returned. -errno for errors
+ *  \param[in] corr_pwr Correlation power (1 sps) starting at the window start
+ *  \param[in] len Length of corr_pwr
+ *  \param[out] fold Folded power return array (Lw long, can be corr_pwr)
+ *  \param[in] sps Oversampling ratio of the returned TOAs
+ *  \param[out] peaks_toa Array to store the TOA of the peaks
+ *  \param[out] peaks_pwr Array to store the power of the peaks
+ *  \param[in] N Size of the above arrays
+ *  \param[out] Lp_p Pointer to the measured period length return variable
+ *  \returns A positive value of the number of peaks found. -errno for errors
  *
- * This method can detect multiple overlapping FCCH and returns alignements for
- * all of them. To do so it needs at least 650 ms worth of data (two SI cycles
- * plus some margin).
+ * The window covers one BCCH period plus a burst length (Lw) and corr_pwr
+ * must extend at least one more period beyond that so that each point can be
+ * combined with its counterpart one period later.
  */
-int
-gmr1_fcch_rough_multi(const struct gmr1_fcch_burst *burst_type,
-                      struct osmo_cxvec *search_win_in, int sps, float freq_shift,
-                      int *peaks_toa, int N)
+static int
+_gmr1_fcch_fold_peaks(const struct gmr1_fcch_burst *burst_type,
+                      float *corr_pwr, int len, float *fold, int sps,
+                      int *peaks_toa, float *peaks_pwr, int N, int *Lp_p)
 {
-	struct osmo_cxvec *ref = NULL;
-	struct osmo_cxvec *search_win = NULL;
-	struct osmo_cxvec *corr = NULL;
-	float *corr_pwr = NULL;
-	float pwr_max, pwrs[2], peaks[2], avg, stddev, th, peaks_pwr[N];
+	float pwr_max, pwrs[2], peaks[2], avg, stddev, th;
 	int Lw, Lp, nLp, i, pwr_max_idx, a, peaks_cnt;
-	int rv;
-
-	/* Safety : need 650 ms of signal */
-	if (search_win_in->len < ((650 * GMR1_SYM_RATE * sps) / 1000))
-		return -EINVAL;
-
-	/* Generate reference dual chirp */
-	ref = gmr1_sdr_fcch_gen_dual_chirp(burst_type, 1);
-	if (!ref) {
-		rv = -ENOMEM;
-		goto err;
-	}
-
-	/* Normalize and decimate the search window */
-	search_win = osmo_cxvec_sig_normalize(search_win_in, sps, freq_shift, NULL);
-
-	/* Correlate with the reference */
-	corr = osmo_cxvec_correlate(ref, search_win, 1, NULL);
-
-	DEBUG_SIGNAL("fcch_rough_multi", corr);
-
-	/* Convert to power + find peak within first 330 ms */
-	corr_pwr = malloc(sizeof(float) * corr->len);
-	if (!corr_pwr) {
-		rv = -ENOMEM;
-		goto err;
-	}
 
 	Lw = (320 * GMR1_SYM_RATE) / 1000;	/* Len window */
 	Lw += burst_type->len;
 
 	Lp = (320 * GMR1_SYM_RATE) / 1000;	/* Len period */
 
+	/* Find peak within first 330 ms */
 	pwr_max_idx = 0;
 	pwr_max = 0.0f;
 
-	for (i=0; i<corr->len; i++) {
-		float e = osmo_normsqf(corr->data[i]);
-		corr_pwr[i] = e;
-		if ((e > pwr_max) && (i < Lw)) {
-			pwr_max = e;
+	for (i=0; (i<Lw) && (i<len); i++) {
+		if (corr_pwr[i] > pwr_max) {
+			pwr_max = corr_pwr[i];
 			pwr_max_idx = i;
 		}
 	}
@@ -403,14 +589,14 @@ gmr1_fcch_rough_multi(const struct gmr1_fcch_burst *burst_type,
 	{
 		int j = pwr_max_idx + i;
 
-		if ((j > 0) && (j < corr->len)) {
+		if ((j > 0) && (j < len)) {
 			pwrs[0]  += corr_pwr[j];
 			peaks[0] += corr_pwr[j] * j;
 		}
 
 		j += Lp;
 
-		if ((j > 0) && (j < corr->len)) {
+		if ((j > 0) && (j < len)) {
 			pwrs[1]  += corr_pwr[j];
 			peaks[1] += corr_pwr[j] * j;
 		}
@@ -422,19 +608,20 @@ gmr1_fcch_rough_multi(const struct gmr1_fcch_burst *burst_type,
 	nLp = (int)round(peaks[1] - peaks[0]);
 
 	/* Safety */
-	if (abs(nLp - Lp) > 10) {
-		rv = -EINVAL;
-		goto err;
-	}
+	if (abs(nLp - Lp) > 10)
+		return -EINVAL;
 
 	Lp = nLp;
 
+	if (Lp_p)
+		*Lp_p = Lp;
+
 	/* 'Mix' the two cycles to improve signal. Compute avg at the same time */
 	avg = 0.0f;
 
 	for (i=0; i<Lw; i++) {
 		float v = sqrtf(corr_pwr[i] * corr_pwr[i+Lp]);
-		corr_pwr[i] = v;
+		fold[i] = v;
 		avg += v;
 	}
 
@@ -444,7 +631,7 @@ gmr1_fcch_rough_multi(const struct gmr1_fcch_burst *burst_type,
 	stddev = 0.0f;
 
 	for (i=0; i<Lw; i++) {
-		float v = corr_pwr[i] - avg;
+		float v = fold[i] - avg;
 		stddev += v * v;
 	}
 
@@ -457,7 +644,7 @@ gmr1_fcch_rough_multi(const struct gmr1_fcch_burst *burst_type,
 	peaks_cnt = 0;
 
 	for (i=1, a=0; i<Lw-1; i++) {
-		if (corr_pwr[i] > th) {
+		if (fold[i] > th) {
 			float p_pwr, p_fpos;
 			int p_pos;
 
@@ -467,8 +654,8 @@ gmr1_fcch_rough_multi(const struct gmr1_fcch_burst *burst_type,
 			a = 1;
 
 			/* Precise peak power and position */
-			p_pwr = corr_pwr[i-1] + corr_pwr[i] + corr_pwr[i+1];
-			p_fpos = (-corr_pwr[i-1] + corr_pwr[i+1]) / p_pwr;
+			p_pwr = fold[i-1] + fold[i] + fold[i+1];
+			p_fpos = (-fold[i-1] + fold[i+1]) / p_pwr;
 			p_pos = (int)round((i + p_fpos) * sps);
 
 			/* Record the peak */
@@ -482,6 +669,80 @@ gmr1_fcch_rough_multi(const struct gmr1_fcch_burst *burst_type,
 		}
 	}
 
+	return peaks_cnt;
+}
+
+/*! \brief Rough FCCH timing acquisition w/ multiple FCCH detection
+ *  \param[in] burst_type FCCH burst format description
+ *  \param[in] search_win_in Complex signal where to search for FCCH
+ *  \param[in] sps Oversampling used in the input complex signal
+ *  \param[in] freq_shift Frequency shift to pre-apply to search_win_in (rad/sym)
+ *  \param[out] peaks_toa Array of floats to store the returned alignements
+ *  \param[in] N Maximum number of alignements to returns
+ *  \returns A positive value of the number of FCCH returned. -errno for errors
+ *
+ * This method can detect multiple overlapping FCCH and returns alignements for
+ * all of them. To do so it needs at least 650 ms worth of data (two SI cycles
+ * plus some margin).
+ */
+int
+gmr1_fcch_rough_multi(const struct gmr1_fcch_burst *burst_type,
+                      struct osmo_cxvec *search_win_in, int sps, float freq_shift,
+                      int *peaks_toa, int N)
+{
+	const struct gmr1_fcch_ref *ref;
+	struct osmo_cxvec *search_win = NULL;
+	struct osmo_cxvec *corr = NULL;
+	float *corr_pwr = NULL;
+	float peaks_pwr[N];
+	int i, peaks_cnt;
+	int rv;
+
+	/* Safety : need 650 ms of signal */
+	if (search_win_in->len < ((650 * GMR1_SYM_RATE * sps) / 1000))
+		return -EINVAL;
+
+	/* Get reference dual chirp */
+	ref = _gmr1_fcch_ref_get(burst_type, 1);
+	if (!ref) {
+		rv = -ENOMEM;
+		goto err;
+	}
+
+	/* Normalize and decimate the search window */
+	search_win = osmo_cxvec_sig_normalize(search_win_in, sps, freq_shift, NULL);
+	if (!search_win) {
+		rv = -ENOMEM;
+		goto err;
+	}
+
+	/* Correlate with the reference */
+	corr = _gmr1_fcch_ref_correlate(ref, search_win);
+	if (!corr) {
+		rv = -EINVAL;
+		goto err;
+	}
+
+	DEBUG_SIGNAL("fcch_rough_multi", corr);
+
+	/* Convert to power */
+	corr_pwr = malloc(sizeof(float) * corr->len);
+	if (!corr_pwr) {
+		rv = -ENOMEM;
+		goto err;
+	}
+
+	for (i=0; i<corr->len; i++)
+		corr_pwr[i] = osmo_normsqf(corr->data[i]);
+
+	/* Fold the two cycles and find peaks (in-place) */
+	peaks_cnt = _gmr1_fcch_fold_peaks(burst_type, corr_pwr, corr->len,
+		corr_pwr, sps, peaks_toa, peaks_pwr, N, NULL);
+	if (peaks_cnt < 0) {
+		rv = peaks_cnt;
+		goto err;
+	}
+
 	rv = peaks_cnt;
 
 	/* Cleanup */
@@ -490,12 +751,230 @@ err:
 
 	osmo_cxvec_free(corr);
 	osmo_cxvec_free(search_win);
-	osmo_cxvec_free(ref);
 
 	return rv;
 }
 
 
+/* ------------------------------------------------------------------------ */
+/* Streaming FCCH detection                                                 */
+/* ------------------------------------------------------------------------ */
+
+/*! \brief Time constant (in symbols) of the DC offset tracking */
+#define FCCH_STREAM_DC_TC	1024
+
+/*! \brief Max number of FCCH reported per BCCH period */
+#define FCCH_STREAM_MAX_PEAKS	16
+
+/*! \brief Streaming FCCH detector state */
+struct gmr1_fcch_stream
+{
+	const struct gmr1_fcch_burst *burst_type;	/*!< \brief Burst format */
+	const struct gmr1_fcch_ref *ref;	/*!< \brief Cached references  */
+	int sps;				/*!< \brief Input oversampling */
+
+	gmr1_fcch_stream_cb_t cb;		/*!< \brief Detection callback */
+	void *cb_data;				/*!< \brief Callback user data */
+
+	/* Input conditioning */
+	int64_t in_pos;			/*!< \brief Input samples consumed     */
+	float complex rot;		/*!< \brief Current freq shift phasor  */
+	float complex rot_step;		/*!< \brief Per symbol phasor step     */
+	float complex dc;		/*!< \brief Tracked DC offset          */
+	int dc_cnt;			/*!< \brief Samples in DC estimate     */
+
+	/* Overlap-save correlation */
+	float complex *sig;		/*!< \brief Pending 1 sps samples (N)  */
+	float complex *buf;		/*!< \brief FFT work buffer (N)        */
+	int sig_len;			/*!< \brief Samples in sig             */
+
+	/* Correlation power over two periods */
+	float *pwr;			/*!< \brief Correlation power          */
+	float *fold;			/*!< \brief Folded power (Lw)          */
+	int pwr_len;			/*!< \brief Points in pwr              */
+	int pwr_size;			/*!< \brief Points needed for a window */
+	int64_t pwr_base;		/*!< \brief Symbol index of pwr[0]     */
+};
+
+/*! \brief Allocates a streaming FCCH detector
+ *  \param[in] burst_type FCCH burst format description
+ *  \param[in] sps Oversampling used in the input complex signal
+ *  \param[in] freq_shift Frequency shift to pre-apply to the input (rad/sym)
+ *  \param[in] cb Callback called for each detected FCCH
+ *  \param[in] cb_data User data passed to the callback
+ *  \returns A newly allocated detector, to be freed with
+ *            \ref gmr1_fcch_stream_release
+ *
+ * This performs the same detection as \ref gmr1_fcch_rough_multi but on a
+ * stream of samples fed in blocks of any size. The memory used is bounded
+ * (about two BCCH periods of correlation power) whatever the stream length.
+ */
+struct gmr1_fcch_stream *
+gmr1_fcch_stream_alloc(const struct gmr1_fcch_burst *burst_type,
+                       int sps, float freq_shift,
+                       gmr1_fcch_stream_cb_t cb, void *cb_data)
+{
+	struct gmr1_fcch_stream *fs;
+	int Lw, Lp;
+
+	if (sps < 1)
+		return NULL;
+
+	fs = calloc(1, sizeof(struct gmr1_fcch_stream));
+	if (!fs)
+		return NULL;
+
+	fs->burst_type = burst_type;
+	fs->sps = sps;
+	fs->cb = cb;
+	fs->cb_data = cb_data;
+
+	fs->rot = 1.0f;
+	fs->rot_step = cexpf(I * freq_shift);
+
+	/* References */
+	fs->ref = _gmr1_fcch_ref_get(burst_type, 1);
+	if (!fs->ref)
+		goto err;
+
+	/* Buffers */
+	Lp = (320 * GMR1_SYM_RATE) / 1000;
+	Lw = Lp + burst_type->len;
+
+	fs->pwr_size = Lw + Lp + 11;
+
+	fs->sig  = fftwf_malloc(sizeof(float complex) * fs->ref->fft_len);
+	fs->buf  = fftwf_malloc(sizeof(float complex) * fs->ref->fft_len);
+	fs->pwr  = malloc(sizeof(float) * fs->pwr_size);
+	fs->fold = malloc(sizeof(float) * Lw);
+
+	if (!fs->sig || !fs->buf || !fs->pwr || !fs->fold)
+		goto err;
+
+	return fs;
+
+err:
+	gmr1_fcch_stream_release(fs);
+	return NULL;
+}
+
+/*! \brief Release a streaming FCCH detector
+ *  \param[in] fs The detector to release
+ */
+void
+gmr1_fcch_stream_release(struct gmr1_fcch_stream *fs)
+{
+	if (!fs)
+		return;
+
+	free(fs->fold);
+	free(fs->pwr);
+	fftwf_free(fs->buf);
+	fftwf_free(fs->sig);
+
+	free(fs);
+}
+
+/*! \brief Analyze a full window of correlation power and report FCCHs
+ *  \param[in] fs Streaming FCCH detector
+ *
+ * Each FCCH is reported once per window, with a TOA inside the first BCCH
+ * period of the window. The window then slides by one period.
+ */
+static void
+_gmr1_fcch_stream_window(struct gmr1_fcch_stream *fs)
+{
+	int peaks_toa[FCCH_STREAM_MAX_PEAKS];
+	float peaks_pwr[FCCH_STREAM_MAX_PEAKS];
+	int n, i, Lp, step;
+
+	n = _gmr1_fcch_fold_peaks(fs->burst_type, fs->pwr, fs->pwr_len,
+		fs->fold, fs->sps, peaks_toa, peaks_pwr, FCCH_STREAM_MAX_PEAKS, &Lp);
+
+	for (i=0; i<n; i++) {
+		int toa = peaks_toa[i];
+
+		if (toa >= (Lp * fs->sps))
+			toa -= Lp * fs->sps;
+
+		fs->cb(fs->cb_data, (fs->pwr_base * fs->sps) + toa, peaks_pwr[i]);
+	}
+
+	/* Slide by one nominal period */
+	step = (320 * GMR1_SYM_RATE) / 1000;
+
+	memmove(fs->pwr, &fs->pwr[step], sizeof(float) * (fs->pwr_len - step));
+	fs->pwr_len  -= step;
+	fs->pwr_base += step;
+}
+
+/*! \brief Feed a block of samples to a streaming FCCH detector
+ *  \param[in] fs Streaming FCCH detector
+ *  \param[in] blk Block of samples (any length, contiguous with previous)
+ *
+ * The callback is invoked for every FCCH confirmed over two BCCH periods,
+ * from within this function. TOAs are absolute sample indexes in the stream
+ * (at the input oversampling) and powers are relative to the input level.
+ */
+void
+gmr1_fcch_stream_process(struct gmr1_fcch_stream *fs, struct osmo_cxvec *blk)
+{
+	const struct gmr1_fcch_ref *ref = fs->ref;
+	int n = ref->fft_len;
+	int l = ref->dual->len;
+	int i, j;
+
+	/* Start at the first sample of the block that's on a symbol */
+	i = (int)((fs->sps - (fs->in_pos % fs->sps)) % fs->sps);
+
+	for (; i<blk->len; i+=fs->sps)
+	{
+		float complex v;
+
+		/* Shift, remove DC (plain running mean at first) and accumulate */
+		v = blk->data[i] * fs->rot;
+
+		if (fs->dc_cnt < FCCH_STREAM_DC_TC)
+			fs->dc_cnt++;
+
+		fs->dc += (v - fs->dc) / (float)fs->dc_cnt;
+		fs->sig[fs->sig_len++] = v - fs->dc;
+
+		fs->rot *= fs->rot_step;
+
+		if (fs->sig_len < n)
+			continue;
+
+		/* Keep the phasor on the unit circle */
+		fs->rot /= cabsf(fs->rot);
+
+		/* Correlate the block */
+		memcpy(fs->buf, fs->sig, sizeof(float complex) * n);
+
+		gmr1_fft_execute(ref->fft_fwd, fs->buf);
+
+		for (j=0; j<n; j++)
+			fs->buf[j] *= ref->dual_spec[j];
+
+		gmr1_fft_execute(ref->fft_inv, fs->buf);
+
+		/* Append the valid points and analyze when we have a window */
+		for (j=0; j<(n-l+1); j++) {
+			fs->pwr[fs->pwr_len++] = osmo_normsqf(fs->buf[j]);
+
+			if (fs->pwr_len == fs->pwr_size)
+				_gmr1_fcch_stream_window(fs);
+		}
+
+		/* Keep the overlap */
+		memmove(fs->sig, &fs->sig[n-l+1], sizeof(float complex) * (l-1));
+		fs->sig_len = l - 1;
+	}
+
+	fs->in_pos += blk->len;
+}
+
+
 /*! \brief Fine FCCH timing & frequency acquisition
  *  \param[in] burst_type FCCH burst format description
  *  \param[in] burst_in Complex signal of the FCCH burst
@@ -514,25 +993,27 @@ gmr1_fcch_fine(const struct gmr1_fcch_burst *burst_type,
                struct osmo_cxvec *burst_in, int sps, float freq_shift,
                int *toa, float *freq_error)
 {
-	struct osmo_cxvec *ref_up = NULL, *ref_down = NULL;
+	const struct gmr1_fcch_ref *ref;
+	struct osmo_cxvec *ref_up, *ref_down;
 	struct osmo_cxvec *mix_up = NULL, *mix_down = NULL;
 	struct osmo_cxvec *burst = NULL;
-	fftwf_plan fft_plan;
+	const struct gmr1_fft_plan *fft_plan;
 	float bin_hz, peak_up, peak_down;
 	float freq_err_hz, freq_err_rps;
 	float chirp_rate, toa_ms, toa_samples;
 	int len, mid, i;
 	int rv = 0;
 
-	/* Generate reference up & down chirp */
-	ref_up   = gmr1_sdr_fcch_gen_up_chirp(burst_type, 1);
-	ref_down = gmr1_sdr_fcch_gen_down_chirp(burst_type, 1);
-
-	if (!ref_up || !ref_down) {
+	/* Get reference up & down chirp */
+	ref = _gmr1_fcch_ref_get(burst_type, 1);
+	if (!ref) {
 		rv = -ENOMEM;
 		goto err;
 	}
 
+	ref_up   = ref->up;
+	ref_down = ref->down;
+
 	/* Normalize and decimate the burst to 1 sps */
 	burst = osmo_cxvec_sig_normalize(burst_in, sps, freq_shift, NULL);
 	if (!burst) {
@@ -550,6 +1031,12 @@ gmr1_fcch_fine(const struct gmr1_fcch_burst *burst_type,
 		goto err;
 	}
 
+	fft_plan = gmr1_fft_plan_get(len, FFTW_FORWARD);
+	if (!fft_plan) {
+		rv = -ENOMEM;
+		goto err;
+	}
+
 	/* Multiply burst with the ref */
 	mix_up   = osmo_cxvec_alloc(len);
 	mix_down = osmo_cxvec_alloc(len);
@@ -580,13 +1067,8 @@ gmr1_fcch_fine(const struct gmr1_fcch_burst *burst_type,
 	}
 
 		/* Do the fft */
-	fft_plan = fftwf_plan_dft_1d(len, mix_up->data, mix_up->data, FFTW_FORWARD, FFTW_ESTIMATE);
-	fftwf_execute(fft_plan);
-	fftwf_destroy_plan(fft_plan);
-
-	fft_plan = fftwf_plan_dft_1d(len, mix_down->data, mix_down->data, FFTW_FORWARD, FFTW_ESTIMATE);
-	fftwf_execute(fft_plan);
-	fftwf_destroy_plan(fft_plan);
+	gmr1_fft_execute(fft_plan, mix_up->data);
+	gmr1_fft_execute(fft_plan, mix_down->data);
 
 	/* Debug */
 	DEBUG_SIGNAL("fcch_fft_up", mix_up);
@@ -621,9 +1103,6 @@ err:
 
 	osmo_cxvec_free(burst);
 
-	osmo_cxvec_free(ref_down);
-	osmo_cxvec_free(ref_up);
-
 	return rv;
 }
 
@@ -645,14 +1124,14 @@ gmr1_fcch_snr(const struct gmr1_fcch_burst *burst_type,
               struct osmo_cxvec *burst_in, int sps, float freq_shift,
               float *snr)
 {
-	struct osmo_cxvec *ref = NULL;
+	const struct gmr1_fcch_ref *ref;
 	struct osmo_cxvec *burst = NULL;
-	fftwf_plan fft_plan;
+	const struct gmr1_fft_plan *fft_plan;
 	int peaks[6], len, i;
 	int rv = 0;
 
-	/* Generate reference dual chirp */
-	ref = gmr1_sdr_fcch_gen_dual_chirp(burst_type, 1);
+	/* Get reference dual chirp */
+	ref = _gmr1_fcch_ref_get(burst_type, 1);
 	if (!ref) {
 		rv = -ENOMEM;
 		goto err;
@@ -669,21 +1148,25 @@ gmr1_fcch_snr(const struct gmr1_fcch_burst *burst_type,
 	len = burst_type->len;
 
 	if ((len != burst->len) ||
-	    (len != ref->len)) {
+	    (len != ref->dual->len)) {
 	    	rv = -EINVAL;
 		goto err;
 	}
 
+	fft_plan = gmr1_fft_plan_get(len, FFTW_FORWARD);
+	if (!fft_plan) {
+		rv = -ENOMEM;
+		goto err;
+	}
+
 	/* Multiply burst with the ref (we know it's real only) */
 	for (i=0; i<len; i++)
-		burst->data[i] *= crealf(ref->data[i]);
+		burst->data[i] *= crealf(ref->dual->data[i]);
 
 	DEBUG_SIGNAL("fcch_snr_mix", burst);
 
 	/* Compute the FFT */
-	fft_plan = fftwf_plan_dft_1d(len, burst->data, burst->data, FFTW_FORWARD, FFTW_ESTIMATE);
-	fftwf_execute(fft_plan);
-	fftwf_destroy_plan(fft_plan);
+	gmr1_fft_execute(fft_plan, burst->data);
 
 	DEBUG_SIGNAL("fcch_snr_fft", burst);
 
@@ -702,7 +1185,6 @@ gmr1_fcch_snr(const struct gmr1_fcch_burst *burst_type,
 	/* Cleanup */
 err:
 	osmo_cxvec_free(burst);
-	osmo_cxvec_free(ref);
 
 	return rv;
 }
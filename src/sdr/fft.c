@@ -0,0 +1,262 @@
+/* GMR-1 SDR - Shared FFT plans */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \addtogroup fft
+ *  @{
+ */
+
+/*! \file sdr/fft.c
+ *  \brief Osmocom GMR-1 shared FFT plans implementation
+ *
+ * All the FFTW plans of the SDR library are created through this registry.
+ * A plan is built once per (length, direction) and kept until the process
+ * exits. Since the FFTW planner isn't thread-safe, all planning (and wisdom
+ * import / export) is serialized by a single lock, while executing plans is
+ * lock-free.
+ */
+
+#include <complex.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fftw3.h>
+
+#include <osmocom/gmr1/sdr/fft.h>
+
+
+/*! \brief Registry entry: plans for a given length and direction */
+struct gmr1_fft_plan
+{
+	struct gmr1_fft_plan *next;	/*!< \brief Next registry entry */
+
+	int len;			/*!< \brief FFT length          */
+	int dir;			/*!< \brief FFTW_FORWARD / FFTW_BACKWARD */
+
+	fftwf_plan aligned;		/*!< \brief In-place, SIMD aligned buffers */
+	fftwf_plan unaligned;		/*!< \brief In-place, any buffer  */
+};
+
+/*! \brief Lock protecting the registry and the FFTW planner */
+static pthread_mutex_t g_fft_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*! \brief Registry list. Entries are never modified once inserted */
+static struct gmr1_fft_plan *g_fft_plans = NULL;
+
+/*! \brief Planner flags used for new plans */
+static unsigned int g_fft_flags = FFTW_MEASURE;
+
+
+/*! \brief Set the FFTW planner flags used for plans created from now on
+ *  \param[in] flags FFTW planner flags (FFTW_ESTIMATE, FFTW_MEASURE, ...)
+ *
+ * The default is FFTW_MEASURE. If FFTW_WISDOM_ONLY is given and no wisdom is
+ * available for a given size, an FFTW_ESTIMATE plan is created instead.
+ */
+void
+gmr1_fft_set_planner_flags(unsigned int flags)
+{
+	pthread_mutex_lock(&g_fft_lock);
+	g_fft_flags = flags;
+	pthread_mutex_unlock(&g_fft_lock);
+}
+
+/*! \brief Resolve a wisdom filename
+ *  \param[in] filename Filename, or NULL to use \ref GMR1_FFT_WISDOM_ENV
+ *  \returns The filename to use, NULL if none
+ */
+static const char *
+_gmr1_fft_wisdom_file(const char *filename)
+{
+	if (filename)
+		return filename;
+
+	filename = getenv(GMR1_FFT_WISDOM_ENV);
+	if (filename && !filename[0])
+		return NULL;
+
+	return filename;
+}
+
+/*! \brief Load FFTW wisdom from a file
+ *  \param[in] filename Wisdom file, or NULL to use \ref GMR1_FFT_WISDOM_ENV
+ *  \returns 0 for success, 1 if no file was given. -errno for errors
+ *
+ * Plans created after loading matching wisdom don't need any measurement.
+ */
+int
+gmr1_fft_wisdom_load(const char *filename)
+{
+	FILE *fh;
+	int rv;
+
+	filename = _gmr1_fft_wisdom_file(filename);
+	if (!filename)
+		return 1;
+
+	fh = fopen(filename, "r");
+	if (!fh)
+		return -errno;
+
+	pthread_mutex_lock(&g_fft_lock);
+	rv = fftwf_import_wisdom_from_file(fh) ? 0 : -EINVAL;
+	pthread_mutex_unlock(&g_fft_lock);
+
+	fclose(fh);
+
+	return rv;
+}
+
+/*! \brief Save the accumulated FFTW wisdom to a file
+ *  \param[in] filename Wisdom file, or NULL to use \ref GMR1_FFT_WISDOM_ENV
+ *  \returns 0 for success, 1 if no file was given. -errno for errors
+ */
+int
+gmr1_fft_wisdom_save(const char *filename)
+{
+	FILE *fh;
+
+	filename = _gmr1_fft_wisdom_file(filename);
+	if (!filename)
+		return 1;
+
+	fh = fopen(filename, "w");
+	if (!fh)
+		return -errno;
+
+	pthread_mutex_lock(&g_fft_lock);
+	fftwf_export_wisdom_to_file(fh);
+	pthread_mutex_unlock(&g_fft_lock);
+
+	if (fclose(fh))
+		return -errno;
+
+	return 0;
+}
+
+/*! \brief Create a single FFTW plan (planner lock must be held)
+ *  \param[in] len FFT length
+ *  \param[in] dir FFTW_FORWARD or FFTW_BACKWARD
+ *  \param[in] buf Scratch buffer of at least len + 1 elements
+ *  \param[in] unaligned Plan for buffers without SIMD alignment
+ *  \returns The new plan, NULL for errors
+ */
+static fftwf_plan
+_gmr1_fft_plan_create(int len, int dir, float complex *buf, int unaligned)
+{
+	unsigned int flags = g_fft_flags;
+	fftwf_plan plan;
+
+	/* Misaligned scratch buffer for the unaligned variant */
+	if (unaligned) {
+		flags |= FFTW_UNALIGNED;
+		buf++;
+	}
+
+	plan = fftwf_plan_dft_1d(len, buf, buf, dir, flags);
+	if (!plan && (flags & FFTW_WISDOM_ONLY))
+		plan = fftwf_plan_dft_1d(len, buf, buf, dir,
+			(flags & ~(FFTW_WISDOM_ONLY | FFTW_PATIENT | FFTW_EXHAUSTIVE)) |
+			FFTW_ESTIMATE);
+
+	return plan;
+}
+
+/*! \brief Get the shared in-place plans for a given FFT length and direction
+ *  \param[in] len FFT length
+ *  \param[in] dir FFTW_FORWARD or FFTW_BACKWARD
+ *  \returns The registry entry (not to be freed), NULL for errors
+ *
+ * The plans are created on first use with the current planner flags.
+ */
+const struct gmr1_fft_plan *
+gmr1_fft_plan_get(int len, int dir)
+{
+	struct gmr1_fft_plan *plan;
+	float complex *buf = NULL;
+
+	if (len <= 0)
+		return NULL;
+
+	pthread_mutex_lock(&g_fft_lock);
+
+	for (plan=g_fft_plans; plan; plan=plan->next)
+		if ((plan->len == len) && (plan->dir == dir))
+			goto done;
+
+	/* Create a new entry */
+	plan = calloc(1, sizeof(struct gmr1_fft_plan));
+	buf = fftwf_malloc(sizeof(float complex) * (len + 1));
+
+	if (!plan || !buf)
+		goto err;
+
+	plan->len = len;
+	plan->dir = dir;
+
+	plan->aligned   = _gmr1_fft_plan_create(len, dir, buf, 0);
+	plan->unaligned = _gmr1_fft_plan_create(len, dir, buf, 1);
+
+	if (!plan->aligned || !plan->unaligned)
+		goto err;
+
+	fftwf_free(buf);
+
+	plan->next = g_fft_plans;
+	g_fft_plans = plan;
+
+done:
+	pthread_mutex_unlock(&g_fft_lock);
+
+	return plan;
+
+err:
+	if (plan) {
+		if (plan->unaligned)
+			fftwf_destroy_plan(plan->unaligned);
+		if (plan->aligned)
+			fftwf_destroy_plan(plan->aligned);
+		free(plan);
+	}
+
+	fftwf_free(buf);
+
+	pthread_mutex_unlock(&g_fft_lock);
+
+	return NULL;
+}
+
+/*! \brief Execute a shared plan in-place on a given buffer
+ *  \param[in] plan Plan from \ref gmr1_fft_plan_get
+ *  \param[in,out] buf Buffer of plan length (any alignment)
+ *
+ * Buffers obtained from fftwf_malloc() use the fastest (aligned) variant.
+ * This can be called concurrently from any number of threads.
+ */
+void
+gmr1_fft_execute(const struct gmr1_fft_plan *plan, float complex *buf)
+{
+	if (fftwf_alignment_of((float *)buf) == 0)
+		fftwf_execute_dft(plan->aligned, buf, buf);
+	else
+		fftwf_execute_dft(plan->unaligned, buf, buf);
+}
+
+/*! @} */
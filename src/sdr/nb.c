@@ -33,14 +33,14 @@
 
 /* BCCH ------------------------------------------------------------------- */
 
-static struct gmr1_pi4cxpsk_sync _bcch_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _bcch_sync[] = {
 	{  28, 11, { 0, 2, 2, 0, 0, 0, 2, 0, 2, 2, 2 } },
 	{ 119,  3, { 2, 2, 0 } },
 	{ 197,  3, { 2, 2, 0 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _bcch_data[] = {
+static const struct gmr1_pi4cxpsk_data _bcch_data[] = {
 	{   2, 26 },	/* e0   ... e51  */
 	{  39, 80 },	/* e52  ... e211 */
 	{ 122, 75 },	/* e212 ... e361 */
@@ -51,7 +51,7 @@ static struct gmr1_pi4cxpsk_data _bcch_data[] = {
 /*! \brief BCCH bursts
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.2
  */
-struct gmr1_pi4cxpsk_burst gmr1_bcch_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_bcch_burst = {
 	.mod = &gmr1_pi4cqpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -64,12 +64,12 @@ struct gmr1_pi4cxpsk_burst gmr1_bcch_burst = {
 
 /* DC2 -------------------------------------------------------------------- */
 
-static struct gmr1_pi4cxpsk_sync _dc2_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _dc2_sync[] = {
 	{ 28, 7, { 0, 1, 2, 3, 0, 3, 0 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _dc2_data[] = {
+static const struct gmr1_pi4cxpsk_data _dc2_data[] = {
 	{  2, 26 },	/* e0  ... e51  */
 	{ 35, 40 },	/* e52 ... e131 */
 	{ -1 },
@@ -78,7 +78,7 @@ static struct gmr1_pi4cxpsk_data _dc2_data[] = {
 /*! \brief DC2 bursts
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.4
  */
-struct gmr1_pi4cxpsk_burst gmr1_dc2_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_dc2_burst = {
 	.mod = &gmr1_pi4cqpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -91,14 +91,14 @@ struct gmr1_pi4cxpsk_burst gmr1_dc2_burst = {
 
 /* DC6 -------------------------------------------------------------------- */
 
-static struct gmr1_pi4cxpsk_sync _dc6_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _dc6_sync[] = {
 	{  28, 7, { 0, 0, 0, 2, 2, 0, 2 } },
 	{ 119, 3, { 0, 3, 0 } },
 	{ 197, 3, { 3, 1, 1 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _dc6_data[] = {
+static const struct gmr1_pi4cxpsk_data _dc6_data[] = {
 	{   2, 26 },	/* e0   ... e51  */
 	{  35, 84 },	/* e52  ... e219 */
 	{ 122, 75 },	/* e220 ... e369 */
@@ -109,7 +109,7 @@ static struct gmr1_pi4cxpsk_data _dc6_data[] = {
 /*! \brief DC6 bursts
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.5
  */
-struct gmr1_pi4cxpsk_burst gmr1_dc6_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_dc6_burst = {
 	.mod = &gmr1_pi4cqpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -122,14 +122,14 @@ struct gmr1_pi4cxpsk_burst gmr1_dc6_burst = {
 
 /* DC12 ------------------------------------------------------------------- */
 
-static struct gmr1_pi4cxpsk_sync _dc12_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _dc12_sync[] = {
 	{  10, 10, { 0, 0, 1, 0, 0, 0, 1, 1, 1, 1 } },
 	{ 228, 11, { 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 1 } },
 	{ 447, 10, { 0, 0, 1, 0, 0, 0, 1, 1, 1, 1 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _dc12_data[] = {
+static const struct gmr1_pi4cxpsk_data _dc12_data[] = {
 	{   2,   8 },	/* e0   ... e7   */
 	{  20, 208 },	/* e8   ... e215 */
 	{ 239, 208 },	/* e216 ... e423 */
@@ -140,7 +140,7 @@ static struct gmr1_pi4cxpsk_data _dc12_data[] = {
 /*! \brief DC12 bursts
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V3.1.1) - Section 7.4.16
  */
-struct gmr1_pi4cxpsk_burst gmr1_dc12_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_dc12_burst = {
 	.mod = &gmr1_pi2cbpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -153,12 +153,12 @@ struct gmr1_pi4cxpsk_burst gmr1_dc12_burst = {
 
 /* NT3 Speech ------------------------------------------------------------- */
 
-static struct gmr1_pi4cxpsk_sync _nt3_speech_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _nt3_speech_sync[] = {
 	{ 28, 6, { 0, 3, 3, 1, 2, 3 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _nt3_speech_data[] = {
+static const struct gmr1_pi4cxpsk_data _nt3_speech_data[] = {
 	{  2, 26 },	/* e0  ... e51  */
 	{ 34, 80 },	/* e52 ... e211 */
 	{ -1 },
@@ -167,7 +167,7 @@ static struct gmr1_pi4cxpsk_data _nt3_speech_data[] = {
 /*! \brief NT3 bursts for encoded speech
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.8.1
  */
-struct gmr1_pi4cxpsk_burst gmr1_nt3_speech_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_nt3_speech_burst = {
 	.mod = &gmr1_pi4cqpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -180,17 +180,17 @@ struct gmr1_pi4cxpsk_burst gmr1_nt3_speech_burst = {
 
 /* NT3 FACCH -------------------------------------------------------------- */
 
-static struct gmr1_pi4cxpsk_sync _nt3_facch_sync0[] = {
+static const struct gmr1_pi4cxpsk_sync _nt3_facch_sync0[] = {
 	{ 28, 8, { 1, 0, 1, 0, 1, 0, 1, 0 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_sync _nt3_facch_sync1[] = {
+static const struct gmr1_pi4cxpsk_sync _nt3_facch_sync1[] = {
 	{ 28, 8, { 1, 1, 0, 0, 1, 0, 0, 1 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _nt3_facch_data[] = {
+static const struct gmr1_pi4cxpsk_data _nt3_facch_data[] = {
 	{  2, 26 },	/* e0  ... e25  */
 	{ 36, 78 },	/* e26 ... e103 */
 	{ -1 },
@@ -199,7 +199,7 @@ static struct gmr1_pi4cxpsk_data _nt3_facch_data[] = {
 /*! \brief NT3 bursts for FACCH
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.8.2
  */
-struct gmr1_pi4cxpsk_burst gmr1_nt3_facch_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_nt3_facch_burst = {
 	.mod = &gmr1_pi4cbpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -212,21 +212,21 @@ struct gmr1_pi4cxpsk_burst gmr1_nt3_facch_burst = {
 
 /* NT6 -------------------------------------------------------------------- */
 
-static struct gmr1_pi4cxpsk_sync _nt6_facch_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _nt6_facch_sync[] = {
 	{  28, 6, { 0, 2, 2, 3, 2, 3 } },
 	{ 119, 3, { 0, 1, 0 } },
 	{ 197, 3, { 2, 3, 0 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_sync _nt6_data_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _nt6_data_sync[] = {
 	{  28, 6, { 0, 0, 0, 2, 2, 0 } },
 	{ 119, 3, { 1, 3, 0 } },
 	{ 197, 3, { 2, 1, 3 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _nt6_data[] = {
+static const struct gmr1_pi4cxpsk_data _nt6_data[] = {
 	{   2, 26 },	/* e0   ... e51  */
 	{  34, 85 },	/* e52  ... e221 */
 	{ 122, 75 },	/* e222 ... e371 */
@@ -237,7 +237,7 @@ static struct gmr1_pi4cxpsk_data _nt6_data[] = {
 /*! \brief NT6 bursts
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.9
  */
-struct gmr1_pi4cxpsk_burst gmr1_nt6_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_nt6_burst = {
 	.mod = &gmr1_pi4cqpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -250,7 +250,7 @@ struct gmr1_pi4cxpsk_burst gmr1_nt6_burst = {
 
 /* NT9 -------------------------------------------------------------------- */
 
-static struct gmr1_pi4cxpsk_sync _nt9_facch_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _nt9_facch_sync[] = {
 	{  28, 6, { 0, 2, 2, 3, 2, 3 } },
 	{ 119, 3, { 1, 2, 2 } },
 	{ 197, 3, { 0, 1, 0 } },
@@ -258,7 +258,7 @@ static struct gmr1_pi4cxpsk_sync _nt9_facch_sync[] = {
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_sync _nt9_data_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _nt9_data_sync[] = {
 	{  28, 6, { 0, 0, 0, 2, 2, 0 } },
 	{ 119, 3, { 0, 2, 0 } },
 	{ 197, 3, { 1, 3, 0 } },
@@ -266,7 +266,7 @@ static struct gmr1_pi4cxpsk_sync _nt9_data_sync[] = {
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _nt9_data[] = {
+static const struct gmr1_pi4cxpsk_data _nt9_data[] = {
 	{   2, 26 },	/* e0   ... e51  */
 	{  34, 85 },	/* e52  ... e221 */
 	{ 122, 75 },	/* e222 ... e371 */
@@ -278,7 +278,7 @@ static struct gmr1_pi4cxpsk_data _nt9_data[] = {
 /*! \brief NT9 bursts
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.10
  */
-struct gmr1_pi4cxpsk_burst gmr1_nt9_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_nt9_burst = {
 	.mod = &gmr1_pi4cqpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -291,7 +291,7 @@ struct gmr1_pi4cxpsk_burst gmr1_nt9_burst = {
 
 /* RACH =------------------------------------------------------------------ */
 
-static struct gmr1_pi4cxpsk_sync _rach_sync[] = {
+static const struct gmr1_pi4cxpsk_sync _rach_sync[] = {
 	{  78, 17, { 0, 2, 2, 0, 0, 0, 2, 0, 2, 2, 2, 2, 2, 0, 2, 2, 0 } },
 	{ 127, 32, { 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
 	             2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 } },
@@ -302,7 +302,7 @@ static struct gmr1_pi4cxpsk_sync _rach_sync[] = {
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _rach_data[] = {
+static const struct gmr1_pi4cxpsk_data _rach_data[] = {
 	{   2, 76 },	/* e0   ... e151 */
 	{  95, 32 },	/* e152 ... e215 */
 	{ 159, 32 },	/* e216 ... e279 */
@@ -314,7 +314,7 @@ static struct gmr1_pi4cxpsk_data _rach_data[] = {
 /*! \brief RACH bursts
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.11
  */
-struct gmr1_pi4cxpsk_burst gmr1_rach_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_rach_burst = {
 	.mod = &gmr1_pi4cqpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -327,35 +327,35 @@ struct gmr1_pi4cxpsk_burst gmr1_rach_burst = {
 
 /* SDCCH ------------------------------------------------------------------ */
 
-static struct gmr1_pi4cxpsk_sync _sdcch_sync0[] = {
+static const struct gmr1_pi4cxpsk_sync _sdcch_sync0[] = {
 	{  28, 7, { 0, 1, 0, 1, 0, 1, 0 } },
 	{ 115, 7, { 1, 0, 1, 0, 1, 0, 1 } },
 	{ 197, 7, { 0, 1, 0, 1, 0, 1, 1 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_sync _sdcch_sync1[] = {
+static const struct gmr1_pi4cxpsk_sync _sdcch_sync1[] = {
 	{  28, 7, { 0, 0, 1, 1, 0, 0, 1 } },
 	{ 115, 7, { 1, 0, 0, 1, 1, 0, 0 } },
 	{ 197, 7, { 1, 1, 0, 0, 1, 1, 1 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_sync _sdcch_sync2[] = {
+static const struct gmr1_pi4cxpsk_sync _sdcch_sync2[] = {
 	{  28, 7, { 0, 0, 0, 0, 1, 1, 1 } },
 	{ 115, 7, { 1, 0, 0, 0, 0, 1, 1 } },
 	{ 197, 7, { 1, 1, 0, 0, 0, 0, 1 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_sync _sdcch_sync3[] = {
+static const struct gmr1_pi4cxpsk_sync _sdcch_sync3[] = {
 	{  28, 7, { 0, 1, 1, 0, 1, 0, 0 } },
 	{ 115, 7, { 1, 0, 1, 1, 0, 1, 0 } },
 	{ 197, 7, { 0, 1, 0, 1, 1, 0, 1 } },
 	{ -1 },
 };
 
-static struct gmr1_pi4cxpsk_data _sdcch_data[] = {
+static const struct gmr1_pi4cxpsk_data _sdcch_data[] = {
 	{   2, 26 },	/* e0   ... e25  */
 	{  35, 80 },	/* e26  ... e105 */
 	{ 122, 75 },	/* e106 ... e180 */
@@ -366,7 +366,7 @@ static struct gmr1_pi4cxpsk_data _sdcch_data[] = {
 /*! \brief SDCCH bursts
  *  See GMR-1 05.002 (ETSI TS 101 376-5-2 V1.1.1) - Section 7.4.12
  */
-struct gmr1_pi4cxpsk_burst gmr1_sdcch_burst = {
+const struct gmr1_pi4cxpsk_burst gmr1_sdcch_burst = {
 	.mod = &gmr1_pi4cbpsk,
 	.guard_pre = 2,
 	.guard_post = 3,
@@ -29,17 +29,21 @@
 #include <complex.h>
 #include <math.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <fftw3.h>
+
 #include <osmocom/core/bits.h>
 
 #include <osmocom/dsp/cxvec.h>
 #include <osmocom/dsp/cxvec_math.h>
 
 #include <osmocom/gmr1/sdr/defs.h>
+#include <osmocom/gmr1/sdr/fft.h>
 #include <osmocom/gmr1/sdr/pi4cxpsk.h>
 
 
@@ -68,13 +72,13 @@
  */
 
 /*! \brief pi{2,4}-CBPSK symbols descriptions */
-static struct gmr1_pi4cxpsk_symbol gmr1_piNcbpsk_syms_bits[] = {
+static const struct gmr1_pi4cxpsk_symbol gmr1_piNcbpsk_syms_bits[] = {
 	{ 0, {0}, 0*M_PIf/2,  1+0*I },
 	{ 1, {1}, 2*M_PIf/2, -1+0*I },
 };
 
 /*! \brief pi2-CBPSK modulation description */
-struct gmr1_pi4cxpsk_modulation gmr1_pi2cbpsk = {
+const struct gmr1_pi4cxpsk_modulation gmr1_pi2cbpsk = {
 	.rotation = M_PIf/2,
 	.nbits = 1,
 	.syms = gmr1_piNcbpsk_syms_bits,
@@ -82,7 +86,7 @@ struct gmr1_pi4cxpsk_modulation gmr1_pi2cbpsk = {
 };
 
 /*! \brief pi4-CBPSK modulation description */
-struct gmr1_pi4cxpsk_modulation gmr1_pi4cbpsk = {
+const struct gmr1_pi4cxpsk_modulation gmr1_pi4cbpsk = {
 	.rotation = M_PIf/4,
 	.nbits = 1,
 	.syms = gmr1_piNcbpsk_syms_bits,
@@ -91,7 +95,7 @@ struct gmr1_pi4cxpsk_modulation gmr1_pi4cbpsk = {
 
 
 /*! \brief pi4-CQPSK symbols descriptions in symbol order */
-static struct gmr1_pi4cxpsk_symbol gmr1_pi4cqpsk_syms[] = {
+static const struct gmr1_pi4cxpsk_symbol gmr1_pi4cqpsk_syms[] = {
 	{ 0, {0,0}, 0*M_PIf/2,  1+0*I },
 	{ 1, {0,1}, 1*M_PIf/2,  0+1*I },
 	{ 2, {1,1}, 2*M_PIf/2, -1+0*I },
@@ -99,7 +103,7 @@ static struct gmr1_pi4cxpsk_symbol gmr1_pi4cqpsk_syms[] = {
 };
 
 /*! \brief pi4-CQPSK symbols descriptions in bits order */
-static struct gmr1_pi4cxpsk_symbol gmr1_pi4cqpsk_bits[] = {
+static const struct gmr1_pi4cxpsk_symbol gmr1_pi4cqpsk_bits[] = {
 	{ 0, {0,0}, 0*M_PIf/2,  1+0*I },
 	{ 1, {0,1}, 1*M_PIf/2,  0+1*I },
 	{ 3, {1,0}, 3*M_PIf/2,  0-1*I },
@@ -107,7 +111,7 @@ static struct gmr1_pi4cxpsk_symbol gmr1_pi4cqpsk_bits[] = {
 };
 
 /*! \brief pi4-CQPSK modulation description */
-struct gmr1_pi4cxpsk_modulation gmr1_pi4cqpsk = {
+const struct gmr1_pi4cxpsk_modulation gmr1_pi4cqpsk = {
 	.rotation = M_PIf/4,
 	.nbits = 2,
 	.syms = gmr1_pi4cqpsk_syms,
@@ -116,109 +120,325 @@ struct gmr1_pi4cxpsk_modulation gmr1_pi4cqpsk = {
 
 
 
-/*! \brief Generate a reference signal for all sync sequences of a burst type
- *  \param[in] burst_type Burst format description
+#define INTERP_PHASES	32	/*!< \brief Fractional delays per sample (even) */
+#define INTERP_TAPS	21	/*!< \brief Taps of each interpolator phase       */
+
+/*! \brief Polyphase fractional delay filter bank (shared by all contexts) */
+static float g_interp[(INTERP_PHASES + 1) * INTERP_TAPS];
+
+/*! \brief Makes sure \ref g_interp is only generated once */
+static pthread_once_t g_interp_once = PTHREAD_ONCE_INIT;
+
+/*! \brief Context allocation flags */
+#define CTX_NO_FFT	(1 << 0)	/*!< \brief Direct correlation only   */
+#define CTX_SYNC_ONLY	(1 << 1)	/*!< \brief Sync search buffers only  */
+
+/*! \brief Structure for pi4-CxPSK demodulator work state */
+struct gmr1_pi4cxpsk_demod_ctx
+{
+	const struct gmr1_pi4cxpsk_burst *burst_type;	/*!< \brief Burst format   */
+	int sps;				/*!< \brief Oversampling   */
+	int max_win;				/*!< \brief Max search win */
+
+	struct osmo_cxvec *refs;	/*!< \brief Refs of all sync chunks */
+	float complex *refs_data;	/*!< \brief Storage for refs        */
+
+	struct osmo_cxvec *burst;	/*!< \brief Normalized burst        */
+	struct osmo_cxvec *conv;	/*!< \brief Interpolated burst      */
+	struct osmo_cxvec *corr;	/*!< \brief Combined correlation    */
+	struct osmo_cxvec *corr_tmp;	/*!< \brief Per-chunk correlation   */
+
+	/* Overlap-save FFT correlation (only if fft_len != 0) */
+	int fft_len;			/*!< \brief FFT size                */
+	float complex *fft_buf;		/*!< \brief FFT work buffer         */
+	float complex *fft_spec;	/*!< \brief Conj. spectra of all sync chunks */
+	const struct gmr1_fft_plan *fft_fwd;	/*!< \brief Forward FFT plan */
+	const struct gmr1_fft_plan *fft_inv;	/*!< \brief Inverse FFT plan */
+};
+
+
+/*! \brief Generate the reference signals of all sync chunks of a burst type
+ *  \param[in] ctx Demodulator context (defines the burst type)
  *  \returns 0 for success. -ernno for errors
  *
- * The reference waveforms are stored inside the burst_type itself.
+ * The reference waveforms are private to the context, in the same order as
+ * the chunks of all the sync sequences. The burst description itself is
+ * never modified so it can be shared between threads.
  */
 static int
-_gmr1_pi4cxpsk_sync_gen_ref(struct gmr1_pi4cxpsk_burst *burst_type)
+_gmr1_pi4cxpsk_sync_gen_ref(struct gmr1_pi4cxpsk_demod_ctx *ctx)
 {
-	int i, j;
+	const struct gmr1_pi4cxpsk_burst *burst_type = ctx->burst_type;
+	const struct gmr1_pi4cxpsk_sync *csync;
+	int i, j, k, n_chunks, n_syms;
+
+	/* Count chunks and symbols */
+	n_chunks = n_syms = 0;
 
-	/* Scan all possible training sequences */
 	for (i=0; (i < GMR1_MAX_SYNC) && (burst_type->sync[i] != NULL); i++)
-	{
-		struct gmr1_pi4cxpsk_sync *csync;
+		for (csync=burst_type->sync[i]; csync->pos>=0; csync++) {
+			n_syms += csync->len;
+			n_chunks++;
+		}
+
+	/* Allocate */
+	ctx->refs = calloc(n_chunks, sizeof(struct osmo_cxvec));
+	ctx->refs_data = malloc(sizeof(float complex) * n_syms);
+
+	if (!ctx->refs || !ctx->refs_data)
+		return -ENOMEM;
 
+	/* Fill them */
+	k = n_syms = 0;
+
+	for (i=0; (i < GMR1_MAX_SYNC) && (burst_type->sync[i] != NULL); i++)
+	{
 		/* Scan all 'chunks' */
-		for (csync=burst_type->sync[i]; csync->pos>=0; csync++)
+		for (csync=burst_type->sync[i]; csync->pos>=0; csync++, k++)
 		{
+			struct osmo_cxvec *ref = &ctx->refs[k];
 			int is_real = 1;
 
-			/* Already done ? */
-			if (csync->_ref)
-				continue;
-
-			/* Allocate it */
-			csync->_ref = osmo_cxvec_alloc(csync->len);
-			if (!csync->_ref)
-				return -ENOMEM;
+			osmo_cxvec_init_from_data(ref, &ctx->refs_data[n_syms], csync->len);
+			n_syms += csync->len;
 
-			/* Fill it */
 			for (j=0; j<csync->len; j++) {
-				int s;
 				float complex mv;
 
-				s = csync->syms[j];
-				mv = burst_type->mod->syms[s].mod_val;
+				mv = burst_type->mod->syms[csync->syms[j]].mod_val;
 
 				if (cimagf(mv) != 0.0f)
 					is_real = 0;
 
-				csync->_ref->data[j] = mv;
+				ref->data[j] = mv;
 			}
 
-			csync->_ref->len = csync->len;
-
 			if (is_real)
-				csync->_ref->flags |= CXVEC_FLG_REAL_ONLY;
+				ref->flags |= CXVEC_FLG_REAL_ONLY;
 		}
 	}
 
 	return 0;
 }
 
+/*! \brief Span (in samples) of the reference of a sync chunk at given sps */
+#define SYNC_SPAN(csync, sps) ((((csync)->len - 1) * (sps)) + 1)
+
+/*! \brief Estimates if FFT correlation of a sync chunk beats the direct one
+ *  \param[in] w Number of correlation points to compute (search window)
+ *  \param[in] len Sync chunk length (in symbols)
+ *  \param[in] span Sync chunk reference span (in samples)
+ *  \param[in] fft_len FFT size of the overlap-save blocks
+ *  \returns 1 if the FFT path is expected to be cheaper, 0 otherwise
+ *
+ * The direct correlation costs w * len complex MACs. Each overlap-save
+ * block costs two FFTs (~ N.log2(N)) and N complex MACs and yields
+ * (N - span + 1) correlation points. FFTW operations are weighted 2.5x
+ * cheaper than the direct path ones (measured on x86_64).
+ */
+static int
+_gmr1_pi4cxpsk_fft_worth(int w, int len, int span, int fft_len)
+{
+	int v, n_blk, lg;
+
+	v = fft_len - span + 1;
+	if (v <= 0)
+		return 0;
+
+	n_blk = (w + v - 1) / v;
+
+	for (lg=0; (1<<lg)<fft_len; lg++);
+
+	return (2 * n_blk * fft_len * (lg + 1)) < (5 * w * len);
+}
+
+/*! \brief Sets up the FFT correlation state of a demodulator context
+ *  \param[in] ctx Demodulator context (with refs already generated)
+ *  \returns 0 for success. -errno for errors
+ *
+ * The conjugated spectrum of every sync chunk of every sync sequence is
+ * precomputed here. If the FFT path can't beat the direct correlation even
+ * for the largest search window, nothing is done and fft_len stays 0.
+ */
+static int
+_gmr1_pi4cxpsk_fft_init(struct gmr1_pi4cxpsk_demod_ctx *ctx)
+{
+	const struct gmr1_pi4cxpsk_burst *burst_type = ctx->burst_type;
+	const struct gmr1_pi4cxpsk_sync *csync;
+	int sps = ctx->sps;
+	int w = ctx->max_win + 1;
+	int i, j, k, n_chunks, max_span, n, m;
+	int use_fft;
+
+	/* Scan all chunks */
+	n_chunks = max_span = 0;
+
+	for (i=0; (i < GMR1_MAX_SYNC) && (burst_type->sync[i] != NULL); i++)
+		for (csync=burst_type->sync[i]; csync->pos>=0; csync++) {
+			if (SYNC_SPAN(csync, sps) > max_span)
+				max_span = SYNC_SPAN(csync, sps);
+			n_chunks++;
+		}
+
+	/* FFT size: big enough for the whole window in one block if possible,
+	 * but no need to go beyond 4x the reference span */
+	for (n=1; n<(max_span + w - 1); n<<=1);
+	for (m=1; m<(4 * max_span); m<<=1);
+	n = n < m ? n : m;
+
+	/* Is it worth it for any chunk at all ? */
+	use_fft = 0;
+
+	for (i=0; (i < GMR1_MAX_SYNC) && (burst_type->sync[i] != NULL); i++)
+		for (csync=burst_type->sync[i]; csync->pos>=0; csync++)
+			use_fft |= _gmr1_pi4cxpsk_fft_worth(w, csync->len, SYNC_SPAN(csync, sps), n);
+
+	if (!use_fft)
+		return 0;
+
+	/* Allocate */
+	ctx->fft_buf  = fftwf_malloc(sizeof(float complex) * n);
+	ctx->fft_spec = fftwf_malloc(sizeof(float complex) * n * n_chunks);
+
+	if (!ctx->fft_buf || !ctx->fft_spec)
+		return -ENOMEM;
+
+	ctx->fft_fwd = gmr1_fft_plan_get(n, FFTW_FORWARD);
+	ctx->fft_inv = gmr1_fft_plan_get(n, FFTW_BACKWARD);
+
+	if (!ctx->fft_fwd || !ctx->fft_inv)
+		return -ENOMEM;
+
+	ctx->fft_len = n;
+
+	/* Compute conjugated spectra of the zero-stuffed references,
+	 * including the 1/N scaling of the inverse transform */
+	k = 0;
+
+	for (i=0; (i < GMR1_MAX_SYNC) && (burst_type->sync[i] != NULL); i++)
+		for (csync=burst_type->sync[i]; csync->pos>=0; csync++, k++) {
+			float complex *spec = &ctx->fft_spec[k * n];
+
+			memset(ctx->fft_buf, 0x00, sizeof(float complex) * n);
+			for (j=0; j<csync->len; j++)
+				ctx->fft_buf[j * sps] = ctx->refs[k].data[j];
+
+			gmr1_fft_execute(ctx->fft_fwd, ctx->fft_buf);
+
+			for (j=0; j<n; j++)
+				spec[j] = conjf(ctx->fft_buf[j]) / (float)n;
+		}
+
+	return 0;
+}
+
+/*! \brief Releases the FFT correlation state of a demodulator context
+ *  \param[in] ctx Demodulator context
+ */
+static void
+_gmr1_pi4cxpsk_fft_fini(struct gmr1_pi4cxpsk_demod_ctx *ctx)
+{
+	fftwf_free(ctx->fft_spec);
+	fftwf_free(ctx->fft_buf);
+}
+
+/*! \brief Correlates a sync chunk with a window using overlap-save FFTs
+ *  \param[in] ctx Demodulator context
+ *  \param[in] spec Conjugated spectrum of the chunk reference
+ *  \param[in] span Span of the chunk reference (in samples)
+ *  \param[in] win The window of data to correlate with
+ *  \param[in] w Number of correlation points to compute
+ *  \param[out] out Correlation output vector
+ *
+ * Computes the same thing as osmo_cxvec_correlate() with a step of sps.
+ */
+static void
+_gmr1_pi4cxpsk_fft_correlate(struct gmr1_pi4cxpsk_demod_ctx *ctx,
+                             const float complex *spec, int span,
+                             struct osmo_cxvec *win, int w,
+                             struct osmo_cxvec *out)
+{
+	float complex *buf = ctx->fft_buf;
+	int n = ctx->fft_len;
+	int v = n - span + 1;
+	int b, i, l;
+
+	for (b=0; b<w; b+=v)
+	{
+		/* Load block (zero padded at the end of the window) */
+		l = win->len - b;
+		if (l > n)
+			l = n;
+
+		memcpy(buf, &win->data[b], sizeof(float complex) * l);
+		memset(&buf[l], 0x00, sizeof(float complex) * (n - l));
+
+		/* Circular correlation */
+		gmr1_fft_execute(ctx->fft_fwd, buf);
+
+		for (i=0; i<n; i++)
+			buf[i] *= spec[i];
+
+		gmr1_fft_execute(ctx->fft_inv, buf);
+
+		/* Only the first v points are valid */
+		l = w - b;
+		if (l > v)
+			l = v;
+
+		memcpy(&out->data[b], buf, sizeof(float complex) * l);
+	}
+
+	out->len = w;
+}
+
 /*! \brief Find the sync sequence inside a burst
- *  \param[in] burst_type Burst format description
+ *  \param[in] ctx Demodulator context (defines burst type and sps)
  *  \param[in] burst The input complex vector
- *  \param[in] sps Input sample per symbol (how much to decimate)
  *  \param[out] toa Pointer to estimated fractional TOA return variable
  *  \param[out] pwr Pointer to power return variable
  *  \returns >=0 index of found sync sequence. -errno for errors
  *
  * The burst input is expected to be longer than the burst. The extra amount
- * of samples will be the search window.
+ * of samples will be the search window. Each chunk is correlated either
+ * directly or with overlap-save FFTs, whichever is cheaper for the actual
+ * window size.
  */
 static int
-_gmr1_pi4cxpsk_sync_find(struct gmr1_pi4cxpsk_burst *burst_type,
-                         struct osmo_cxvec *burst, int sps,
+_gmr1_pi4cxpsk_sync_find(struct gmr1_pi4cxpsk_demod_ctx *ctx,
+                         struct osmo_cxvec *burst,
                          float *toa, float *pwr)
 {
+	const struct gmr1_pi4cxpsk_burst *burst_type = ctx->burst_type;
 	struct osmo_cxvec _win, *win = &_win;
-	struct osmo_cxvec *corr, *corr_tmp;
-	int i, j, w;
+	struct osmo_cxvec *corr = ctx->corr, *corr_tmp = ctx->corr_tmp;
+	int sps = ctx->sps;
+	int i, j, k, w;
 	float p_toa = 0.0f, p_pwr = 0.0f, p_idx = -1;
-	int rv;
 
 	/* Window size */
 	w = burst->len - (burst_type->len * sps) + 1;
 
-	/* Corr vectors */
-	corr = osmo_cxvec_alloc(w);
-	corr_tmp = osmo_cxvec_alloc(w);
-
-	if (!corr || !corr_tmp) {
-		rv = -ENOMEM;
-		goto err;
-	}
+	if ((w <= 0) || (w > ctx->max_win + 1))
+		return -EINVAL;
 
-	memset(corr->data, 0x00, sizeof(float complex) * corr->max_len);
+	memset(corr->data, 0x00, sizeof(float complex) * w);
 	corr->len = w;
 
 	/* Scan all possible training sequences */
+	k = 0;
+
 	for (i=0; (i < GMR1_MAX_SYNC) && (burst_type->sync[i] != NULL); i++)
 	{
-		struct gmr1_pi4cxpsk_sync *csync;
+		const struct gmr1_pi4cxpsk_sync *csync;
 		float s_toa, s_pwr;
 		float complex s_peak;
 		int tl = 0;
 
 		/* Correlate all 'chunks' */
-		for (csync=burst_type->sync[i]; csync->pos>=0; csync++)
+		for (csync=burst_type->sync[i]; csync->pos>=0; csync++, k++)
 		{
-			int b, l;
+			int b, l, span;
 
 			/* Extract the window of data to correlate with */
 			b =  csync->pos * sps;
@@ -226,14 +446,22 @@ _gmr1_pi4cxpsk_sync_find(struct gmr1_pi4cxpsk_burst *burst_type,
 			osmo_cxvec_init_from_data(win, &burst->data[b], l);
 
 			/* Correlate */
-			osmo_cxvec_correlate(csync->_ref, win, sps, corr_tmp);
+			span = SYNC_SPAN(csync, sps);
+
+			if (ctx->fft_len &&
+			    _gmr1_pi4cxpsk_fft_worth(w, csync->len, span, ctx->fft_len))
+				_gmr1_pi4cxpsk_fft_correlate(ctx,
+					&ctx->fft_spec[k * ctx->fft_len], span,
+					win, w, corr_tmp);
+			else
+				osmo_cxvec_correlate(&ctx->refs[k], win, sps, corr_tmp);
 
 			/* If not the first, then combine results */
 			for (j=0; j<w; j++)
 				corr->data[j] += cabsf(corr_tmp->data[j]);
 
 			/* Add length of this 'chunk' */
-			tl += csync->_ref->len;
+			tl += csync->len;
 		}
 
 		/* Find peak */
@@ -257,31 +485,82 @@ _gmr1_pi4cxpsk_sync_find(struct gmr1_pi4cxpsk_burst *burst_type,
 		*toa = p_toa;
 	if (pwr)
 		*pwr = p_pwr;
-	rv = p_idx;
 
-	/* Clean up */
-err:
-	osmo_cxvec_free(corr_tmp);
-	osmo_cxvec_free(corr);
+	return p_idx;
+}
 
-	return rv;
+/*! \brief Generate the polyphase fractional delay filter bank \ref g_interp
+ *
+ * Row r interpolates the signal at a fractional offset of
+ * (r - INTERP_PHASES/2) / INTERP_PHASES sample, i.e. in [-0.5, 0.5].
+ * It only depends on constants so it's done once for all the contexts.
+ */
+static void
+_gmr1_pi4cxpsk_interp_gen(void)
+{
+	int r, i;
+
+	for (r=0; r<=INTERP_PHASES; r++) {
+		float frac = (float)(r - (INTERP_PHASES>>1)) / INTERP_PHASES;
+
+		for (i=0; i<INTERP_TAPS; i++)
+			g_interp[r * INTERP_TAPS + i] = osmo_sinc(
+				M_PIf * ((float)(i - (INTERP_TAPS>>1)) + frac)
+			);
+	}
+}
+
+/*! \brief Interpolate a single point using one polyphase filter
+ *  \param[in] src Input complex vector
+ *  \param[in] h Taps of the fractional phase to use
+ *  \param[in] c Integer position of the point
+ *  \returns Interpolated value (zero if c is outside src)
+ */
+static inline float complex
+_gmr1_pi4cxpsk_interp_point(const struct osmo_cxvec *src, const float *h, int c)
+{
+	const int H = INTERP_TAPS >> 1;
+	const float complex *d;
+	float re = 0.0f, im = 0.0f;
+	int k, kb, ke;
+
+	if (c < 0 || c >= src->len)
+		return 0.0f;
+
+	/* out = sum_k h[k] * src[c + H - k], for the indices inside src */
+	kb = (c + H >= src->len) ? (c + H - src->len + 1) : 0;
+	ke = (c - H < 0) ? (c + H + 1) : INTERP_TAPS;
+
+	d = &src->data[c + H];
+
+	for (k=kb; k<ke; k++) {
+		re += h[k] * crealf(d[-k]);
+		im += h[k] * cimagf(d[-k]);
+	}
+
+	return re + im * I;
 }
 
 /*! \brief Perform final alignement (1 sps and proper length/alignement)
- *  \param[in] burst_type Burst format description
+ *  \param[in] ctx Demodulator context (gives burst type, sps and work state)
  *  \param[in] burst The input complex vector
- *  \param[in] sps Input sample per symbol (how much to decimate)
  *  \param[in] toa Estimated fractional TOA to align to
  *  \returns 0 for success. -errno for errors
  *
  *  In the end, each complex inside the burst corresponds to a sample,
  *  aligned according to the burst description.
+ *
+ *  For sps < 4, the fractional part of the TOA is quantized to the nearest
+ *  1/INTERP_PHASES step of a precomputed polyphase filter bank and only the
+ *  samples needed at the output are interpolated.
  */
 static int
-_gmr1_pi4cxpsk_align(struct gmr1_pi4cxpsk_burst *burst_type,
-                     struct osmo_cxvec *burst, int sps, float toa)
+_gmr1_pi4cxpsk_align(struct gmr1_pi4cxpsk_demod_ctx *ctx,
+                     struct osmo_cxvec *burst, float toa)
 {
-	int i, rv = 0;
+	const struct gmr1_pi4cxpsk_burst *burst_type = ctx->burst_type;
+	int sps = ctx->sps;
+	int i;
 
 	if (sps >= 4) {
 		/* Easy case: we can just round everything and not use
@@ -297,54 +576,45 @@ _gmr1_pi4cxpsk_align(struct gmr1_pi4cxpsk_burst *burst_type,
 		burst->len = burst_type->len;
 	} else {
 		/* Hard case: we need to interpolate every point */
-		struct osmo_cxvec *conv = NULL, *src = burst;
-		int ofs_int;
+		int ofs_int, phase;
 		float ofs_frac;
 
 		ofs_int = roundf(toa);
 		ofs_frac = toa - ofs_int;
 
-		src = burst;
-
 		/* Fractional part (if reasonable) */
-		if (fabs(ofs_frac) > 0.1f) {
-			const int N = 21;
-			float complex _data[N];
-			struct osmo_cxvec _sinc_pulse, *sinc_pulse = &_sinc_pulse;
-
-			/* Build sinc pulse */
-			for (i=0; i<N; i++)
-				_data[i] = osmo_sinc(
-					M_PIf * ((float)(i - (N>>1)) + ofs_frac)
-				);
-
-			osmo_cxvec_init_from_data(sinc_pulse, _data, N);
-			sinc_pulse->flags |= CXVEC_FLG_REAL_ONLY;
-
-			/* Apply it */
-			conv = osmo_cxvec_convolve(sinc_pulse, burst, CONV_NO_DELAY, NULL);
-			src = conv;
-		}
-
-		/* Integer part */
-		for (i=0; i<burst_type->len; i++) {
-			int j = (i*sps) + ofs_int;
-			if (j < 0 || j >= src->len)
-				burst->data[i] = 0.0f;
-			else
-				burst->data[i] = src->data[j];
+		phase = 0;
+
+		if (fabs(ofs_frac) > 0.1f)
+			phase = roundf(ofs_frac * INTERP_PHASES);
+
+		if (phase) {
+			const float *h = &g_interp[(phase + (INTERP_PHASES>>1)) * INTERP_TAPS];
+			struct osmo_cxvec *conv = ctx->conv;
+
+			for (i=0; i<burst_type->len; i++)
+				conv->data[i] = _gmr1_pi4cxpsk_interp_point(
+					burst, h, (i*sps) + ofs_int);
+
+			memcpy(burst->data, conv->data,
+			       burst_type->len * sizeof(float complex));
+		} else {
+			/* Integer part only */
+			for (i=0; i<burst_type->len; i++) {
+				int j = (i*sps) + ofs_int;
+				if (j < 0 || j >= burst->len)
+					burst->data[i] = 0.0f;
+				else
+					burst->data[i] = burst->data[j];
+			}
 		}
 
 		burst->len = burst_type->len;
-
-		/* Cleanup */
-		if (conv)
-			osmo_cxvec_free(conv);
 	}
 
 	DEBUG_SIGNAL("pi4cxpsk_align", burst);
 
-	return rv;
+	return 0;
 }
 
 /*! \brief Estimate fine frequency error based on sync sequence chunks phase
@@ -358,11 +628,12 @@ _gmr1_pi4cxpsk_align(struct gmr1_pi4cxpsk_burst *burst_type,
  *  there is only one, 0.0f is returned.
  */
 static int
-_gmr1_pi4cxpsk_freq_err(struct gmr1_pi4cxpsk_burst *burst_type,
+_gmr1_pi4cxpsk_freq_err(const struct gmr1_pi4cxpsk_burst *burst_type,
                         struct osmo_cxvec *burst, int sync_id,
                         float *freq_error)
 {
-	struct gmr1_pi4cxpsk_sync *csync;
+	const struct gmr1_pi4cxpsk_symbol *syms = burst_type->mod->syms;
+	const struct gmr1_pi4cxpsk_sync *csync;
 	int n, i, j;
 
 	/* Count the chunks */
@@ -384,7 +655,7 @@ _gmr1_pi4cxpsk_freq_err(struct gmr1_pi4cxpsk_burst *burst_type,
 
 			for (j=0; j<csync->len; j++)
 				corr[i] +=
-					conjf(csync->_ref->data[j]) *
+					conjf(syms[csync->syms[j]].mod_val) *
 					burst->data[csync->pos+j];
 		}
 
@@ -413,18 +684,19 @@ _gmr1_pi4cxpsk_freq_err(struct gmr1_pi4cxpsk_burst *burst_type,
  *  \returns 0 for success. -errno for errors
  */
 static int
-_gmr1_pi4cxpsk_phase(struct gmr1_pi4cxpsk_burst *burst_type,
+_gmr1_pi4cxpsk_phase(const struct gmr1_pi4cxpsk_burst *burst_type,
                      struct osmo_cxvec *burst, int sync_id,
                      float complex *phasor)
 {
-	struct gmr1_pi4cxpsk_sync *csync;
+	const struct gmr1_pi4cxpsk_symbol *syms = burst_type->mod->syms;
+	const struct gmr1_pi4cxpsk_sync *csync;
 	float complex corr = 0.0f;
 	int i;
 
 	/* Correlate all 'chunks' */
 	for (csync=burst_type->sync[sync_id]; csync->pos>=0; csync++)
 		for (i=0; i<csync->len; i++)
-			corr += conjf(csync->_ref->data[i]) *
+			corr += conjf(syms[csync->syms[i]].mod_val) *
 				burst->data[csync->pos+i];
 
 	*phasor = corr / cabsf(corr);
@@ -432,80 +704,188 @@ _gmr1_pi4cxpsk_phase(struct gmr1_pi4cxpsk_burst *burst_type,
 	return 0;
 }
 
-/*! \brief Convert complex vector into soft symbols based on phase
+/*! \brief Convert the data chunks of a phase aligned burst into softbits
  *  \param[in] burst_type Burst format description
- *  \param[in] burst The input complex vector
- *  \returns Newly malloc'd array of float of same legnth as burst
+ *  \param[in] burst The input complex vector (1 sps, phase aligned)
+ *  \param[out] ebits Encoded soft bits return array
+ *  \returns 0 for success. -errno for errors
+ */
+static int
+_gmr1_pi4cxpsk_soft_bits(const struct gmr1_pi4cxpsk_burst *burst_type,
+                         struct osmo_cxvec *burst, sbit_t *ebits)
+{
+	const struct gmr1_pi4cxpsk_modulation *mod = burst_type->mod;
+	const struct gmr1_pi4cxpsk_data *dc;
+	int k = 0;
+
+	for (dc = burst_type->data; dc->pos>=0; dc++) {
+		gmr1_pi4cxpsk_soft_bits(mod, &burst->data[dc->pos], dc->len, &ebits[k]);
+		k += dc->len * mod->nbits;
+	}
+
+	return 0;
+}
+
+/*! \brief Allocates a demodulator context, possibly partial
+ *  \param[in] burst_type Burst format description
+ *  \param[in] sps Oversampling used in the input complex signals
+ *  \param[in] max_win Maximum search window (in samples) of the input signals
+ *  \param[in] flags CTX_NO_FFT and/or CTX_SYNC_ONLY
+ *  \returns A newly allocated context, NULL for errors
  *
- * Phase must have been aligned properly obviously
+ * The legacy single call API uses a context only once: precomputing the
+ * FFT spectra of the references doesn't pay off there (CTX_NO_FFT) and the
+ * burst type detection only needs the sync search state (CTX_SYNC_ONLY).
  */
-static float *
-_gmr1_pi4cxpsk_soft_symbols(struct gmr1_pi4cxpsk_burst *burst_type,
-                            struct osmo_cxvec *burst)
+static struct gmr1_pi4cxpsk_demod_ctx *
+_gmr1_pi4cxpsk_ctx_alloc(const struct gmr1_pi4cxpsk_burst *burst_type,
+                         int sps, int max_win, int flags)
 {
-	float *ssyms;
-	float d;
-	int i;
+	struct gmr1_pi4cxpsk_demod_ctx *ctx;
+	int max_len;
 
-	ssyms = malloc(sizeof(float) * burst->len);
-	if (!ssyms)
+	if ((sps < 1) || (max_win < 0))
 		return NULL;
 
-	d = (2.0f * M_PIf) / (1<<burst_type->mod->nbits);
+	max_len = (burst_type->len * sps) + max_win;
+
+	ctx = calloc(1, sizeof(struct gmr1_pi4cxpsk_demod_ctx));
+	if (!ctx)
+		return NULL;
+
+	ctx->burst_type = burst_type;
+	ctx->sps = sps;
+	ctx->max_win = max_win;
+
+	/* Generate reference sync bursts */
+	if (_gmr1_pi4cxpsk_sync_gen_ref(ctx))
+		goto err;
+
+	/* Sync search buffers */
+	ctx->corr     = osmo_cxvec_alloc(max_win + 1);
+	ctx->corr_tmp = osmo_cxvec_alloc(max_win + 1);
+
+	if (!ctx->corr || !ctx->corr_tmp)
+		goto err;
+
+	/* FFT correlation state */
+	if (!(flags & CTX_NO_FFT) && _gmr1_pi4cxpsk_fft_init(ctx))
+		goto err;
+
+	if (flags & CTX_SYNC_ONLY)
+		return ctx;
+
+	/* Demodulation buffers */
+	ctx->burst = osmo_cxvec_alloc(max_len);
+	if (!ctx->burst)
+		goto err;
+
+	if (sps < 4) {
+		ctx->conv = osmo_cxvec_alloc(burst_type->len);
+		if (!ctx->conv)
+			goto err;
 
-	for (i=0; i<burst->len; i++)
-		ssyms[i] = cargf(burst->data[i]) / d;
+		pthread_once(&g_interp_once, _gmr1_pi4cxpsk_interp_gen);
+	}
 
-	return ssyms;
+	return ctx;
+
+err:
+	gmr1_pi4cxpsk_demod_release(ctx);
+	return NULL;
 }
 
-/*! \brief Convert a soft symbols array into softbits
+/*! \brief Allocates a demodulator context for a given burst type and sps
  *  \param[in] burst_type Burst format description
- *  \param[in] ssyms Soft symbols array
+ *  \param[in] sps Oversampling used in the input complex signals
+ *  \param[in] max_win Maximum search window (in samples) of the input signals
+ *  \returns A newly allocated context, to be freed with
+ *            \ref gmr1_pi4cxpsk_demod_release
+ *
+ * All the work buffers needed by \ref gmr1_pi4cxpsk_demod_ex are sized and
+ * allocated here once, so that demodulating a burst doesn't need any further
+ * memory allocation. Input signals passed to this context can be up to
+ * (burst_type->len * sps + max_win) samples long.
+ */
+struct gmr1_pi4cxpsk_demod_ctx *
+gmr1_pi4cxpsk_demod_alloc(const struct gmr1_pi4cxpsk_burst *burst_type,
+                          int sps, int max_win)
+{
+	return _gmr1_pi4cxpsk_ctx_alloc(burst_type, sps, max_win, 0);
+}
+
+/*! \brief Release a demodulator context created by \ref gmr1_pi4cxpsk_demod_alloc
+ *  \param[in] ctx The demodulator context to release
+ */
+void
+gmr1_pi4cxpsk_demod_release(struct gmr1_pi4cxpsk_demod_ctx *ctx)
+{
+	if (!ctx)
+		return;
+
+	_gmr1_pi4cxpsk_fft_fini(ctx);
+
+	osmo_cxvec_free(ctx->corr_tmp);
+	osmo_cxvec_free(ctx->corr);
+	osmo_cxvec_free(ctx->conv);
+	osmo_cxvec_free(ctx->burst);
+
+	free(ctx->refs_data);
+	free(ctx->refs);
+
+	free(ctx);
+}
+
+/*! \brief Demodulate a normalized burst whose training sequence was found
+ *  \param[in] ctx Demodulator context (defines burst type and sps)
+ *  \param[in] burst Normalized and counter rotated burst (modified in-place)
+ *  \param[in] sync_id ID of the sync sequence found
+ *  \param[in] toa TOA of the sync sequence found
  *  \param[out] ebits Encoded soft bits return array
+ *  \param[out] freq_err_p Pointer to frequency error return variable (rad/sym)
  *  \returns 0 for success. -errno for errors
  */
 static int
-_gmr1_pi4cxpsk_soft_bits(struct gmr1_pi4cxpsk_burst *burst_type,
-                         float *ssyms, sbit_t *ebits)
+_gmr1_pi4cxpsk_demod_sync(struct gmr1_pi4cxpsk_demod_ctx *ctx,
+                          struct osmo_cxvec *burst, int sync_id, float toa,
+                          sbit_t *ebits, float *freq_err_p)
 {
-	struct gmr1_pi4cxpsk_modulation *mod = burst_type->mod;
-	struct gmr1_pi4cxpsk_data *dc;
-	int mask = (1<<mod->nbits) - 1;
-	int i,j,k;
+	const struct gmr1_pi4cxpsk_burst *burst_type = ctx->burst_type;
+	float fine_freq_error;
+	float complex phasor;
+	int rv;
 
-	k=0;
+	/* Align and decimate the burst */
+	rv = _gmr1_pi4cxpsk_align(ctx, burst, toa);
+	if (rv)
+		return rv;
 
-	for (dc = burst_type->data; dc->pos>=0; dc++) {
-		for (i=dc->pos; i<dc->pos+dc->len; i++)
-		{
-			float sv, svr;
-			int sp, ss, d;
+	/* Use sync sequence to find fine freq error */
+	rv = _gmr1_pi4cxpsk_freq_err(burst_type, burst, sync_id, &fine_freq_error);
+	if (rv)
+		return rv;
 
-			sv  = ssyms[i];
-			svr = roundf(sv);
+	if (freq_err_p)
+		*freq_err_p = fine_freq_error;
 
-			sp = (int)svr & mask;
-			ss = (svr > sv ? (sp-1) : (sp+1)) & mask;
+	/* Compensate fine freq error (in-place) */
+	if (fine_freq_error != 0.0f)
+		osmo_cxvec_rotate(burst, -fine_freq_error, burst);
 
-			d = roundf((2.0f * fabs(svr - sv)) * 64.0f);
+	/* Find current phase using sync sequence */
+	_gmr1_pi4cxpsk_phase(burst_type, burst, sync_id, &phasor);
 
-			for (j=0; j<mod->nbits; j++) {
-				uint8_t vp = mod->syms[sp].data[j];
-				uint8_t vs = mod->syms[ss].data[j];
-				sbit_t v = 127 - ((vp^vs) ? d : (d>>1));
-				ebits[k++] = vp ? -v : v;
-			}
-		}
-	}
+	/* Align phase for detection */
+	osmo_cxvec_scale(burst, conjf(phasor), burst);
+	DEBUG_SIGNAL("pi4cxpsk_final", burst);
 
-	return 0;
+	/* Convert phase to data bits */
+	return _gmr1_pi4cxpsk_soft_bits(burst_type, burst, ebits);
 }
 
-/*! \brief All-in-one pi4-CxPSK demodulation method
- *  \param[in] burst_type Burst format description
+/*! \brief All-in-one pi4-CxPSK demodulation method using a demodulator context
+ *  \param[in] ctx Demodulator context (defines burst type and sps)
  *  \param[in] burst_in Complex signal of the burst
- *  \param[in] sps Oversampling used in the input complex signal
  *  \param[in] freq_shift Frequency shift to pre-apply to burst_in (rad/sym)
  *  \param[out] ebits Encoded soft bits return array
  *  \param[out] sync_id_p Pointer to sync sequence id return variable
@@ -513,43 +893,38 @@ _gmr1_pi4cxpsk_soft_bits(struct gmr1_pi4cxpsk_burst *burst_type,
  *  \param[out] freq_err_p Pointer to frequency error return variable (rad/sym)
  *  \returns 0 for success. -errno for errors
  *
- * burst_in is expected to be longer than necessary. Any extra length will be
- * used as 'search window' to find proper alignement. Good practice is to have
- * a few samples too much in front and a few samples after the expected TOA.
+ * Same as \ref gmr1_pi4cxpsk_demod but all the processing happens in the
+ * pre-allocated buffers of the context. burst_in can't be longer than what
+ * the context was sized for.
  */
 int
-gmr1_pi4cxpsk_demod(struct gmr1_pi4cxpsk_burst *burst_type,
-                    struct osmo_cxvec *burst_in, int sps, float freq_shift,
-                    sbit_t *ebits,
-                    int *sync_id_p, float *toa_p, float *freq_err_p)
+gmr1_pi4cxpsk_demod_ex(struct gmr1_pi4cxpsk_demod_ctx *ctx,
+                       struct osmo_cxvec *burst_in, float freq_shift,
+                       sbit_t *ebits,
+                       int *sync_id_p, float *toa_p, float *freq_err_p)
 {
-	struct osmo_cxvec *burst = NULL;
-	float toa, fine_freq_error;
-	float complex phasor;
-	float *ssyms = NULL;
+	const struct gmr1_pi4cxpsk_burst *burst_type = ctx->burst_type;
+	struct osmo_cxvec *burst;
+	float toa;
+	int sps = ctx->sps;
 	int sync_id;
-	int rv = 0;
 
-	/* Generate reference sync bursts */
-	rv = _gmr1_pi4cxpsk_sync_gen_ref(burst_type);
-	if (rv)
-		goto err;
+	/* Check the input fits */
+	if ((burst_in->len < (burst_type->len * sps)) ||
+	    (burst_in->len > ctx->burst->max_len))
+		return -EINVAL;
 
 	/* Normalize the burst and counter rotate by pi/4 */
-	burst = osmo_cxvec_sig_normalize(burst_in, 1, (freq_shift - burst_type->mod->rotation) / sps, NULL);
-	if (!burst) {
-		rv = -ENOMEM;
-		goto err;
-	}
+	burst = osmo_cxvec_sig_normalize(burst_in, 1, (freq_shift - burst_type->mod->rotation) / sps, ctx->burst);
+	if (!burst)
+		return -EINVAL;
 
 	DEBUG_SIGNAL("pi4cxpsk_burst", burst);
 
 	/* Find the training sequence */
-	sync_id = _gmr1_pi4cxpsk_sync_find(burst_type, burst, sps, &toa, NULL);
-	if (sync_id < 0) {
-		rv = sync_id;
-		goto err;
-	}
+	sync_id = _gmr1_pi4cxpsk_sync_find(ctx, burst, &toa, NULL);
+	if (sync_id < 0)
+		return sync_id;
 
 	if (sync_id_p)
 		*sync_id_p = sync_id;
@@ -557,46 +932,53 @@ gmr1_pi4cxpsk_demod(struct gmr1_pi4cxpsk_burst *burst_type,
 	if (toa_p)
 		*toa_p = toa;
 
-	/* Align and decimate the burst */
-	rv = _gmr1_pi4cxpsk_align(burst_type, burst, sps, toa);
-	if (rv)
-		goto err;
-
-	/* Use sync sequence to find fine freq error */
-	rv = _gmr1_pi4cxpsk_freq_err(burst_type, burst, sync_id, &fine_freq_error);
-	if (rv)
-		goto err;
-
-	if (freq_err_p)
-		*freq_err_p = fine_freq_error;
-
-	/* Compensate fine freq error (in-place) */
-	if (fine_freq_error != 0.0f)
-		osmo_cxvec_rotate(burst, -fine_freq_error, burst);
+	/* Align and demodulate */
+	return _gmr1_pi4cxpsk_demod_sync(ctx, burst, sync_id, toa,
+	                                 ebits, freq_err_p);
+}
 
-	/* Find current phase using sync sequence */
-	_gmr1_pi4cxpsk_phase(burst_type, burst, sync_id, &phasor);
+/*! \brief All-in-one pi4-CxPSK demodulation method
+ *  \param[in] burst_type Burst format description
+ *  \param[in] burst_in Complex signal of the burst
+ *  \param[in] sps Oversampling used in the input complex signal
+ *  \param[in] freq_shift Frequency shift to pre-apply to burst_in (rad/sym)
+ *  \param[out] ebits Encoded soft bits return array
+ *  \param[out] sync_id_p Pointer to sync sequence id return variable
+ *  \param[out] toa_p Pointer to TOA return variable
+ *  \param[out] freq_err_p Pointer to frequency error return variable (rad/sym)
+ *  \returns 0 for success. -errno for errors
+ *
+ * burst_in is expected to be longer than necessary. Any extra length will be
+ * used as 'search window' to find proper alignement. Good practice is to have
+ * a few samples too much in front and a few samples after the expected TOA.
+ *
+ * This uses a temporary demodulator context (without FFT correlation
+ * state) for each call, see \ref gmr1_pi4cxpsk_demod_ex to avoid that when
+ * processing many bursts.
+ */
+int
+gmr1_pi4cxpsk_demod(const struct gmr1_pi4cxpsk_burst *burst_type,
+                    struct osmo_cxvec *burst_in, int sps, float freq_shift,
+                    sbit_t *ebits,
+                    int *sync_id_p, float *toa_p, float *freq_err_p)
+{
+	struct gmr1_pi4cxpsk_demod_ctx *ctx;
+	int win, rv;
 
-	/* Align phase for detection */
-	osmo_cxvec_scale(burst, conjf(phasor), burst);
-	DEBUG_SIGNAL("pi4cxpsk_final", burst);
+	/* Search window */
+	win = burst_in->len - (burst_type->len * sps);
+	if (win < 0)
+		return -EINVAL;
 
-	/* Convert phase to soft symbols */
-	ssyms = _gmr1_pi4cxpsk_soft_symbols(burst_type, burst);
-	if (!ssyms) {
-		rv = -ENOMEM;
-		goto err;
-	}
+	/* Temporary context */
+	ctx = _gmr1_pi4cxpsk_ctx_alloc(burst_type, sps, win, CTX_NO_FFT);
+	if (!ctx)
+		return -ENOMEM;
 
-	/* Convert to data bits */
-	rv = _gmr1_pi4cxpsk_soft_bits(burst_type, ssyms, ebits);
-	if (rv)
-		goto err;
+	rv = gmr1_pi4cxpsk_demod_ex(ctx, burst_in, freq_shift, ebits,
+	                            sync_id_p, toa_p, freq_err_p);
 
-	/* Cleanup */
-err:
-	free(ssyms);
-	osmo_cxvec_free(burst);
+	gmr1_pi4cxpsk_demod_release(ctx);
 
 	return rv;
 }
@@ -615,11 +997,12 @@ err:
  * The various burst types must be compatible in length and modulation !
  */
 int
-gmr1_pi4cxpsk_detect(struct gmr1_pi4cxpsk_burst **burst_types, float e_toa,
+gmr1_pi4cxpsk_detect(const struct gmr1_pi4cxpsk_burst **burst_types, float e_toa,
                      struct osmo_cxvec *burst_in, int sps, float freq_shift,
                      int *bt_id_p, int *sync_id_p, float *toa_p)
 {
-	struct gmr1_pi4cxpsk_burst *bt;
+	const struct gmr1_pi4cxpsk_burst *bt;
+	struct gmr1_pi4cxpsk_demod_ctx *ctx;
 	struct osmo_cxvec *burst = NULL;
 	int id, p_id=-1, p_sid=-1;
 	float p_toa=0.0f, p_pwr=0.0f;
@@ -642,13 +1025,19 @@ gmr1_pi4cxpsk_detect(struct gmr1_pi4cxpsk_burst **burst_types, float e_toa,
 
 		bt = burst_types[id];
 
-		/* Generate reference sync bursts */
-		rv = _gmr1_pi4cxpsk_sync_gen_ref(bt);
-		if (rv)
+		/* Temporary sync search only context for this burst type */
+		ctx = _gmr1_pi4cxpsk_ctx_alloc(bt, sps, burst->len - (bt->len * sps),
+		                               CTX_NO_FFT | CTX_SYNC_ONLY);
+		if (!ctx) {
+			rv = -ENOMEM;
 			goto err;
+		}
 
 		/* Try this burst type */
-		sid = _gmr1_pi4cxpsk_sync_find(bt, burst, sps, &toa, &pwr);
+		sid = _gmr1_pi4cxpsk_sync_find(ctx, burst, &toa, &pwr);
+
+		gmr1_pi4cxpsk_demod_release(ctx);
+
 		if (sid < 0) {
 			rv = sid;
 			goto err;
@@ -681,6 +1070,94 @@ err:
 	return rv;
 }
 
+/*! \brief Identify the burst type and demodulate it in a single pass
+ *  \param[in] ctxs Demodulator contexts of the burst types to test (NULL terminated)
+ *  \param[in] e_toa Expected time of arrival (<0 if unknown)
+ *  \param[in] burst_in Complex signal of the burst
+ *  \param[in] freq_shift Frequency shift to pre-apply to burst_in (rad/sym)
+ *  \param[out] ebits Encoded soft bits return array (sized for the longest type)
+ *  \param[out] bt_id_p Pointer to burst type ID (index in ctxs) return variable
+ *  \param[out] sync_id_p Pointer to sync sequence id return variable
+ *  \param[out] toa_p Pointer to TOA return variable
+ *  \param[out] freq_err_p Pointer to frequency error return variable (rad/sym)
+ *  \returns 0 for success. -errno for errors
+ *
+ * Equivalent to \ref gmr1_pi4cxpsk_detect followed by
+ * \ref gmr1_pi4cxpsk_demod_ex on the winning context, but the burst is only
+ * normalized and counter rotated once (in the buffer of the first context)
+ * and the training sequences of all the candidates are searched in that
+ * shared buffer. Only the winning hypothesis is demodulated.
+ *
+ * All the contexts must use the same sps and compatible burst types (same
+ * length and modulation) and must have been sized for burst_in.
+ */
+int
+gmr1_pi4cxpsk_detect_demod(struct gmr1_pi4cxpsk_demod_ctx **ctxs, float e_toa,
+                           struct osmo_cxvec *burst_in, float freq_shift,
+                           sbit_t *ebits,
+                           int *bt_id_p, int *sync_id_p, float *toa_p,
+                           float *freq_err_p)
+{
+	struct gmr1_pi4cxpsk_demod_ctx *ctx = ctxs[0];
+	struct osmo_cxvec *burst;
+	int id, p_id=-1, p_sid=-1;
+	float p_toa=0.0f, p_pwr=0.0f;
+
+	/* Check the input fits */
+	if ((burst_in->len < (ctx->burst_type->len * ctx->sps)) ||
+	    (burst_in->len > ctx->burst->max_len))
+		return -EINVAL;
+
+	/* Normalize the burst and counter rotate (once for all types) */
+	burst = osmo_cxvec_sig_normalize(burst_in, 1,
+		(freq_shift - ctx->burst_type->mod->rotation) / ctx->sps,
+		ctx->burst);
+	if (!burst)
+		return -EINVAL;
+
+	DEBUG_SIGNAL("pi4cxpsk_burst", burst);
+
+	/* Search the training sequences of all types */
+	for (id=0; ctxs[id]; id++)
+	{
+		int sid;
+		float toa, pwr;
+
+		if (ctxs[id]->sps != ctx->sps)
+			return -EINVAL;
+
+		sid = _gmr1_pi4cxpsk_sync_find(ctxs[id], burst, &toa, &pwr);
+		if (sid < 0)
+			return sid;
+
+		/* If we have an expected, toa, we 'modulate' power */
+		if (e_toa >= 0.0f)
+			pwr /= fabs(e_toa - toa);
+
+		/* Check for better ? */
+		if (pwr > p_pwr) {
+			p_id  = id;
+			p_sid = sid;
+			p_pwr = pwr;
+			p_toa = toa;
+		}
+	}
+
+	if (p_id < 0)
+		return -EINVAL;
+
+	if (bt_id_p)
+		*bt_id_p = p_id;
+	if (sync_id_p)
+		*sync_id_p = p_sid;
+	if (toa_p)
+		*toa_p = p_toa;
+
+	/* Demodulate the winner only */
+	return _gmr1_pi4cxpsk_demod_sync(ctxs[p_id], burst, p_sid, p_toa,
+	                                 ebits, freq_err_p);
+}
+
 /*! \brief Estimates modulation order by comparing power of x^2 vs x^4
  *  \param[in] burst_in Complex signal of the burst
  *  \param[in] sps Oversampling used in the input complex signal
@@ -739,12 +1216,12 @@ err:
  *  see the burst_type structure for how long that is.
  */
 int
-gmr1_pi4cxpsk_mod(struct gmr1_pi4cxpsk_burst *burst_type,
+gmr1_pi4cxpsk_mod(const struct gmr1_pi4cxpsk_burst *burst_type,
                   ubit_t *ebits, int sync_id, struct osmo_cxvec *burst_out)
 {
-	struct gmr1_pi4cxpsk_modulation *mod = burst_type->mod;
-	struct gmr1_pi4cxpsk_sync *sync;
-	struct gmr1_pi4cxpsk_data *data;
+	const struct gmr1_pi4cxpsk_modulation *mod = burst_type->mod;
+	const struct gmr1_pi4cxpsk_sync *sync;
+	const struct gmr1_pi4cxpsk_data *data;
 	int rv, i, j, k;
 
 	/* Check the output vector is long enough */
@@ -755,11 +1232,6 @@ gmr1_pi4cxpsk_mod(struct gmr1_pi4cxpsk_burst *burst_type,
 
 	burst_out->len = burst_type->len;
 
-	/* Generate reference sync bursts */
-	rv = _gmr1_pi4cxpsk_sync_gen_ref(burst_type);
-	if (rv)
-		goto err;
-
 	/* Fill guard */
 	for (i=0; i<burst_type->guard_pre; i++)
 		burst_out->data[i] = 0.0f;
@@ -770,7 +1242,7 @@ gmr1_pi4cxpsk_mod(struct gmr1_pi4cxpsk_burst *burst_type,
 	for (sync=burst_type->sync[sync_id]; sync->len; sync++)
 	{
 		for (i=0; i<sync->len; i++)
-			burst_out->data[sync->pos+i] = sync->_ref->data[i];
+			burst_out->data[sync->pos+i] = mod->syms[sync->syms[i]].mod_val;
 	}
 
 	/* Fill ebits */
@@ -0,0 +1,611 @@
+/* GMR-1 SDR - pi2-CBPSK, pi4-CBPSK and pi4-CQPSK soft bits conversion */
+/* See GMR-1 05.004 (ETSI TS 101 376-5-4 V1.2.1) - Section 5.1 & 5.2 */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \addtogroup pi4cxpsk
+ *  @{
+ */
+
+/*! \file sdr/pi4cxpsk_soft.c
+ *  \brief Osmocom GMR-1 pi4-CxPSK soft bits conversion
+ *
+ * The reference (scalar) implementation computes the phase of each symbol
+ * with cargf(), finds the nearest and second nearest constellation points
+ * and derives the soft bits from the distance to the nearest one.
+ *
+ * The vector implementations (SSE2, AVX2 and NEON, selected at runtime)
+ * compute the same thing using a polynomial arctangent approximation
+ * (|error| < 1e-5 rad, Abramowitz & Stegun 4.4.49). The nearest point is
+ * decided with exact comparisons on the real and imaginary parts, so the
+ * sign of every soft bit matches the scalar version (except for symbols
+ * exactly on a pi4-CQPSK decision boundary) and the magnitude is within +-1
+ * (rounding of exact ties and approximation error).
+ *
+ * Like all the NEON code of the library, the NEON implementation is only
+ * built with --enable-neon (GMR1_NEON).
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <osmocom/core/bits.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON) && defined(GMR1_NEON)
+#define HAVE_NEON_KERNEL
+#include <arm_neon.h>
+#endif
+
+#include <osmocom/dsp/cxvec_math.h>
+
+#include <osmocom/gmr1/sdr/pi4cxpsk.h>
+
+
+/*! \brief Soft bits conversion kernel signature
+ *  \param[in] codes Bits of each symbol (data[0] as MSB)
+ *  \param[in] nbits Number of bits per symbol (1 or 2)
+ *  \param[in] in Phase aligned symbols (1 sps)
+ *  \param[in] n Number of symbols
+ *  \param[out] ebits Soft bits return array (n * nbits)
+ */
+typedef void (*soft_bits_fn_t)(const uint8_t *codes, int nbits,
+                               const float complex *in, int n, sbit_t *ebits);
+
+
+/* ------------------------------------------------------------------------ */
+/* Scalar reference                                                         */
+/* ------------------------------------------------------------------------ */
+
+static void
+_soft_bits_scalar(const uint8_t *codes, int nbits,
+                  const float complex *in, int n, sbit_t *ebits)
+{
+	int mask = (1<<nbits) - 1;
+	float d = (2.0f * M_PIf) / (1<<nbits);
+	int i, j, k = 0;
+
+	for (i=0; i<n; i++)
+	{
+		float sv, svr;
+		int sp, ss, dd;
+
+		sv  = cargf(in[i]) / d;
+		svr = roundf(sv);
+
+		sp = (int)svr & mask;
+		ss = (svr > sv ? (sp-1) : (sp+1)) & mask;
+
+		dd = roundf((2.0f * fabs(svr - sv)) * 64.0f);
+
+		for (j=0; j<nbits; j++) {
+			uint8_t vp = (codes[sp] >> (nbits-1-j)) & 1;
+			uint8_t vs = (codes[ss] >> (nbits-1-j)) & 1;
+			sbit_t v = 127 - ((vp^vs) ? dd : (dd>>1));
+			ebits[k++] = vp ? -v : v;
+		}
+	}
+}
+
+
+/* ------------------------------------------------------------------------ */
+/* SSE2                                                                     */
+/* ------------------------------------------------------------------------ */
+
+#if defined(__SSE2__)
+
+/*! \brief Polynomial atan2 approximation on 4 lanes */
+static inline __m128
+_atan2_sse2(__m128 y, __m128 x)
+{
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	__m128 ax, ay, mx, mn, a, s, r, m;
+
+	ax = _mm_andnot_ps(sign, x);
+	ay = _mm_andnot_ps(sign, y);
+	mx = _mm_max_ps(ax, ay);
+	mn = _mm_min_ps(ax, ay);
+	a  = _mm_div_ps(mn, _mm_max_ps(mx, _mm_set1_ps(1e-30f)));
+	s  = _mm_mul_ps(a, a);
+
+	r = _mm_set1_ps(0.0208351f);
+	r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.0851330f));
+	r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps( 0.1801410f));
+	r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.3302995f));
+	r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps( 0.9998660f));
+	r = _mm_mul_ps(r, a);
+
+	m = _mm_cmpgt_ps(ay, ax);
+	r = _mm_or_ps(_mm_and_ps(m, _mm_sub_ps(_mm_set1_ps(M_PIf/2), r)), _mm_andnot_ps(m, r));
+
+	m = _mm_cmplt_ps(x, _mm_setzero_ps());
+	r = _mm_or_ps(_mm_and_ps(m, _mm_sub_ps(_mm_set1_ps(M_PIf), r)), _mm_andnot_ps(m, r));
+
+	return _mm_or_ps(r, _mm_and_ps(sign, y));
+}
+
+/*! \brief Soft bits of 4 symbols, as int32 lanes (one vector per bit) */
+static inline void
+_soft_bits4_sse2(const uint8_t *codes, int nbits, __m128 re, __m128 im,
+                 __m128i *e)
+{
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128 zero = _mm_setzero_ps();
+	int M = 1 << nbits;
+	__m128i sp, ss, d, cp, cs, m;
+	__m128 sv, t, tm;
+	int s, j;
+
+	/* Nearest symbol (exact decision) */
+	if (nbits == 1) {
+		__m128 l = _mm_or_ps(_mm_cmplt_ps(re, zero),
+			_mm_and_ps(_mm_cmpeq_ps(re, zero), _mm_cmpneq_ps(im, zero)));
+		sp = _mm_and_si128(_mm_castps_si128(l), one);
+	} else {
+		__m128 ax = _mm_andnot_ps(_mm_set1_ps(-0.0f), re);
+		__m128 ay = _mm_andnot_ps(_mm_set1_ps(-0.0f), im);
+		__m128i mx = _mm_castps_si128(_mm_cmpge_ps(ax, ay));
+		__m128i sx = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(re, zero)), _mm_set1_epi32(2));
+		__m128i sy = _mm_or_si128(one, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(im, zero)), _mm_set1_epi32(2)));
+		sp = _mm_or_si128(_mm_and_si128(mx, sx), _mm_andnot_si128(mx, sy));
+	}
+
+	/* Signed distance to it (in symbol units, wrapped) */
+	sv = _mm_mul_ps(_atan2_sse2(im, re), _mm_set1_ps((float)M / (2.0f * M_PIf)));
+	t  = _mm_sub_ps(sv, _mm_cvtepi32_ps(sp));
+	tm = _mm_cmpgt_ps(t, _mm_set1_ps(M / 2.0f));
+	t  = _mm_sub_ps(t, _mm_and_ps(tm, _mm_set1_ps((float)M)));
+	tm = _mm_cmplt_ps(t, _mm_set1_ps(-M / 2.0f));
+	t  = _mm_add_ps(t, _mm_and_ps(tm, _mm_set1_ps((float)M)));
+
+	/* Second nearest */
+	m  = _mm_castps_si128(_mm_cmplt_ps(t, zero));
+	ss = _mm_add_epi32(sp, _mm_add_epi32(one, _mm_slli_epi32(m, 1)));
+	ss = _mm_and_si128(ss, _mm_set1_epi32(M - 1));
+
+	/* Distance as integer */
+	d = _mm_cvtps_epi32(_mm_mul_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), t), _mm_set1_ps(128.0f)));
+
+	/* Bits of both symbols */
+	cp = cs = _mm_setzero_si128();
+	for (s=0; s<M; s++) {
+		__m128i c = _mm_set1_epi32(codes[s]);
+		__m128i vs = _mm_set1_epi32(s);
+		cp = _mm_or_si128(cp, _mm_and_si128(_mm_cmpeq_epi32(sp, vs), c));
+		cs = _mm_or_si128(cs, _mm_and_si128(_mm_cmpeq_epi32(ss, vs), c));
+	}
+
+	/* Soft bits */
+	for (j=0; j<nbits; j++) {
+		__m128i sh = _mm_cvtsi32_si128(nbits - 1 - j);
+		__m128i vp = _mm_and_si128(_mm_srl_epi32(cp, sh), one);
+		__m128i vd = _mm_and_si128(_mm_xor_si128(vp, _mm_srl_epi32(cs, sh)), one);
+		__m128i dm = _mm_sub_epi32(_mm_setzero_si128(), vd);
+		__m128i v;
+
+		v = _mm_or_si128(_mm_and_si128(dm, d), _mm_andnot_si128(dm, _mm_srai_epi32(d, 1)));
+		v = _mm_sub_epi32(_mm_set1_epi32(127), v);
+
+		m = _mm_sub_epi32(_mm_setzero_si128(), vp);
+		e[j] = _mm_sub_epi32(_mm_xor_si128(v, m), m);
+	}
+}
+
+static void
+_soft_bits_sse2(const uint8_t *codes, int nbits,
+                const float complex *in, int n, sbit_t *ebits)
+{
+	float complex tmp_in[4];
+	sbit_t tmp_out[4 * GMR1_MAX_SYM_EBITS];
+	int i;
+
+	for (i=0; i<n; i+=4)
+	{
+		const float *p = (const float *)&in[i];
+		sbit_t *o = &ebits[i * nbits];
+		__m128 a, b, re, im;
+		__m128i e[2], x;
+		int l = n - i;
+
+		/* Partial last group goes through a padded copy */
+		if (l < 4) {
+			memset(tmp_in, 0x00, sizeof(tmp_in));
+			memcpy(tmp_in, &in[i], sizeof(float complex) * l);
+			p = (const float *)tmp_in;
+			o = tmp_out;
+		}
+
+		a  = _mm_loadu_ps(p);
+		b  = _mm_loadu_ps(p + 4);
+		re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+		im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1));
+
+		_soft_bits4_sse2(codes, nbits, re, im, e);
+
+		if (nbits == 1) {
+			x = _mm_packs_epi32(e[0], e[0]);
+			x = _mm_packs_epi16(x, x);
+			*(int32_t *)o = _mm_cvtsi128_si32(x);
+		} else {
+			x = _mm_packs_epi32(_mm_unpacklo_epi32(e[0], e[1]),
+			                    _mm_unpackhi_epi32(e[0], e[1]));
+			x = _mm_packs_epi16(x, x);
+			_mm_storel_epi64((__m128i *)o, x);
+		}
+
+		if (l < 4)
+			memcpy(&ebits[i * nbits], tmp_out, l * nbits);
+	}
+}
+
+#endif /* __SSE2__ */
+
+
+/* ------------------------------------------------------------------------ */
+/* AVX2                                                                     */
+/* ------------------------------------------------------------------------ */
+
+#if defined(HAVE_AVX2_KERNEL)
+
+/*! \brief Polynomial atan2 approximation on 8 lanes */
+__attribute__((target("avx2")))
+static inline __m256
+_atan2_avx2(__m256 y, __m256 x)
+{
+	const __m256 sign = _mm256_set1_ps(-0.0f);
+	__m256 ax, ay, mx, mn, a, s, r, m;
+
+	ax = _mm256_andnot_ps(sign, x);
+	ay = _mm256_andnot_ps(sign, y);
+	mx = _mm256_max_ps(ax, ay);
+	mn = _mm256_min_ps(ax, ay);
+	a  = _mm256_div_ps(mn, _mm256_max_ps(mx, _mm256_set1_ps(1e-30f)));
+	s  = _mm256_mul_ps(a, a);
+
+	r = _mm256_set1_ps(0.0208351f);
+	r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(-0.0851330f));
+	r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps( 0.1801410f));
+	r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(-0.3302995f));
+	r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps( 0.9998660f));
+	r = _mm256_mul_ps(r, a);
+
+	m = _mm256_cmp_ps(ay, ax, _CMP_GT_OQ);
+	r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(M_PIf/2), r), m);
+
+	m = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ);
+	r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(M_PIf), r), m);
+
+	return _mm256_or_ps(r, _mm256_and_ps(sign, y));
+}
+
+__attribute__((target("avx2")))
+static void
+_soft_bits_avx2(const uint8_t *codes, int nbits,
+                const float complex *in, int n, sbit_t *ebits)
+{
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	float complex tmp_in[8];
+	sbit_t tmp_out[8 * GMR1_MAX_SYM_EBITS];
+	int M = 1 << nbits;
+	int i, j, s;
+
+	for (i=0; i<n; i+=8)
+	{
+		const float *p = (const float *)&in[i];
+		sbit_t *o = &ebits[i * nbits];
+		__m256 a, b, re, im, sv, t, tm;
+		__m256i sp, ss, d, cp, cs, m, e[2];
+		__m128i x0, x1;
+		int l = n - i;
+
+		/* Partial last group goes through a padded copy */
+		if (l < 8) {
+			memset(tmp_in, 0x00, sizeof(tmp_in));
+			memcpy(tmp_in, &in[i], sizeof(float complex) * l);
+			p = (const float *)tmp_in;
+			o = tmp_out;
+		}
+
+		/* Deinterleave (shuffle works per 128 bits lane, fix order) */
+		a  = _mm256_loadu_ps(p);
+		b  = _mm256_loadu_ps(p + 8);
+		re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+		im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1));
+		re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(re), _MM_SHUFFLE(3,1,2,0)));
+		im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(im), _MM_SHUFFLE(3,1,2,0)));
+
+		/* Nearest symbol (exact decision) */
+		if (nbits == 1) {
+			__m256 l = _mm256_or_ps(_mm256_cmp_ps(re, zero, _CMP_LT_OQ),
+				_mm256_and_ps(_mm256_cmp_ps(re, zero, _CMP_EQ_OQ), _mm256_cmp_ps(im, zero, _CMP_NEQ_OQ)));
+			sp = _mm256_and_si256(_mm256_castps_si256(l), one);
+		} else {
+			__m256 ax = _mm256_and_ps(abs_mask, re);
+			__m256 ay = _mm256_and_ps(abs_mask, im);
+			__m256i mx = _mm256_castps_si256(_mm256_cmp_ps(ax, ay, _CMP_GE_OQ));
+			__m256i sx = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(re, zero, _CMP_LT_OQ)), _mm256_set1_epi32(2));
+			__m256i sy = _mm256_or_si256(one, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(im, zero, _CMP_LE_OQ)), _mm256_set1_epi32(2)));
+			sp = _mm256_blendv_epi8(sy, sx, mx);
+		}
+
+		/* Signed distance to it (in symbol units, wrapped) */
+		sv = _mm256_mul_ps(_atan2_avx2(im, re), _mm256_set1_ps((float)M / (2.0f * M_PIf)));
+		t  = _mm256_sub_ps(sv, _mm256_cvtepi32_ps(sp));
+		tm = _mm256_cmp_ps(t, _mm256_set1_ps(M / 2.0f), _CMP_GT_OQ);
+		t  = _mm256_sub_ps(t, _mm256_and_ps(tm, _mm256_set1_ps((float)M)));
+		tm = _mm256_cmp_ps(t, _mm256_set1_ps(-M / 2.0f), _CMP_LT_OQ);
+		t  = _mm256_add_ps(t, _mm256_and_ps(tm, _mm256_set1_ps((float)M)));
+
+		/* Second nearest */
+		m  = _mm256_castps_si256(_mm256_cmp_ps(t, zero, _CMP_LT_OQ));
+		ss = _mm256_add_epi32(sp, _mm256_add_epi32(one, _mm256_slli_epi32(m, 1)));
+		ss = _mm256_and_si256(ss, _mm256_set1_epi32(M - 1));
+
+		/* Distance as integer */
+		d = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_and_ps(abs_mask, t), _mm256_set1_ps(128.0f)));
+
+		/* Bits of both symbols */
+		cp = cs = _mm256_setzero_si256();
+		for (s=0; s<M; s++) {
+			__m256i c = _mm256_set1_epi32(codes[s]);
+			__m256i vs = _mm256_set1_epi32(s);
+			cp = _mm256_or_si256(cp, _mm256_and_si256(_mm256_cmpeq_epi32(sp, vs), c));
+			cs = _mm256_or_si256(cs, _mm256_and_si256(_mm256_cmpeq_epi32(ss, vs), c));
+		}
+
+		/* Soft bits */
+		for (j=0; j<nbits; j++) {
+			__m256i sh = _mm256_set1_epi32(nbits - 1 - j);
+			__m256i vp = _mm256_and_si256(_mm256_srlv_epi32(cp, sh), one);
+			__m256i vd = _mm256_and_si256(_mm256_xor_si256(vp, _mm256_srlv_epi32(cs, sh)), one);
+			__m256i v;
+
+			v = _mm256_blendv_epi8(_mm256_srai_epi32(d, 1), d, _mm256_sub_epi32(_mm256_setzero_si256(), vd));
+			v = _mm256_sub_epi32(_mm256_set1_epi32(127), v);
+
+			m = _mm256_sub_epi32(_mm256_setzero_si256(), vp);
+			e[j] = _mm256_sub_epi32(_mm256_xor_si256(v, m), m);
+		}
+
+		/* Pack (per 128 bits lane) and store */
+		if (nbits == 1) {
+			__m256i x = _mm256_packs_epi32(e[0], e[0]);
+			x = _mm256_packs_epi16(x, x);
+			x0 = _mm256_castsi256_si128(x);
+			x1 = _mm256_extracti128_si256(x, 1);
+			*(int32_t *)&o[0] = _mm_cvtsi128_si32(x0);
+			*(int32_t *)&o[4] = _mm_cvtsi128_si32(x1);
+		} else {
+			__m256i x = _mm256_packs_epi32(_mm256_unpacklo_epi32(e[0], e[1]),
+			                               _mm256_unpackhi_epi32(e[0], e[1]));
+			x = _mm256_packs_epi16(x, x);
+			x0 = _mm256_castsi256_si128(x);
+			x1 = _mm256_extracti128_si256(x, 1);
+			_mm_storel_epi64((__m128i *)&o[0], x0);
+			_mm_storel_epi64((__m128i *)&o[8], x1);
+		}
+
+		if (l < 8)
+			memcpy(&ebits[i * nbits], tmp_out, l * nbits);
+	}
+}
+
+#endif /* HAVE_AVX2_KERNEL */
+
+
+/* ------------------------------------------------------------------------ */
+/* NEON                                                                     */
+/* ------------------------------------------------------------------------ */
+
+#if defined(HAVE_NEON_KERNEL)
+
+/*! \brief Polynomial atan2 approximation on 4 lanes */
+static inline float32x4_t
+_atan2_neon(float32x4_t y, float32x4_t x)
+{
+	float32x4_t ax, ay, mx, mn, a, s, r;
+	uint32x4_t m;
+
+	ax = vabsq_f32(x);
+	ay = vabsq_f32(y);
+	mx = vmaxq_f32(ax, ay);
+	mn = vminq_f32(ax, ay);
+	a  = vdivq_f32(mn, vmaxq_f32(mx, vdupq_n_f32(1e-30f)));
+	s  = vmulq_f32(a, a);
+
+	r = vdupq_n_f32(0.0208351f);
+	r = vmlaq_f32(vdupq_n_f32(-0.0851330f), r, s);
+	r = vmlaq_f32(vdupq_n_f32( 0.1801410f), r, s);
+	r = vmlaq_f32(vdupq_n_f32(-0.3302995f), r, s);
+	r = vmlaq_f32(vdupq_n_f32( 0.9998660f), r, s);
+	r = vmulq_f32(r, a);
+
+	m = vcgtq_f32(ay, ax);
+	r = vbslq_f32(m, vsubq_f32(vdupq_n_f32(M_PIf/2), r), r);
+
+	m = vcltq_f32(x, vdupq_n_f32(0.0f));
+	r = vbslq_f32(m, vsubq_f32(vdupq_n_f32(M_PIf), r), r);
+
+	return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(r),
+		vandq_u32(vreinterpretq_u32_f32(y), vdupq_n_u32(0x80000000))));
+}
+
+static void
+_soft_bits_neon(const uint8_t *codes, int nbits,
+                const float complex *in, int n, sbit_t *ebits)
+{
+	const int32x4_t one = vdupq_n_s32(1);
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	float complex tmp_in[4];
+	sbit_t tmp_out[4 * GMR1_MAX_SYM_EBITS];
+	int M = 1 << nbits;
+	int i, j, s;
+
+	for (i=0; i<n; i+=4)
+	{
+		const float *p = (const float *)&in[i];
+		sbit_t *o = &ebits[i * nbits];
+		float32x4x2_t v2;
+		float32x4_t re, im, sv, t;
+		int32x4_t sp, ss, d, cp, cs, e[2];
+		uint32x4_t m;
+		int l = n - i;
+
+		/* Partial last group goes through a padded copy */
+		if (l < 4) {
+			memset(tmp_in, 0x00, sizeof(tmp_in));
+			memcpy(tmp_in, &in[i], sizeof(float complex) * l);
+			p = (const float *)tmp_in;
+			o = tmp_out;
+		}
+
+		v2 = vld2q_f32(p);
+		re = v2.val[0];
+		im = v2.val[1];
+
+		/* Nearest symbol (exact decision) */
+		if (nbits == 1) {
+			uint32x4_t l = vorrq_u32(vcltq_f32(re, zero),
+				vbicq_u32(vceqq_f32(re, zero), vceqq_f32(im, zero)));
+			sp = vandq_s32(vreinterpretq_s32_u32(l), one);
+		} else {
+			uint32x4_t mx = vcgeq_f32(vabsq_f32(re), vabsq_f32(im));
+			int32x4_t sx = vandq_s32(vreinterpretq_s32_u32(vcltq_f32(re, zero)), vdupq_n_s32(2));
+			int32x4_t sy = vorrq_s32(one, vandq_s32(vreinterpretq_s32_u32(vcleq_f32(im, zero)), vdupq_n_s32(2)));
+			sp = vbslq_s32(mx, sx, sy);
+		}
+
+		/* Signed distance to it (in symbol units, wrapped) */
+		sv = vmulq_f32(_atan2_neon(im, re), vdupq_n_f32((float)M / (2.0f * M_PIf)));
+		t  = vsubq_f32(sv, vcvtq_f32_s32(sp));
+		t  = vbslq_f32(vcgtq_f32(t, vdupq_n_f32(M / 2.0f)), vsubq_f32(t, vdupq_n_f32((float)M)), t);
+		t  = vbslq_f32(vcltq_f32(t, vdupq_n_f32(-M / 2.0f)), vaddq_f32(t, vdupq_n_f32((float)M)), t);
+
+		/* Second nearest */
+		m  = vcltq_f32(t, zero);
+		ss = vbslq_s32(m, vsubq_s32(sp, one), vaddq_s32(sp, one));
+		ss = vandq_s32(ss, vdupq_n_s32(M - 1));
+
+		/* Distance as integer */
+		d = vcvtnq_s32_f32(vmulq_f32(vabsq_f32(t), vdupq_n_f32(128.0f)));
+
+		/* Bits of both symbols */
+		cp = cs = vdupq_n_s32(0);
+		for (s=0; s<M; s++) {
+			int32x4_t c = vdupq_n_s32(codes[s]);
+			int32x4_t vs = vdupq_n_s32(s);
+			cp = vorrq_s32(cp, vandq_s32(vreinterpretq_s32_u32(vceqq_s32(sp, vs)), c));
+			cs = vorrq_s32(cs, vandq_s32(vreinterpretq_s32_u32(vceqq_s32(ss, vs)), c));
+		}
+
+		/* Soft bits */
+		for (j=0; j<nbits; j++) {
+			int32x4_t sh = vdupq_n_s32(-(nbits - 1 - j));
+			int32x4_t vp = vandq_s32(vshlq_s32(cp, sh), one);
+			int32x4_t vd = vandq_s32(veorq_s32(vp, vshlq_s32(cs, sh)), one);
+			int32x4_t v;
+
+			v = vbslq_s32(vceqq_s32(vd, one), d, vshrq_n_s32(d, 1));
+			v = vsubq_s32(vdupq_n_s32(127), v);
+
+			e[j] = vbslq_s32(vceqq_s32(vp, one), vnegq_s32(v), v);
+		}
+
+		/* Pack and store */
+		if (nbits == 1) {
+			int16x4_t h = vqmovn_s32(e[0]);
+			int8x8_t b = vqmovn_s16(vcombine_s16(h, h));
+			vst1_lane_s32((int32_t *)o, vreinterpret_s32_s8(b), 0);
+		} else {
+			int16x4x2_t z = vzip_s16(vqmovn_s32(e[0]), vqmovn_s32(e[1]));
+			int8x8_t b = vqmovn_s16(vcombine_s16(z.val[0], z.val[1]));
+			vst1_s8(o, b);
+		}
+
+		if (l < 4)
+			memcpy(&ebits[i * nbits], tmp_out, l * nbits);
+	}
+}
+
+#endif /* HAVE_NEON_KERNEL */
+
+
+/* ------------------------------------------------------------------------ */
+/* Dispatch                                                                 */
+/* ------------------------------------------------------------------------ */
+
+static soft_bits_fn_t g_soft_bits_fn = _soft_bits_scalar;
+static pthread_once_t g_soft_bits_once = PTHREAD_ONCE_INIT;
+
+/*! \brief Select the best kernel for the running CPU */
+static void
+_soft_bits_select(void)
+{
+#if defined(__SSE2__)
+	g_soft_bits_fn = _soft_bits_sse2;
+#endif
+#if defined(HAVE_AVX2_KERNEL)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		g_soft_bits_fn = _soft_bits_avx2;
+#endif
+#if defined(HAVE_NEON_KERNEL)
+	g_soft_bits_fn = _soft_bits_neon;
+#endif
+}
+
+/*! \brief Convert phase aligned symbols into soft bits
+ *  \param[in] mod Modulation description
+ *  \param[in] syms Complex symbols (1 sps, phase aligned with the reference)
+ *  \param[in] n Number of symbols
+ *  \param[out] ebits Soft bits return array (n * mod->nbits values)
+ *
+ * Uses the fastest implementation available on the running CPU, see the
+ * file description for the tolerance against the scalar reference.
+ */
+void
+gmr1_pi4cxpsk_soft_bits(const struct gmr1_pi4cxpsk_modulation *mod,
+                        const float complex *syms, int n, sbit_t *ebits)
+{
+	uint8_t codes[1 << GMR1_MAX_SYM_EBITS];
+	int i, j;
+
+	pthread_once(&g_soft_bits_once, _soft_bits_select);
+
+	/* Bits of each symbol, first bit as MSB */
+	for (i=0; i<(1<<mod->nbits); i++) {
+		codes[i] = 0;
+		for (j=0; j<mod->nbits; j++)
+			codes[i] = (codes[i] << 1) | mod->syms[i].data[j];
+	}
+
+	g_soft_bits_fn(codes, mod->nbits, syms, n, ebits);
+}
+
+/*! @} */
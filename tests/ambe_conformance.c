@@ -0,0 +1,472 @@
+/* GMR-1 AMBE fixed point decoder conformance test */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Decodes two fixed sets of speech frames and either writes the audio, or
+ * compares it to a previously written reference:
+ *  - "random" : random frames, then slowly mutated, so that pitch, voicing
+ *    and magnitudes both jump and glide anywhere in their range
+ *  - "speech" : frames following the structure of speech. Utterances of
+ *    syllables separated by pauses, each syllable an unvoiced or mixed
+ *    onset and a voiced nucleus, with the pitch of one of a few speakers
+ *    following an intonation contour, gain envelopes, and spectral
+ *    parameters held for each phoneme
+ *
+ * Built against the float and the fixed point codec, as used by
+ * ambe_conformance_test.sh, the fixed point output must meet, against
+ * the float one, a minimum mean segmental SNR and a minimum SNR for each
+ * segment (the floor), set per vector set a little under what is measured
+ * (see sets[]). On the speech set every segment must meet the floor. On
+ * the random set a few may not: at the top gain indices both decoders
+ * saturate the whole frame, and the fixed point magnitude clamp
+ * (AMBE_ML_MAX) decides the shape of what is left.
+ *
+ * Segments are 160 samples (one frame). Segments with almost no energy in
+ * the reference are not counted. Both decoders saturate their output to
+ * int16, so loud segments are compared as they are. Each segment SNR is
+ * clamped to [-10, 60] dB.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <osmocom/gmr1/codec/codec.h>
+
+#include "private.h"	/* Quantizer tables */
+
+
+#define N_RANDOM	9000	/* Frames in the random vector set */
+#define N_SPEECH	6000	/* Frames in the speech vector set */
+#define N_FRAMES	(N_RANDOM + N_SPEECH)
+#define FRAME_LEN	160	/* Samples per frame / segment */
+
+struct set_gate {
+	const char *name;
+	int first;		/* First frame of the set */
+	int n_frames;		/* Frames in the set */
+	double mean;		/* Min mean segmental SNR (dB) */
+	double floor;		/* Min SNR of a segment (dB) */
+	int max_below;		/* Max segments under the floor */
+};
+
+static const struct set_gate sets[] = {
+	/* Measured: 42.1 dB mean, 91 segments under 19 dB */
+	{ "random", 0,        N_RANDOM, 40.0, 19.0, 120 },
+	/* Measured: 31.8 dB mean, 20.5 dB worst */
+	{ "speech", N_RANDOM, N_SPEECH, 30.0, 19.0,   0 },
+};
+
+static unsigned int g_seed = 1;
+
+static int
+urand(int n)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return ((g_seed >> 8) & 0xffff) % n;
+}
+
+static float
+frand(float a, float b)
+{
+	return a + (b - a) * (urand(65536) / 65536.0f);
+}
+
+
+/* Random set ------------------------------------------------------------- */
+
+static void
+gen_random(uint8_t (*frames)[10], int n)
+{
+	uint8_t frame[10];
+	int i, j, k;
+
+	for (i=0; i<n; i++)
+	{
+		if (!(i & 255)) {
+			/* New random frame */
+			for (j=0; j<10; j++)
+				frame[j] = urand(256);
+		} else {
+			/* Flip a few bits of the previous one */
+			k = 1 + urand(4);
+			for (j=0; j<k; j++) {
+				int b = urand(80);
+				frame[b >> 3] ^= 0x80 >> (b & 7);
+			}
+		}
+
+		/* Speech frames only (not silence nor tone) */
+		if ((frame[0] & 0xf8) == 0xf8)
+			frame[0] &= ~0x08;
+
+		memcpy(frames[i], frame, 10);
+	}
+}
+
+
+/* Speech set ------------------------------------------------------------- */
+
+/*! \brief Encoded parameters of a speech frame (see ambe_raw_params) */
+struct speech_params {
+	int pitch;
+	int pitch_interp;
+	int gain;
+	int v_uv;
+	int spec[9];	/* PRBA 12/34/57, HOC 0-3, sf0 perr 14/58 */
+	int mag_interp;
+};
+
+/*! \brief Spectral parameters quantizers, in speech_params.spec order */
+static const struct {
+	const float *tbl;
+	int n;
+	int dim;
+} spec_q[9] = {
+	{ &ambe_prba12_tbl[0][0],      128, 2 },
+	{ &ambe_prba34_tbl[0][0],       64, 2 },
+	{ &ambe_prba57_tbl[0][0],      128, 3 },
+	{ &ambe_hoc0_tbl[0][0],        128, 4 },
+	{ &ambe_hoc1_tbl[0][0],         64, 4 },
+	{ &ambe_hoc2_tbl[0][0],         64, 4 },
+	{ &ambe_hoc3_tbl[0][0],         64, 4 },
+	{ &ambe_sf0_perr14_tbl[0][0],   64, 4 },
+	{ &ambe_sf0_perr58_tbl[0][0],   32, 4 },
+};
+
+#define N_STEADY	8	/* Quantizer entries used for a steady spectrum */
+
+static int spec_steady[9][N_STEADY];
+
+/* The magnitudes are predicted from the previous frame, so a steady
+ * spectrum is coded with the entries closest to zero */
+static void
+spec_init(void)
+{
+	int j, k, l;
+
+	for (j=0; j<9; j++)
+	{
+		float norm[128];
+
+		for (k=0; k<spec_q[j].n; k++) {
+			norm[k] = 0.0f;
+			for (l=0; l<spec_q[j].dim; l++) {
+				float v = spec_q[j].tbl[k * spec_q[j].dim + l];
+				norm[k] += v * v;
+			}
+		}
+
+		for (l=0; l<N_STEADY; l++) {
+			int m = 0;
+			for (k=1; k<spec_q[j].n; k++)
+				if (norm[k] < norm[m])
+					m = k;
+			spec_steady[j][l] = m;
+			norm[m] = 1e9f;
+		}
+	}
+}
+
+/* Spectral change (new phoneme) or steady spectrum */
+static void
+spec_update(struct speech_params *p, int change)
+{
+	int j;
+
+	for (j=0; j<9; j++)
+		p->spec[j] = change ? urand(spec_q[j].n) : spec_steady[j][urand(N_STEADY)];
+
+	if (change)
+		p->mag_interp = urand(4);
+}
+
+static void
+put_bits(uint8_t *frame, int pos, int len, int val)
+{
+	int i;
+
+	for (i=0; i<len; i++) {
+		int b = pos + i;
+		if ((val >> (len - 1 - i)) & 1)
+			frame[b >> 3] |= 0x80 >> (b & 7);
+	}
+}
+
+/* Inverse of ambe_frame_unpack_raw() */
+static void
+pack_frame(uint8_t *frame, const struct speech_params *p)
+{
+	memset(frame, 0x00, 10);
+
+	put_bits(frame,  0, 7, p->pitch);
+	put_bits(frame, 48, 2, p->pitch_interp);
+	put_bits(frame,  7, 6, p->gain >> 2);
+	put_bits(frame, 50, 2, p->gain & 3);
+	put_bits(frame, 13, 6, p->v_uv);
+	put_bits(frame, 19, 6, p->spec[0] >> 1);
+	put_bits(frame, 52, 1, p->spec[0] & 1);
+	put_bits(frame, 25, 3, p->spec[1] >> 3);
+	put_bits(frame, 53, 3, p->spec[1] & 7);
+	put_bits(frame, 28, 3, p->spec[2] >> 4);
+	put_bits(frame, 56, 4, p->spec[2] & 15);
+	put_bits(frame, 31, 3, p->spec[3] >> 4);
+	put_bits(frame, 60, 4, p->spec[3] & 15);
+	put_bits(frame, 34, 3, p->spec[4] >> 3);
+	put_bits(frame, 64, 3, p->spec[4] & 7);
+	put_bits(frame, 37, 2, p->spec[5] >> 4);
+	put_bits(frame, 67, 4, p->spec[5] & 15);
+	put_bits(frame, 39, 2, p->spec[6] >> 3);
+	put_bits(frame, 71, 3, p->spec[6] & 7);
+	put_bits(frame, 46, 2, p->mag_interp);
+	put_bits(frame, 41, 3, p->spec[7] >> 3);
+	put_bits(frame, 74, 3, p->spec[7] & 7);
+	put_bits(frame, 44, 2, p->spec[8] >> 3);
+	put_bits(frame, 77, 3, p->spec[8] & 7);
+}
+
+/* Pitch index of a fundamental in Hz (see ambe_frame_decode_params) */
+static int
+pitch_idx(float f0)
+{
+	int p = (int)roundf((-4.312f - log2f(f0 / 8000.0f)) / 2.1336e-2f);
+	return p < 0 ? 0 : (p > 119 ? 119 : p);
+}
+
+/* Gain index with both subframes closest to a steady state gain */
+static int
+gain_idx(float g)
+{
+	float t = g / 2.0f, best = 1e9f;
+	int i, bi = 0;
+
+	for (i=0; i<256; i++) {
+		float d0 = ambe_gain_tbl[i][0] - t;
+		float d1 = ambe_gain_tbl[i][1] - t;
+		if ((d0 * d0 + d1 * d1) < best) {
+			best = d0 * d0 + d1 * d1;
+			bi = i;
+		}
+	}
+
+	return bi;
+}
+
+/* V/UV index with the given number of voiced bands (low ones first) */
+static int
+v_uv_idx(int nv)
+{
+	static const uint16_t v[9] = {
+		0x0000, 0x8080, 0xc0c0, 0xe0e0, 0xf0f0,
+		0xf8f8, 0xfcfc, 0xfefe, 0xffff,
+	};
+	int i;
+
+	for (i=0; i<64; i++)
+		if (ambe_v_uv_tbl[i] == v[nv])
+			return i;
+
+	return 0;
+}
+
+static void
+gen_speech(uint8_t (*frames)[10], int n)
+{
+	static const float speakers[] = { 105.0f, 130.0f, 195.0f, 230.0f };
+	struct speech_params p;
+	int i = 0, k;
+
+	memset(&p, 0x00, sizeof(p));
+
+	spec_init();
+
+	while (i < n)
+	{
+		float f0 = speakers[urand(4)];
+		int n_syl = 3 + urand(12);
+		int s;
+
+		/* Pause, background noise or silence frames */
+		p.v_uv = v_uv_idx(0);
+		p.pitch = pitch_idx(f0);
+		p.pitch_interp = 0;
+
+		for (k=10+urand(40); k-- && i<n; i++) {
+			spec_update(&p, 0);
+			p.gain = gain_idx(frand(0.0f, 2.0f));
+			pack_frame(frames[i], &p);
+			if (urand(4) == 0)
+				frames[i][0] = 0xf8;	/* Silence */
+		}
+
+		/* Utterance, intonation declines along it */
+		for (s=0; s<n_syl && i<n; s++)
+		{
+			float decl = 1.0f - 0.15f * s / n_syl;
+			float accent = frand(0.95f, 1.20f);
+			float peak = frand(10.0f, 12.0f);
+			int n_on = 1 + urand(4), n_nuc = 4 + urand(14);
+
+			/* Onset : fricative, plosive or nothing */
+			p.pitch_interp = 2;
+
+			for (k=0; k<n_on && i<n; k++, i++) {
+				spec_update(&p, !k);
+				p.pitch = pitch_idx(f0 * decl);
+				p.v_uv  = v_uv_idx(k ? urand(3) : 0);
+				p.gain  = gain_idx(frand(7.0f, 10.0f));
+				pack_frame(frames[i], &p);
+			}
+
+			/* Nucleus : vowel, pitch rises to the accent and falls,
+			 * gain rises and decays, voicing drops at the end */
+			for (k=0; k<n_nuc && i<n; k++, i++) {
+				float x = (float)k / n_nuc;
+				float c = 1.0f + (accent - 1.0f) * sinf(M_PI * x);
+				float env = x < 0.2f ? (3.0f * (x / 0.2f - 1.0f)) : (-3.0f * (x - 0.2f));
+
+				p.pitch = pitch_idx(f0 * decl * c * frand(0.99f, 1.01f));
+				p.v_uv  = v_uv_idx(k >= n_nuc - 2 ? 4 + urand(4) : 7 + urand(2));
+				p.gain  = gain_idx(peak + env + frand(-0.2f, 0.2f));
+
+				spec_update(&p, !k);
+
+				pack_frame(frames[i], &p);
+			}
+		}
+	}
+}
+
+
+/* Decoding / comparison -------------------------------------------------- */
+
+static int
+decode(const uint8_t (*frames)[10], int16_t *audio)
+{
+	struct gmr1_codec *codec;
+	int i, rv = 0;
+
+	codec = gmr1_codec_alloc();
+	if (!codec)
+		return -ENOMEM;
+
+	for (i=0; i<N_FRAMES; i++) {
+		rv = gmr1_codec_decode_frame(codec, &audio[i * FRAME_LEN], FRAME_LEN, frames[i], 0);
+		if (rv)
+			break;
+	}
+
+	gmr1_codec_release(codec);
+
+	return rv;
+}
+
+static int
+compare(const struct set_gate *gate, const int16_t *ref, const int16_t *test)
+{
+	double sum = 0.0, min = 60.0;
+	int i, j, n = 0, n_below = 0;
+
+	for (i=gate->first; i<gate->first+gate->n_frames; i++)
+	{
+		const int16_t *r = &ref[i * FRAME_LEN];
+		const int16_t *t = &test[i * FRAME_LEN];
+		double e = 0.0, d = 0.0, snr;
+
+		for (j=0; j<FRAME_LEN; j++) {
+			e += (double)r[j] * r[j];
+			d += (double)(r[j] - t[j]) * (r[j] - t[j]);
+		}
+
+		if (e < 100.0 * FRAME_LEN)
+			continue;
+
+		snr = (d > 0.0) ? 10.0 * log10(e / d) : 60.0;
+		snr = snr < -10.0 ? -10.0 : (snr > 60.0 ? 60.0 : snr);
+
+		sum += snr;
+		if (snr < min)
+			min = snr;
+		if (snr < gate->floor)
+			n_below++;
+		n++;
+	}
+
+	if (!n) {
+		printf("FAIL: %s: no segment to compare\n", gate->name);
+		return -1;
+	}
+
+	printf("%-6s %5d segments: segSNR %.2f dB (>= %.1f), min %.2f dB, "
+	       "%d under %.1f dB (<= %d)\n",
+		gate->name, n, sum / n, gate->mean, min,
+		n_below, gate->floor, gate->max_below);
+
+	return ((sum / n) >= gate->mean) && (n_below <= gate->max_below) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	static uint8_t frames[N_FRAMES][10];
+	static int16_t audio[N_FRAMES * FRAME_LEN], ref[N_FRAMES * FRAME_LEN];
+	const size_t len = N_FRAMES * FRAME_LEN;
+	FILE *fh;
+	int i, rv;
+
+	if ((argc != 3) || (strcmp(argv[1], "write") && strcmp(argv[1], "check"))) {
+		fprintf(stderr, "Usage: %s write|check ref.raw\n", argv[0]);
+		return 2;
+	}
+
+	gen_random(frames, N_RANDOM);
+	gen_speech(&frames[N_RANDOM], N_SPEECH);
+
+	rv = decode((const uint8_t (*)[10])frames, audio);
+	if (rv) {
+		fprintf(stderr, "[!] Decoding failed: %d\n", rv);
+		return 1;
+	}
+
+	if (!strcmp(argv[1], "write")) {
+		fh = fopen(argv[2], "wb");
+		if (!fh || (fwrite(audio, sizeof(int16_t), len, fh) != len)) {
+			fprintf(stderr, "[!] Can't write %s\n", argv[2]);
+			rv = -1;
+		}
+	} else {
+		fh = fopen(argv[2], "rb");
+		if (!fh || (fread(ref, sizeof(int16_t), len, fh) != len)) {
+			fprintf(stderr, "[!] Can't read %s\n", argv[2]);
+			rv = -1;
+		} else {
+			for (i=0; i<(int)(sizeof(sets)/sizeof(sets[0])); i++)
+				rv |= compare(&sets[i], ref, audio);
+		}
+	}
+
+	if (fh)
+		fclose(fh);
+
+	printf("%s\n", rv ? "FAILED" : "OK");
+
+	return rv ? 1 : 0;
+}
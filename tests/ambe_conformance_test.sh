@@ -0,0 +1,11 @@
+#!/bin/sh
+# Fixed point AMBE decoder against the float one, see ambe_conformance.c
+
+ref=ambe_conformance_ref.raw
+
+./ambe_conformance_float write $ref || exit 1
+./ambe_conformance_fixed check $ref
+rv=$?
+
+rm -f $ref
+exit $rv
@@ -0,0 +1,210 @@
+/* GMR-1 batched Viterbi decoder test */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Encodes random frames with every GMR-1 code, adds noise at several
+ * levels and checks, for each frame, that :
+ *  - gmr1_conv_decode() gives exactly the bits and metric of
+ *    osmo_conv_decode()
+ *  - gmr1_conv_decode() gives exactly the bits and metric of libosmocore's
+ *    generic decoder, for the codes it doesn't pass through to
+ *    osmo_conv_decode() (K=9 and N=5 ones)
+ *  - gmr1_conv_decode_batch() gives exactly the bits and metric of
+ *    libosmocore's generic decoder, for all codes
+ * Also checks the decoding is error free when there is no noise, and that
+ * the puncturing masks generated with the channel codes match the ones
+ * computed for a copy of the code.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <osmocom/core/bits.h>
+#include <osmocom/core/conv.h>
+
+#include <osmocom/gmr1/l1/conv.h>
+
+#include "private.h"	/* Channel codes */
+
+
+#define N_FRAMES	37	/* Not a multiple of any batch width */
+#define MAX_BITS	2048
+
+static const struct {
+	const char *name;
+	const struct osmo_conv_code *code;
+} codes[] = {
+	{ "bcch",        &gmr1_conv_bcch },
+	{ "ccch",        &gmr1_conv_ccch },
+	{ "facch3",      &gmr1_conv_facch3 },
+	{ "facch9",      &gmr1_conv_facch9 },
+	{ "rach",        &gmr1_conv_rach },
+	{ "tch3_speech", &gmr1_conv_tch3_speech },
+	{ "tch9_24",     &gmr1_conv_tch9_24 },
+	{ "tch9_48",     &gmr1_conv_tch9_48 },
+	{ "tch9_96",     &gmr1_conv_tch9_96 },
+	{ "xch_dc12",    &gmr1_conv_xch_dc12 },
+};
+
+static unsigned int g_seed = 1;
+
+static int
+urand(int n)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return ((g_seed >> 8) & 0xffff) % n;
+}
+
+/* Codes osmo_conv_decode() decodes with its accelerated implementation */
+static int
+lib_acc(const struct osmo_conv_code *code)
+{
+	return (code->N <= 4) && ((code->K == 5) || (code->K == 7));
+}
+
+/* Same as osmo_conv_decode() does for the codes it doesn't accelerate */
+static int
+generic_decode(const struct osmo_conv_code *code,
+               const sbit_t *input, ubit_t *output)
+{
+	struct osmo_conv_decoder decoder;
+	int rv, l;
+
+	osmo_conv_decode_init(&decoder, code, 0, 0);
+
+	if (code->term == CONV_TERM_TAIL_BITING) {
+		osmo_conv_decode_scan(&decoder, input, code->len);
+		osmo_conv_decode_rewind(&decoder);
+	}
+
+	l = osmo_conv_decode_scan(&decoder, input, code->len);
+
+	if (code->term == CONV_TERM_FLUSH)
+		osmo_conv_decode_flush(&decoder, &input[l]);
+
+	rv = osmo_conv_decode_get_output(&decoder, output,
+		code->term == CONV_TERM_FLUSH, -1);
+
+	osmo_conv_decode_deinit(&decoder);
+
+	return rv;
+}
+
+static int
+test_code(const char *name, const struct osmo_conv_code *code)
+{
+	static const int noise[] = { 0, 64, 128, 192 };
+	static ubit_t msg[N_FRAMES][MAX_BITS];
+	static ubit_t enc[MAX_BITS];
+	static sbit_t soft[N_FRAMES][MAX_BITS];
+	static ubit_t out_s[MAX_BITS], out_c[MAX_BITS], out_b[N_FRAMES][MAX_BITS];
+	static ubit_t out_l[MAX_BITS], out_g[MAX_BITS];
+	struct osmo_conv_code copy = *code;
+	const sbit_t *in[N_FRAMES];
+	ubit_t *out[N_FRAMES];
+	int rv_b[N_FRAMES];
+	int len = code->len;
+	int olen = osmo_conv_get_output_length(code, 0);
+	int i, j, k, rv, rv_c, rv_l, rv_g, err = 0;
+
+	for (i=0; i<N_FRAMES; i++) {
+		in[i] = soft[i];
+		out[i] = out_b[i];
+	}
+
+	for (k=0; k<(int)(sizeof(noise)/sizeof(noise[0])); k++)
+	{
+		/* Random frames, soft bits with uniform noise */
+		for (i=0; i<N_FRAMES; i++) {
+			for (j=0; j<len; j++)
+				msg[i][j] = urand(2);
+
+			osmo_conv_encode(code, msg[i], enc);
+
+			for (j=0; j<olen; j++) {
+				int v = (enc[j] ? -127 : 127);
+				if (noise[k])
+					v += urand(2 * noise[k] + 1) - noise[k];
+				soft[i][j] = v < -127 ? -127 : (v > 127 ? 127 : v);
+			}
+		}
+
+		rv = gmr1_conv_decode_batch(code, N_FRAMES, in, out, rv_b);
+		if (rv) {
+			printf("  FAIL: %s batch decode error %d\n", name, rv);
+			return -1;
+		}
+
+		for (i=0; i<N_FRAMES; i++) {
+			rv = gmr1_conv_decode(code, soft[i], out_s);
+			rv_l = osmo_conv_decode(code, soft[i], out_l);
+			rv_g = generic_decode(code, soft[i], out_g);
+
+			if ((rv != rv_l) || memcmp(out_s, out_l, len)) {
+				printf("  FAIL: %s noise %d frame %d, single != osmo_conv_decode (%d / %d)\n",
+					name, noise[k], i, rv, rv_l);
+				err = -1;
+			}
+
+			if (!lib_acc(code) && ((rv != rv_g) || memcmp(out_s, out_g, len))) {
+				printf("  FAIL: %s noise %d frame %d, single != generic (%d / %d)\n",
+					name, noise[k], i, rv, rv_g);
+				err = -1;
+			}
+
+			if ((rv_b[i] != rv_g) || memcmp(out_b[i], out_g, len)) {
+				printf("  FAIL: %s noise %d frame %d, batch != generic (%d / %d)\n",
+					name, noise[k], i, rv_b[i], rv_g);
+				err = -1;
+			}
+
+			rv_c = gmr1_conv_decode(&copy, soft[i], out_c);
+
+			if ((rv != rv_c) || memcmp(out_s, out_c, len)) {
+				printf("  FAIL: %s noise %d frame %d, copy != code (%d / %d)\n",
+					name, noise[k], i, rv_c, rv);
+				err = -1;
+			}
+
+			if (!noise[k] && memcmp(out_s, msg[i], len)) {
+				printf("  FAIL: %s frame %d not decoded without noise\n", name, i);
+				err = -1;
+			}
+		}
+	}
+
+	printf("%-12s K=%d N=%d len=%4d %s\n", name, code->K, code->N, len,
+		err ? "FAILED" : "ok");
+
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	int i, rv = 0;
+
+	for (i=0; i<(int)(sizeof(codes)/sizeof(codes[0])); i++)
+		rv |= test_code(codes[i].name, codes[i].code);
+
+	printf("%s\n", rv ? "FAILED" : "OK");
+
+	return rv ? 1 : 0;
+}
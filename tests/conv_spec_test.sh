@@ -0,0 +1,15 @@
+#!/bin/sh
+# Checked-in src/l1/conv_spec.c against a fresh gen_conv_spec output
+
+out=conv_spec_check.c
+
+../src/l1/gen_conv_spec > $out || exit 1
+diff -u "${srcdir:-.}/../src/l1/conv_spec.c" $out
+rv=$?
+
+if [ $rv -ne 0 ]; then
+	echo "src/l1/conv_spec.c is out of date, run 'make -C src/l1 regen-conv-spec'"
+fi
+
+rm -f $out
+exit $rv
@@ -0,0 +1,225 @@
+/* GMR-1 pi4-CxPSK demodulator allocation test */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks that gmr1_pi4cxpsk_demod_ex() doesn't allocate any memory once
+ * its context is allocated, for BCCH and TCH3 (FACCH3 and speech) bursts
+ * at 2 and 4 sps, with the search windows used by the receiver.
+ *
+ * The test is linked with --wrap for every allocator the SDR library
+ * calls (libc, libosmodsp and FFTW ones, see Makefile.am), and counts the
+ * calls made during each demodulation, starting with the very first one
+ * of each context. Bursts are modulated from random bits, interpolated to
+ * the sps and placed at random offsets in the window, over noise.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fftw3.h>
+
+#include <osmocom/core/bits.h>
+#include <osmocom/dsp/cxvec.h>
+#include <osmocom/dsp/cxvec_math.h>
+
+#include <osmocom/gmr1/sdr/defs.h>
+#include <osmocom/gmr1/sdr/nb.h>
+#include <osmocom/gmr1/sdr/pi4cxpsk.h>
+
+
+#define N_BURSTS	16	/* Demodulated bursts per case */
+#define MAX_EBITS	1024	/* Encoded bits per burst, at most */
+
+/* Allocation counting */
+static int g_counting;
+static int g_allocs;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+struct osmo_cxvec *__real_osmo_cxvec_alloc(int max_len);
+void *__real_fftwf_malloc(size_t n);
+fftwf_plan __real_fftwf_plan_dft_1d(int n, fftwf_complex *in, fftwf_complex *out,
+                                    int sign, unsigned flags);
+
+void *
+__wrap_malloc(size_t size)
+{
+	g_allocs += g_counting;
+	return __real_malloc(size);
+}
+
+void *
+__wrap_calloc(size_t nmemb, size_t size)
+{
+	g_allocs += g_counting;
+	return __real_calloc(nmemb, size);
+}
+
+void *
+__wrap_realloc(void *ptr, size_t size)
+{
+	g_allocs += g_counting;
+	return __real_realloc(ptr, size);
+}
+
+struct osmo_cxvec *
+__wrap_osmo_cxvec_alloc(int max_len)
+{
+	g_allocs += g_counting;
+	return __real_osmo_cxvec_alloc(max_len);
+}
+
+void *
+__wrap_fftwf_malloc(size_t n)
+{
+	g_allocs += g_counting;
+	return __real_fftwf_malloc(n);
+}
+
+fftwf_plan
+__wrap_fftwf_plan_dft_1d(int n, fftwf_complex *in, fftwf_complex *out,
+                         int sign, unsigned flags)
+{
+	g_allocs += g_counting;
+	return __real_fftwf_plan_dft_1d(n, in, out, sign, flags);
+}
+
+
+static unsigned int g_seed = 1;
+
+static float
+urand(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return ((g_seed >> 8) & 0xffff) / 65536.0f;
+}
+
+static float
+nrand(void)
+{
+	float u = urand() + 1e-6f, v = urand();
+	return sqrtf(-2.0f * logf(u)) * cosf(2.0f * M_PIf * v);
+}
+
+/* Random burst at sps, somewhere in a window of win samples */
+static void
+gen_burst(const struct gmr1_pi4cxpsk_burst *bt, int sps, int win,
+          struct osmo_cxvec *sym, struct osmo_cxvec *out)
+{
+	ubit_t ebits[MAX_EBITS];
+	int i, j, p0;
+
+	for (i=0; i<bt->ebits; i++)
+		ebits[i] = urand() < 0.5f;
+
+	gmr1_pi4cxpsk_mod(bt, ebits, 0, sym);
+
+	out->len = bt->len * sps + win;
+	p0 = (int)(urand() * win);
+
+	for (i=0; i<out->len; i++)
+		out->data[i] = 0.05f * (nrand() + I * nrand());
+
+	for (i=0; i<sym->len; i++)
+		for (j=0; j<sps; j++) {
+			float complex a = sym->data[i];
+			float complex b = i+1 < sym->len ? sym->data[i+1] : 0.0f;
+			float x = (float)j / sps;
+
+			if (p0 + i*sps + j < out->len)
+				out->data[p0 + i*sps + j] += (1.0f - x) * a + x * b;
+		}
+}
+
+static int
+test_one(const char *name, const struct gmr1_pi4cxpsk_burst *bt,
+         int sps, int win)
+{
+	struct gmr1_pi4cxpsk_demod_ctx *ctx;
+	struct osmo_cxvec *sym, *in;
+	sbit_t ebits[MAX_EBITS];
+	int sync_id, max = 0, i, rv;
+	float toa, freq_err;
+
+	ctx = gmr1_pi4cxpsk_demod_alloc(bt, sps, win);
+	sym = osmo_cxvec_alloc(bt->len);
+	in  = osmo_cxvec_alloc(bt->len * sps + win);
+	if (!ctx || !sym || !in) {
+		printf("  FAIL: %s sps=%d: allocation failed\n", name, sps);
+		rv = -1;
+		goto out;
+	}
+
+	for (i=0; i<N_BURSTS; i++)
+	{
+		gen_burst(bt, sps, win, sym, in);
+
+		g_allocs = 0;
+		g_counting = 1;
+
+		rv = gmr1_pi4cxpsk_demod_ex(ctx, in, 0.0f, ebits,
+		                            &sync_id, &toa, &freq_err);
+
+		g_counting = 0;
+
+		if (rv < 0) {
+			printf("  FAIL: %s sps=%d burst %d: demod error %d\n",
+				name, sps, i, rv);
+			goto out;
+		}
+
+		if (g_allocs > max)
+			max = g_allocs;
+	}
+
+	rv = max ? -1 : 0;
+
+	printf("%-8s sps=%d: %d allocation(s) per burst max, %s\n",
+		name, sps, max, rv ? "FAILED" : "ok");
+
+out:
+	osmo_cxvec_free(in);
+	osmo_cxvec_free(sym);
+	gmr1_pi4cxpsk_demod_release(ctx);
+
+	return rv;
+}
+
+int main(int argc, char *argv[])
+{
+	static const int sps_list[] = { 2, 4 };
+	int i, sps, rv = 0;
+
+	for (i=0; i<2; i++) {
+		sps = sps_list[i];
+
+		/* Same search windows as the receiver, see demod_init() */
+		rv |= test_one("bcch",   &gmr1_bcch_burst,       sps, 20 * sps);
+		rv |= test_one("facch3", &gmr1_nt3_facch_burst,  sps, sps + (sps/2));
+		rv |= test_one("tch3",   &gmr1_nt3_speech_burst, sps, sps + (sps/2));
+	}
+
+	printf("%s\n", rv ? "FAILED" : "OK");
+
+	return rv ? 1 : 0;
+}
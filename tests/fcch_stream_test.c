@@ -0,0 +1,237 @@
+/* GMR-1 streaming FCCH detector test */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Builds a synthetic capture with several overlapping FCCH (different
+ * timing, power and frequency offsets, over noise and DC) and checks that
+ * the streaming detector, fed in blocks of random sizes:
+ *  - reports the same FCCH as gmr1_fcch_rough_multi() on its first window
+ *  - reports them again every BCCH period after that
+ *  - gives exactly the same results whatever the block sizes
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <osmocom/dsp/cxvec.h>
+#include <osmocom/dsp/cxvec_math.h>
+
+#include <osmocom/gmr1/sdr/defs.h>
+#include <osmocom/gmr1/sdr/fcch.h>
+
+
+#define N_SRC		3	/* FCCH sources in the capture   */
+#define MAX_EV		256	/* Max reported detections       */
+#define TOA_TOL		2	/* TOA tolerance vs batch (samples) */
+
+struct events {
+	int n;
+	int64_t toa[MAX_EV];
+	float pwr[MAX_EV];
+};
+
+static unsigned int g_seed = 1;
+
+static float
+urand(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return ((g_seed >> 8) & 0xffff) / 65536.0f;
+}
+
+static float
+nrand(void)
+{
+	float u = urand() + 1e-6f, v = urand();
+	return sqrtf(-2.0f * logf(u)) * cosf(2.0f * M_PIf * v);
+}
+
+static void
+ev_cb(void *data, int64_t toa, float pwr)
+{
+	struct events *ev = data;
+
+	if (ev->n < MAX_EV) {
+		ev->toa[ev->n] = toa;
+		ev->pwr[ev->n] = pwr;
+		ev->n++;
+	}
+}
+
+static struct osmo_cxvec *
+gen_capture(const struct gmr1_fcch_burst *bt, int sps, int len, const int *offs)
+{
+	static const float amp[N_SRC] = { 1.0f, 0.5f, 0.3f };
+	struct osmo_cxvec *v;
+	int Lp = ((320 * GMR1_SYM_RATE) / 1000) * sps;
+	int c, k, i;
+
+	v = osmo_cxvec_alloc(len);
+	v->len = len;
+
+	for (i=0; i<len; i++)
+		v->data[i] = 0.5f * (nrand() + I * nrand()) + 0.2f;
+
+	for (c=0; c<N_SRC; c++)
+		for (k=0; offs[c] + k*Lp + bt->len*sps < len; k++) {
+			float ph = bt->freq * 2.0f * M_PIf / bt->len;
+			float h = bt->len / 2.0f;
+			int p0 = offs[c] + k * Lp;
+
+			for (i=0; i<bt->len*sps; i++) {
+				float pos = (float)i / sps - h;
+				v->data[p0+i] += amp[c] * sqrtf(2.0f) * cosf(ph * pos * pos) *
+				                 cexpf(I * (0.01f * c) * i / sps);
+			}
+		}
+
+	return v;
+}
+
+static int
+run_stream(const struct gmr1_fcch_burst *bt, int sps, struct osmo_cxvec *v,
+           int max_blk, struct events *ev)
+{
+	struct gmr1_fcch_stream *fs;
+	struct osmo_cxvec blk;
+	int i, l;
+
+	memset(ev, 0x00, sizeof(struct events));
+
+	fs = gmr1_fcch_stream_alloc(bt, sps, 0.0f, ev_cb, ev);
+	if (!fs)
+		return -1;
+
+	for (i=0; i<v->len; i+=l) {
+		l = max_blk ? 1 + (int)(urand() * max_blk) : v->len;
+		if (i + l > v->len)
+			l = v->len - i;
+
+		osmo_cxvec_init_from_data(&blk, &v->data[i], l);
+		gmr1_fcch_stream_process(fs, &blk);
+	}
+
+	gmr1_fcch_stream_release(fs);
+
+	return 0;
+}
+
+static int
+test_one(int sps)
+{
+	const struct gmr1_fcch_burst *bt = &gmr1_fcch_burst;
+	const int offs[N_SRC] = { 750 * sps, 3086 * sps, 5250 * sps };
+	const int max_blks[] = { 0, 1, 97, 5000, 65536 };
+	struct osmo_cxvec *v;
+	struct events ev_ref, ev;
+	int Lp = ((320 * GMR1_SYM_RATE) / 1000) * sps;
+	int len = 3 * GMR1_SYM_RATE * sps;
+	int btoa[16], n_batch, n_first;
+	int i, j, b, rv = 0;
+
+	v = gen_capture(bt, sps, len, offs);
+
+	/* One-shot detection */
+	n_batch = gmr1_fcch_rough_multi(bt, v, sps, 0.0f, btoa, 16);
+
+	printf("sps=%d batch:", sps);
+	for (i=0; i<n_batch; i++)
+		printf(" %d", btoa[i]);
+	printf("\n");
+
+	if (n_batch != N_SRC) {
+		printf("  FAIL: batch found %d FCCH, expected %d\n", n_batch, N_SRC);
+		rv = -1;
+		goto out;
+	}
+
+	/* Streaming, whole capture in one block as reference */
+	run_stream(bt, sps, v, 0, &ev_ref);
+
+	/* First window: same FCCH as the one-shot detection, same order */
+	for (n_first=0; n_first<ev_ref.n && ev_ref.toa[n_first]<Lp; n_first++);
+
+	printf("sps=%d stream: %d events, first window:", sps, ev_ref.n);
+	for (i=0; i<n_first; i++)
+		printf(" %lld", (long long)ev_ref.toa[i]);
+	printf("\n");
+
+	if (n_first != n_batch) {
+		printf("  FAIL: first window has %d FCCH, expected %d\n", n_first, n_batch);
+		rv = -1;
+	}
+
+	for (i=0; i<n_first && i<n_batch; i++)
+		if (llabs(ev_ref.toa[i] - btoa[i]) > TOA_TOL) {
+			printf("  FAIL: TOA %lld != %d\n", (long long)ev_ref.toa[i], btoa[i]);
+			rv = -1;
+		}
+
+	/* Following windows: every FCCH again, one period later each time */
+	if (ev_ref.n < 2 * N_SRC) {
+		printf("  FAIL: only %d events\n", ev_ref.n);
+		rv = -1;
+	}
+
+	for (i=0; i<ev_ref.n; i++) {
+		int64_t d = ev_ref.toa[i] % Lp;
+
+		for (j=0; j<N_SRC; j++)
+			if (llabs(d - offs[j]) <= TOA_TOL + sps)
+				break;
+
+		if (j == N_SRC) {
+			printf("  FAIL: event @%lld isn't one of the FCCH\n", (long long)ev_ref.toa[i]);
+			rv = -1;
+		}
+	}
+
+	/* Any block size must give the same results */
+	for (b=1; b<(int)(sizeof(max_blks)/sizeof(max_blks[0])); b++) {
+		run_stream(bt, sps, v, max_blks[b], &ev);
+
+		if ((ev.n != ev_ref.n) ||
+		    memcmp(ev.toa, ev_ref.toa, sizeof(int64_t) * ev.n) ||
+		    memcmp(ev.pwr, ev_ref.pwr, sizeof(float) * ev.n)) {
+			printf("  FAIL: results differ with blocks up to %d samples\n", max_blks[b]);
+			rv = -1;
+		}
+	}
+
+out:
+	osmo_cxvec_free(v);
+
+	return rv;
+}
+
+int main(int argc, char *argv[])
+{
+	int rv = 0;
+
+	rv |= test_one(2);
+	rv |= test_one(4);
+
+	printf("%s\n", rv ? "FAILED" : "OK");
+
+	return rv ? 1 : 0;
+}
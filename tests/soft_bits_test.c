@@ -0,0 +1,139 @@
+/* GMR-1 pi4-CxPSK soft bits vector kernels test */
+
+/* (C) 2011-2019 by Sylvain Munaut <tnt@246tNt.com>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Runs every vector soft bits kernel built for this CPU (SSE2 and AVX2 on
+ * x86, NEON on aarch64 with --enable-neon) against the scalar reference, for all the
+ * modulations, on random symbols of any phase and amplitude plus the axes
+ * and zero, with lengths covering all the partial last groups. Every soft
+ * bit must have the sign of the reference and be within +-1 of it.
+ */
+
+#include "pi4cxpsk_soft.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#define MAX_SYMS	20000
+
+static unsigned int g_seed = 1;
+
+static float
+urand(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return ((g_seed >> 8) & 0xffff) / 65536.0f;
+}
+
+static int
+test_kernel(const char *name, soft_bits_fn_t fn,
+            const struct gmr1_pi4cxpsk_modulation *mod)
+{
+	static const int lens[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, MAX_SYMS };
+	static float complex in[MAX_SYMS];
+	static sbit_t ref[MAX_SYMS * GMR1_MAX_SYM_EBITS];
+	static sbit_t out[MAX_SYMS * GMR1_MAX_SYM_EBITS + 1];
+	uint8_t codes[1 << GMR1_MAX_SYM_EBITS];
+	int i, j, k, n, err = 0;
+
+	for (i=0; i<(1<<mod->nbits); i++) {
+		codes[i] = 0;
+		for (j=0; j<mod->nbits; j++)
+			codes[i] = (codes[i] << 1) | mod->syms[i].data[j];
+	}
+
+	for (k=0; k<(int)(sizeof(lens)/sizeof(lens[0])); k++)
+	{
+		n = lens[k];
+
+		for (i=0; i<n; i++)
+			in[i] = (0.01f + 2.0f * urand()) *
+			        cexpf(I * (2.0f * M_PIf * urand() - M_PIf));
+
+		if (n == MAX_SYMS) {
+			in[0] =  1.0f;
+			in[1] =  I;
+			in[2] = -1.0f;
+			in[3] = -I;
+			in[4] =  0.0f;
+		}
+
+		/* Canary, kernels must not write past n * nbits */
+		out[n * mod->nbits] = 0x5a;
+
+		_soft_bits_scalar(codes, mod->nbits, in, n, ref);
+		fn(codes, mod->nbits, in, n, out);
+
+		if (out[n * mod->nbits] != 0x5a) {
+			printf("  FAIL: %s nbits=%d n=%d wrote past the end\n",
+				name, mod->nbits, n);
+			err = -1;
+		}
+
+		for (i=0; i<n*mod->nbits; i++) {
+			if ((abs(ref[i] - out[i]) > 1) || ((ref[i] < 0) != (out[i] < 0))) {
+				printf("  FAIL: %s nbits=%d n=%d bit %d: %d != %d (%g%+gi)\n",
+					name, mod->nbits, n, i, out[i], ref[i],
+					crealf(in[i / mod->nbits]), cimagf(in[i / mod->nbits]));
+				err = -1;
+				break;
+			}
+		}
+	}
+
+	printf("%-5s nbits=%d %s\n", name, mod->nbits, err ? "FAILED" : "ok");
+
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	const struct gmr1_pi4cxpsk_modulation *mods[] = {
+		&gmr1_pi4cbpsk, &gmr1_pi2cbpsk, &gmr1_pi4cqpsk,
+	};
+	int i, n = 0, rv = 0;
+
+	for (i=0; i<(int)(sizeof(mods)/sizeof(mods[0])); i++) {
+#if defined(__SSE2__)
+		rv |= test_kernel("sse2", _soft_bits_sse2, mods[i]);
+		n++;
+#endif
+#if defined(HAVE_AVX2_KERNEL)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			rv |= test_kernel("avx2", _soft_bits_avx2, mods[i]);
+			n++;
+		}
+#endif
+#if defined(HAVE_NEON_KERNEL)
+		rv |= test_kernel("neon", _soft_bits_neon, mods[i]);
+		n++;
+#endif
+	}
+
+	if (!n) {
+		printf("No vector kernel for this CPU\n");
+		return 77;	/* Skipped */
+	}
+
+	printf("%s\n", rv ? "FAILED" : "OK");
+
+	return rv ? 1 : 0;
+}